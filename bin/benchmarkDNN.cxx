@@ -0,0 +1,155 @@
+/*
+Created:        19 October 2026
+Last Updated:   19 October 2026
+
+agent
+agent@local
+-----
+
+Throughput of the DNN inference backends
+ - lwtnn (double precision reference, if the JSON file is given)
+ - compiled network (python/lwtnn2header.py): double, float32, int8
+Inputs are read from the 'features' tree (output of training) and
+the maximum deviation of each backend from the double precision network is reported.
+
+To run:
+   benchmarkDNN <features.root> [nEvents] [lwtnn.json]
+*/
+#include "TROOT.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TTreeReader.h"
+#include "TTreeReaderValue.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <array>
+#include <fstream>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <chrono>
+#include <cmath>
+#include <functional>
+
+#include "lwtnn/lwtnn/interface/LightweightNeuralNetwork.hh"
+#include "lwtnn/lwtnn/interface/parse_json.hh"
+
+#include "Analysis/cheetah/interface/tools.h"
+#include "Analysis/cheetah/interface/compiledDNN.h"
+
+
+int main(int argc, char** argv) {
+    /* Benchmark the DNN backends */
+#ifndef CHEETAH_COMPILED_DNN
+    std::cout << "\n   The compiled network has not been generated:" << std::endl;
+    std::cout << "      python python/lwtnn2header.py <lwtnn.json> [--calibration calibration.json]\n" << std::endl;
+    return -1;
+#else
+    if (argc < 2) {
+        std::cout << "\n   To run:" << std::endl;
+        std::cout << "      benchmarkDNN <features.root> [nEvents] [lwtnn.json]\n" << std::endl;
+        return -1;
+    }
+
+    std::string filename(argv[1]);
+    long long nEvents = (argc>2) ? std::stoll(argv[2]) : -1;
+    std::string lwtnnFile = (argc>3) ? argv[3] : "";
+
+    struct inputArray { double values[compiledDNN::nInputs]; };
+    typedef double outputArray[compiledDNN::nOutputs];
+
+    // Load the inputs
+    TFile* file = TFile::Open(filename.c_str());
+    if (!file || file->IsZombie()){
+        cma::ERROR("BENCHMARK : Cannot open "+filename);
+        return -1;
+    }
+    TTreeReader reader("features",file);
+
+    std::vector<std::unique_ptr<TTreeReaderValue<float>>> values;
+    for (unsigned int i=0; i<compiledDNN::nInputs; i++)
+        values.push_back( std::unique_ptr<TTreeReaderValue<float>>(new TTreeReaderValue<float>(reader,compiledDNN::inputNames[i])) );
+
+    std::vector<inputArray> inputs;
+    while (reader.Next() && (nEvents<0 || (long long)inputs.size()<nEvents)){
+        inputArray in;
+        for (unsigned int i=0; i<compiledDNN::nInputs; i++)
+            in.values[i] = **values[i];
+        inputs.push_back(in);
+    }
+    values.clear();
+    file->Close();
+
+    if (inputs.size()<1){
+        cma::ERROR("BENCHMARK : No events in the features tree of "+filename);
+        return -1;
+    }
+    std::cout << " BENCHMARK : " << inputs.size() << " jets from " << filename << std::endl;
+
+    // Backends
+    std::map<std::string,std::function<void(const inputArray&,outputArray&)>> backends;
+    backends["compiled"] = [](const inputArray& in,outputArray& out){
+        compiledDNN::compute(in.values,out);
+    };
+    backends["float"] = [](const inputArray& in,outputArray& out){
+        compiledDNN::computeFloat(in.values,out);
+    };
+#ifdef CHEETAH_COMPILED_DNN_INT8
+    backends["int8"] = [](const inputArray& in,outputArray& out){
+        compiledDNN::computeInt8(in.values,out);
+    };
+#endif
+
+    std::unique_ptr<lwt::LightweightNeuralNetwork> lwnn;
+    std::map<std::string,double> lwnnInputs;
+    if (lwtnnFile.size()>0){
+        std::ifstream input_cfg = cma::open_file( lwtnnFile );
+        lwt::JSONConfig cfg     = lwt::parse_json( input_cfg );
+        lwnn.reset( new lwt::LightweightNeuralNetwork(cfg.inputs, cfg.layers, cfg.outputs) );
+
+        backends["lwtnn"] = [&lwnn,&lwnnInputs](const inputArray& in,outputArray& out){
+            for (unsigned int i=0; i<compiledDNN::nInputs; i++)
+                lwnnInputs[compiledDNN::inputNames[i]] = in.values[i];
+            std::map<std::string,double> predictions = lwnn->compute(lwnnInputs);
+            for (unsigned int i=0; i<compiledDNN::nOutputs; i++)
+                out[i] = predictions.at(compiledDNN::outputNames[i]);
+        };
+    }
+
+    // Reference (double precision)
+    std::vector<std::array<double,compiledDNN::nOutputs>> reference(inputs.size());
+    for (unsigned int e=0; e<inputs.size(); e++){
+        outputArray out;
+        backends.at("compiled")(inputs[e],out);
+        for (unsigned int i=0; i<compiledDNN::nOutputs; i++) reference[e][i] = out[i];
+    }
+
+    // Time each backend & compare to the reference
+    for (const auto& backend : backends){
+        double maxDeviation(0.);
+        double sum(0.);          // keep the compiler from removing the loop
+
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned int e=0; e<inputs.size(); e++){
+            outputArray out;
+            backend.second(inputs[e],out);
+            for (unsigned int i=0; i<compiledDNN::nOutputs; i++){
+                sum += out[i];
+                maxDeviation = std::max( maxDeviation, std::abs(out[i]-reference[e][i]) );
+            }
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << " BENCHMARK : " << backend.first
+                  << "\t " << inputs.size()/elapsed << " jets/s"
+                  << "\t max. deviation = " << maxDeviation
+                  << "\t (sum = " << sum << ")" << std::endl;
+    }
+
+    return 0;
+#endif
+}
+
+// THE END
@@ -0,0 +1,120 @@
+/*
+Created:        19 October 2026
+Last Updated:   19 October 2026
+
+agent
+agent@local
+-----
+
+Throughput of the event builders
+ - Every specialization of the builder that can be used for the first input file
+   (data: DNN inference x kinematic reconstruction; MC: truth matching x DNN inference)
+ - The same entries are built with each one; the first pass only fills the caches & pools
+
+DNN inference is only timed if it is enabled in the configuration ('DNNinference'),
+and truth matching only for ttbar samples.
+
+To run:
+   benchmarkEvent <configuration> [nEvents]
+*/
+#include "TROOT.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TTreeReader.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+
+#include "Analysis/cheetah/interface/tools.h"
+#include "Analysis/cheetah/interface/configuration.h"
+#include "Analysis/cheetah/interface/fileLoader.h"
+#include "Analysis/cheetah/interface/Event.h"
+
+
+int main(int argc, char** argv) {
+    /* Benchmark the specializations of the event builder */
+    if (argc < 2) {
+        std::cout << "\n   To run:" << std::endl;
+        std::cout << "      benchmarkEvent <configuration> [nEvents]\n" << std::endl;
+        return -1;
+    }
+
+    configuration config(argv[1]);
+    config.initialize();
+
+    long long nEvents = (argc>2) ? std::stoll(argv[2]) : 10000;
+    std::vector<std::string> filenames = config.filesToProcess();
+    std::string treename(config.treename());
+
+    if (filenames.size()<1){
+        cma::ERROR("BENCHMARK : No input files in the configuration");
+        return -1;
+    }
+
+    // First input file
+    fileLoader loader;
+    loader.initialize( std::vector<std::string>(1,filenames.at(0)), config.metadataTreeName() );
+
+    inputFile input;
+    if (!loader.next(input) || !input.isValid || !input.file){
+        cma::ERROR("BENCHMARK : Cannot open "+filenames.at(0));
+        return -1;
+    }
+
+    TTree* inputTree = (TTree*)input.file->Get(treename.c_str());
+    if (!inputTree){
+        cma::ERROR("BENCHMARK : No TTree "+treename+" in "+input.filename);
+        return -1;
+    }
+
+    config.setFilename( input.filename );
+    config.setMetadata( input.primaryDataset );
+
+    Long64_t nEntries = inputTree->GetEntries();
+    if (nEvents<0 || nEvents>nEntries) nEvents = nEntries;
+
+    TTreeReader myReader(inputTree);
+    Event event(myReader, config);
+
+    std::cout << " BENCHMARK : " << nEvents << " events from " << input.filename
+              << " (" << ((config.isMC()) ? "MC" : "data") << ")" << std::endl;
+
+    // warm-up with the builder of the configuration
+    for (Long64_t entry=0; entry<nEvents; entry++)
+        event.execute(entry);
+
+    // Time each specialization
+    for (unsigned int truth=0; truth<2; truth++){
+        for (unsigned int dnn=0; dnn<2; dnn++){
+            for (unsigned int reco=0; reco<2; reco++){
+                if (config.isMC() && reco>0) continue;     // not part of the MC builders
+                if (!event.setBuilder( truth>0, dnn>0, reco>0 )) continue;
+
+                std::string name = (config.isMC()) ?
+                    "buildMC<isTtbar="+std::to_string(config.isTtbar())+",truthMatching="+std::to_string(truth)+",dnnInference="+std::to_string(dnn)+">" :
+                    "buildData<dnnInference="+std::to_string(dnn)+",kinematicReco="+std::to_string(reco)+">";
+
+                unsigned long long nLjets(0);  // keep the compiler from removing the loop
+                auto start = std::chrono::steady_clock::now();
+                for (Long64_t entry=0; entry<nEvents; entry++){
+                    event.execute(entry);
+                    nLjets += event.ljets().size();
+                }
+                double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                std::cout << " BENCHMARK : " << name
+                          << "\t " << nEvents/elapsed << " events/s"
+                          << "\t (" << nLjets << " large-R jets)" << std::endl;
+            }
+        }
+    }
+
+    event.finalize();
+
+    return 0;
+}
+
+// THE END
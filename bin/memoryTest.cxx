@@ -0,0 +1,158 @@
+/*
+Created:        19 October 2026
+Last Updated:   19 October 2026
+
+agent
+agent@local
+-----
+
+Memory test for long jobs
+ - One TTreeReader and one Event are kept for the whole job (as in 'training'):
+   readers, tools, and object pools are made once and reused for every file
+ - The inputs of the configuration are processed several times; every event
+   is built and passed to the selections (incl. the systematic variations)
+ - The resident memory is reported after every pass: once the first pass has
+   filled the pools and ROOT caches, it should stay flat
+
+Returns 1 if the resident memory grows by more than maxGrowthMB
+between the end of the first pass and the end of the last pass.
+
+To run:
+   memoryTest <configuration> [nPasses] [maxGrowthMB]
+*/
+#include "TROOT.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TSystem.h"
+#include "TTreeReader.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "Analysis/cheetah/interface/tools.h"
+#include "Analysis/cheetah/interface/configuration.h"
+#include "Analysis/cheetah/interface/fileLoader.h"
+#include "Analysis/cheetah/interface/Event.h"
+#include "Analysis/cheetah/interface/eventSelection.h"
+
+
+double residentMemoryMB(){
+    /* Resident memory of this process */
+    ProcInfo_t procInfo;
+    gSystem->GetProcInfo(&procInfo);  // memory in kB
+    return procInfo.fMemResident/1024.;
+}
+
+
+int main(int argc, char** argv) {
+    /* Process the same inputs several times and check the resident memory */
+    if (argc < 2) {
+        std::cout << "\n   To run:" << std::endl;
+        std::cout << "      memoryTest <configuration> [nPasses] [maxGrowthMB]\n" << std::endl;
+        return -1;
+    }
+
+    configuration config(argv[1]);
+    config.initialize();
+
+    unsigned int nPasses = (argc>2) ? std::stoul(argv[2]) : 5;
+    double maxGrowthMB   = (argc>3) ? std::stod(argv[3]) : 10.;
+    if (nPasses<2) nPasses = 2;        // the first pass fills the pools
+
+    std::vector<std::string> filenames  = config.filesToProcess();
+    std::vector<std::string> selections = config.selections();
+    std::vector<std::string> cutsfiles  = config.cutsfiles();
+    std::vector<std::string> variations = config.systematics();
+    std::string treename(config.treename());
+
+    if (selections.size()!=cutsfiles.size()){
+        cma::ERROR("MEMORYTEST : Number of selections and cutsfiles are different");
+        return -1;
+    }
+
+    // selections (the cutflows are kept in memory for the whole job)
+    TDirectory* cutflowDir = gROOT->mkdir("memoryTest");
+    std::vector<std::unique_ptr<eventSelection> > evtSels;
+    for (const auto& variation : variations){
+        for (unsigned int s=0; s<selections.size(); s++){
+            evtSels.emplace_back( new eventSelection(config) );
+            evtSels.back()->initialize( selections.at(s), cutsfiles.at(s) );
+            evtSels.back()->setCutflowHistograms( *cutflowDir->mkdir( (variation+"_"+selections.at(s)).c_str() ) );
+        }
+    }
+    unsigned int nSelections = selections.size();
+
+    TTreeReader myReader;                  // pointed to the TTree of each file
+    std::unique_ptr<Event> eventPtr;       // made for the first file; readers & tools are kept for the others
+
+    std::vector<double> memory;
+    for (unsigned int pass=0; pass<nPasses; pass++){
+        unsigned long long nEvents(0);
+
+        fileLoader loader;
+        loader.initialize( filenames, config.metadataTreeName() );
+
+        inputFile input;
+        while (loader.next(input)) {
+            if (!input.isValid || !input.file){
+                cma::WARNING("MEMORYTEST : Cannot open "+input.filename+"; skipping it");
+                continue;
+            }
+
+            TTree* inputTree = (TTree*)input.file->Get(treename.c_str());
+            if (!inputTree){
+                cma::WARNING("MEMORYTEST : No TTree "+treename+" in "+input.filename+"; skipping it");
+                continue;
+            }
+
+            config.setFilename( input.filename );
+            config.setMetadata( input.primaryDataset );
+
+            myReader.SetTree( inputTree );
+            if (!eventPtr)
+                eventPtr.reset( new Event(myReader, config) );
+            else
+                eventPtr->newFile();
+            Event& event = *eventPtr;
+
+            Long64_t entry(0);
+            while (myReader.Next()){
+                event.execute(entry);
+                for (unsigned int v=0; v<variations.size(); v++){
+                    event.setVariation( variations.at(v) );
+                    for (unsigned int s=0; s<nSelections; s++){
+                        eventSelection& evtSel = *evtSels.at(v*nSelections+s);
+                        evtSel.setObjects(event);
+                        if (evtSel.applySelection()) event.ttbarReconstruction();
+                    }
+                }
+                entry++;
+                nEvents++;
+            }
+
+            event.finalize();
+            myReader.SetTree( (TTree*)nullptr );   // the input file is closed below
+            input.file.reset();
+        }
+
+        memory.push_back( residentMemoryMB() );
+        std::cout << " MEMORYTEST : pass " << pass+1 << "/" << nPasses
+                  << "\t " << nEvents << " events"
+                  << "\t RSS = " << memory.back() << " MB" << std::endl;
+    }
+
+    double growth = memory.back() - memory.front();
+    std::cout << " MEMORYTEST : RSS growth after the first pass = " << growth << " MB"
+              << " (allowed: " << maxGrowthMB << " MB)" << std::endl;
+
+    if (growth>maxGrowthMB){
+        cma::ERROR("MEMORYTEST : Resident memory is not flat over the job");
+        return 1;
+    }
+
+    return 0;
+}
+
+// THE END
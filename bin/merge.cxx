@@ -0,0 +1,76 @@
+/*
+Created:        19 October 2026
+Last Updated:   19 October 2026
+
+agent
+agent@local
+-----
+
+Steering macro for merging the outputs of cheetah jobs
+ - Replaces 'hadd' for histograms, features, and metadata
+
+To run:
+   merge <output.root> <input.root|inputs.txt> [<input.root> ...] [-j <nThreads>]
+ where 'inputs.txt' lists one file per line
+ (only the first column is used, so a 'manifest.txt' from training can be merged directly)
+*/
+#include "TROOT.h"
+#include "TH1.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sstream>
+
+#include "Analysis/cheetah/interface/tools.h"
+#include "Analysis/cheetah/interface/outputMerger.h"
+
+
+int main(int argc, char** argv) {
+    /* Steering macro for merging */
+    if (argc < 3) {
+        std::cout << "\n   To run:" << std::endl;
+        std::cout << "      merge <output.root> <input.root|inputs.txt> [<input.root> ...] [-j <nThreads>]\n" << std::endl;
+        return -1;
+    }
+
+    std::string outputFilename(argv[1]);
+    std::vector<std::string> filenames;
+    unsigned int nThreads(0);              // 0 = all cores
+
+    for (int i=2; i<argc; i++){
+        std::string arg(argv[i]);
+        if (arg.compare("-j")==0 && i+1<argc){
+            nThreads = std::stoi(argv[++i]);
+            continue;
+        }
+
+        std::size_t pos = arg.find_last_of(".");
+        if (pos!=std::string::npos && arg.substr(pos).compare(".txt")==0){
+            std::vector<std::string> lines;
+            cma::read_file( arg, lines );      // list of files
+            for (const auto& line : lines){
+                std::istringstream lineStream(line);
+                std::string name("");
+                lineStream >> name;
+                if (name.size()>0) filenames.push_back( name );
+            }
+        }
+        else
+            filenames.push_back( arg );
+    }
+
+    // histograms are read on several threads at once
+    ROOT::EnableThreadSafety();
+    TH1::AddDirectory(kFALSE);
+
+    outputMerger merger;
+    merger.initialize( filenames, nThreads );
+    bool success = merger.execute( outputFilename );
+
+    cma::INFO("MERGE : Program finished. ");
+
+    return (success) ? 0 : 1;
+}
+
+// THE END
@@ -36,10 +36,20 @@ Basic steering macro for running cheetah
 
 #include "Analysis/cheetah/interface/tools.h"
 #include "Analysis/cheetah/interface/configuration.h"
+#include "Analysis/cheetah/interface/fileIndex.h"
+#include "Analysis/cheetah/interface/fileLoader.h"
+#include "Analysis/cheetah/interface/chainedInput.h"
+#include "Analysis/cheetah/interface/duplicateFilter.h"
+#include "Analysis/cheetah/interface/lumiMask.h"
 #include "Analysis/cheetah/interface/Event.h"
+#include "Analysis/cheetah/interface/ljetObservables.h"
 #include "Analysis/cheetah/interface/eventSelection.h"
 #include "Analysis/cheetah/interface/miniTree.h"
 #include "Analysis/cheetah/interface/histogrammer.h"
+#include "Analysis/cheetah/interface/skimmer.h"
+#include "Analysis/cheetah/interface/selectionCache.h"
+#include "Analysis/cheetah/interface/outputManifest.h"
+#include "Analysis/cheetah/interface/telemetry.h"
 
 
 int main(int argc, char** argv) {
@@ -61,7 +71,8 @@ int main(int argc, char** argv) {
     std::string outpathBase = config.outputFilePath();            // directory for output files
     unsigned long long firstEvent      = config.firstEvent();     // first event to begin running over
     std::vector<std::string> filenames = config.filesToProcess(); // list of files to process
-    std::string selection(config.selections().at(0));             // selection to apply (only assuming 1 at the moment)
+    std::vector<std::string> selections = config.selections();    // selections to apply (all in the same pass)
+    std::vector<std::string> cutsfiles  = config.cutsfiles();
     std::string treename(config.treename());
 
     std::string customDirectory( config.customDirectory() );
@@ -69,96 +80,333 @@ int main(int argc, char** argv) {
         customDirectory = "_"+customDirectory; // add '_' to beginning of string, if needed
     }
 
-    // event selection
-    eventSelection evtSel( config );
-    evtSel.initialize(selection, config.cutsfiles().at(0) ); // need event selection and cutsfiles names
+    if (selections.size()!=cutsfiles.size()){
+        cma::ERROR("TRAIN : Number of selections ("+std::to_string(selections.size())+") and cutsfiles ("+std::to_string(cutsfiles.size())+") are different");
+        return -1;
+    }
+
+    // systematic variations evaluated in the same pass over the input
+    std::vector<std::string> variations = config.systematics();
+
+    // -- Output channels: one per variation and selection -- //
+    // each has its own event selection (and cutflow), histograms, and features tree
+    // grouped by variation so each variation is only built once per event
+    std::vector<std::string> channelVariations;
+    std::vector<std::string> channelDirectories;   // directory in the output file ("" = top of the file)
+    std::vector<std::unique_ptr<eventSelection> > evtSels;
+    selectionCache selCache(config);               // passing entries from previous runs with the same selections
+    for (const auto& variation : variations){
+        for (unsigned int s=0, nSel=selections.size(); s<nSel; s++){
+            std::string directory = (nSel>1) ? selections.at(s) : "";
+            if (variation.compare("nominal")!=0)
+                directory = (directory.size()>0) ? directory+"/"+variation : variation;
+
+            channelVariations.push_back( variation );
+            channelDirectories.push_back( directory );
+
+            evtSels.emplace_back( new eventSelection(config) );
+            evtSels.back()->initialize(selections.at(s), cutsfiles.at(s) ); // need event selection and cutsfiles names
+            selCache.addChannel( variation, selections.at(s), cutsfiles.at(s) );
+        }
+    }
+    unsigned int nChannels = evtSels.size();
+
+    // -- Events in more than one dataset (data): kept in the first file that has them -- //
+    duplicateFilter duplicates(config);
+    duplicates.initialize();
+    std::string selectionCacheDirectory = config.selectionCache();
+    bool incremental = config.incremental();
+    if (duplicates.enabled()){
+        duplicates.order( filenames );       // preferred datasets first
+        if (selectionCacheDirectory.size()>0){
+            cma::WARNING("TRAIN : The selection cache is not used when removing duplicate events (every event must be checked)");
+            selectionCacheDirectory = "";
+        }
+        if (incremental){
+            cma::WARNING("TRAIN : Incremental processing is not used when removing duplicate events (skipped inputs would not fill the duplicate filter)");
+            incremental = false;
+        }
+        if (config.nJobs()>1)
+            cma::WARNING("TRAIN : Duplicate events are only removed among the inputs processed in this job");
+    }
+
+    // -- Certified luminosity sections (data) -- //
+    lumiMask mask(config);
+    mask.initialize( config.lumiMask() );
+    if (mask.enabled()){
+        if (selectionCacheDirectory.size()>0){
+            cma::WARNING("TRAIN : The selection cache is not used with a lumi mask (every luminosity section must be recorded)");
+            selectionCacheDirectory = "";
+        }
+    }
+    selCache.initialize( selectionCacheDirectory );
+
+
+    // input files are opened on a helper thread while the event loop runs
+    ROOT::EnableThreadSafety();
+
+    // -- Output directory (same for all files) -- //
+    cma::DEBUG("TRAIN : setup output directory ");
+    struct stat dirBuffer;
+    std::string outpath = outpathBase+"/"+selections.at(0);
+    for (unsigned int s=1; s<selections.size(); s++)
+        outpath += "-"+selections.at(s);                // same convention as the batch submission
+    outpath += customDirectory;
+    if ( !(stat((outpath).c_str(),&dirBuffer)==0 && S_ISDIR(dirBuffer.st_mode)) ){
+        cma::DEBUG("TRAIN : Creating directory for storing output: "+outpath);
+        system( ("mkdir "+outpath).c_str() );  // make the directory so the files are grouped together
+    }
+
+    // slimmed copy of the input ntuple for events that pass any selection
+    bool makeSkim = config.makeSkim();
+    std::string skimpath = outpath+"/skim";
+    if ( makeSkim && !(stat((skimpath).c_str(),&dirBuffer)==0 && S_ISDIR(dirBuffer.st_mode)) ){
+        cma::DEBUG("TRAIN : Creating directory for storing skims: "+skimpath);
+        system( ("mkdir "+skimpath).c_str() );
+    }
+
+    // incremental processing: skip inputs whose output is up to date (same input, configuration, and code)
+    outputManifest manifest(config);
+    if (incremental){
+        std::string jobHash = cma::hashToStr( cma::hash(eventSelection::codeVersion(), config.hash()) );
+        manifest.initialize( outpath+"/manifest.txt", jobHash );
+    }
+
+
+    fileIndex index(config);               // metadata of files seen in previous runs
+    index.initialize( config.fileIndex() );
+
+    // -- Entries of all inputs as one sequence (firstEvent/NEvents and job splitting span file boundaries) -- //
+    bool globalEntries = config.globalEntries();
+    std::vector<fileSegment> jobSegments;  // entries of each file processed by this job (same order as 'filenames')
+    if (globalEntries){
+        chainedInput chain(config);
+        chain.initialize( filenames, treename, index );   // number of entries from the index
+        chain.setRange( firstEvent, nEvents, config.jobIndex(), config.nJobs() );
+
+        entryRange range;
+        while (chain.claim(range)){
+            for (const auto& segment : chain.segments(range)){
+                if (jobSegments.size()>0 && jobSegments.back().file==segment.file)
+                    jobSegments.back().end = segment.end;     // ranges are claimed in order
+                else
+                    jobSegments.push_back( segment );
+            }
+        }
+
+        filenames.clear();
+        for (const auto& segment : jobSegments)
+            filenames.push_back( segment.filename );
+    }
+
+    // duplicates are only found among the inputs of this job
+    if (duplicates.enabled()){
+        std::vector<std::string> missing = duplicates.missingDatasets( filenames );
+        if (missing.size()>0)
+            cma::WARNING("TRAIN : No inputs from "+cma::vectorToStr(missing)+" in this job; duplicates with these datasets are not removed");
+    }
 
 
     // --------------- //
     // -- File loop -- //
     // --------------- //
-    unsigned int numberOfFiles(filenames.size());
+    telemetry monitor(config);             // progress & resource usage of the event loop
+    monitor.initialize( config.telemetry(), config.telemetryInterval() );
+
+    fileLoader loader;
+    loader.setFileIndex( index );
+    loader.initialize( filenames, config.metadataTreeName() );   // start preparing the first file
+
+    TTreeReader myReader;                  // pointed to the TTree of each file
+    std::unique_ptr<Event> eventPtr;       // made for the first file; readers & tools are kept for the others
+
+    unsigned int numberOfFiles(loader.numberOfFiles());
     unsigned int currentFileNumber(0);
+    unsigned int nSkippedFiles(0);         // inputs not processed (not in the report of luminosity sections)
+    unsigned int nPartialFiles(0);         // inputs processed in part
+    inputFile input;
     cma::INFO("TRAIN : *** Starting file loop *** ");
-    for (const auto& filename : filenames) {
+    while (loader.next(input)) {           // waits for file N; starts preparing file N+1
 
         ++currentFileNumber;
+        std::string filename = input.filename;
         cma::INFO("TRAIN :   Opening "+filename+"   ("+std::to_string(currentFileNumber)+"/"+std::to_string(numberOfFiles)+")");
 
-        auto file = TFile::Open(filename.c_str());
-        if (!file || file->IsZombie()){
+        if (!input.isValid){
             cma::WARNING("TRAIN :  -- File: "+filename);
             cma::WARNING("TRAIN :     does not exist or it is a Zombie. ");
             cma::WARNING("TRAIN :     Continuing to next file. ");
+            nSkippedFiles++;
             continue;
         }
+        TFile* file = input.file.get();
 
-        cma::DEBUG("TRAIN : set file name and inspect ");
-        config.setFilename( filename );   // Use the filename to determine primary dataset and information about the sample
-        config.inspectFile( *file );      // Determine information about the input file (metadata)
+        cma::DEBUG("TRAIN : set file name and metadata ");
+        config.setFilename( filename );              // Use the filename to determine primary dataset and information about the sample
+        config.setMetadata( input.primaryDataset );  // Information about the input file (read on the helper thread)
 
-        cma::DEBUG("TRAIN : get list of keys ");
-        std::vector<std::string> fileKeys;
-        cma::getListOfKeys(file,fileKeys);      // keep track of ttrees in file
+        std::vector<std::string>& fileKeys = input.keys;   // keep track of ttrees in file
 
+        // normalization: always from the metadata file (it may change without the input file changing)
+        Sample sample = config.sample( input.primaryDataset );
 
-        // -- Output file -- //
-        cma::DEBUG("TRAIN : setup output directory ");
-        struct stat dirBuffer;
-        std::string outpath = outpathBase+"/"+selection+customDirectory;
-        if ( !(stat((outpath).c_str(),&dirBuffer)==0 && S_ISDIR(dirBuffer.st_mode)) ){
-            cma::DEBUG("TRAIN : Creating directory for storing output: "+outpath);
-            system( ("mkdir "+outpath).c_str() );  // make the directory so the files are grouped together
+        // number of entries: from the file index, or set once the TTree is accessed
+        fileIndexEntry metadata = input.metadata;
+        if (!input.isIndexed){
+            metadata.filename = filename;
+            metadata.keys     = fileKeys;
+            metadata.primaryDataset = input.primaryDataset;
+            metadata.treename = "";
+            metadata.entries  = -1;
         }
 
+
+        // -- Output file -- //
         std::size_t pos   = filename.find_last_of(".");     // the last ".", i.e., ".root"
         std::size_t found = filename.find_last_of("/");     // the last "/"
         std::string outputFilename = filename.substr(found+1,pos-1-found); // betwee "/" and "."
         // hopefully this returns: "diboson_WW_361082" given something like:
         // "/some/path/to/file/diboson_WW_361082.root"
 
+        // jobs that share an input file write separate outputs (combine them with 'merge')
+        if (config.nJobs()>1)
+            outputFilename += "_job"+std::to_string(config.jobIndex());
+
         std::string fullOutputFilename = outpath+"/"+outputFilename+".root";
+
+        if (incremental){
+            long long treeEntries(0);
+            if (metadata.treename.compare(treename)==0 && metadata.entries>=0)
+                treeEntries = metadata.entries;
+            else{
+                TTree* tree = (TTree*)file->Get(treename.c_str());
+                treeEntries = (tree) ? tree->GetEntries() : 0;
+            }
+            // entries of this input that go into the output (as set for the event loop below)
+            long long segmentBegin(firstEvent), segmentEnd(treeEntries);
+            if (globalEntries){
+                segmentBegin = jobSegments.at(currentFileNumber-1).begin;
+                segmentEnd   = jobSegments.at(currentFileNumber-1).end;
+            }
+            else if (nEvents>=0 && ((unsigned int)nEvents+firstEvent) <= (unsigned long long)treeEntries)
+                segmentEnd = firstEvent+nEvents;
+
+            if (manifest.upToDate(filename, fullOutputFilename, treeEntries, segmentBegin, segmentEnd)){
+                cma::INFO("TRAIN :   >> Output is up to date: "+fullOutputFilename);
+                nSkippedFiles++;
+                continue;
+            }
+        }
+
         std::unique_ptr<TFile> outputFile(TFile::Open( fullOutputFilename.c_str(), "RECREATE"));
         cma::INFO("TRAIN :   >> Saving to "+fullOutputFilename);
 
-        histogrammer histMaker(config,"ML");      // initialize histogrammer
-        histMaker.initialize( *outputFile );
+        // one directory per selection (if more than one); nominal at the top, variations below
+        std::vector<TDirectory*> outputDirs;
+        std::vector<std::unique_ptr<histogrammer> > histMakers;
+        for (unsigned int c=0; c<nChannels; c++){
+            TDirectory* outputDir = cma::getDirectory( *outputFile, channelDirectories.at(c) );
+            outputDirs.push_back( outputDir );
 
-        evtSel.setCutflowHistograms( *outputFile );
+            histMakers.emplace_back( new histogrammer(config,"ML") );   // initialize histogrammer
+            histMakers.back()->initialize( *outputDir );
+            histMakers.back()->setNumberOfSlots( 1 );                 // one slot per thread filling histograms (the event loop)
+
+            evtSels.at(c)->setCutflowHistograms( *outputDir );
+        }
 
         // check that the ttree exists in this file before proceeding
         if (std::find(fileKeys.begin(), fileKeys.end(), treename) == fileKeys.end()){
             cma::INFO("TRAIN : TTree "+treename+" is not present in this file, continuing to next TTree");
+            metadata.treename = treename;
+            metadata.entries  = 0;
+            index.update( metadata );
             continue;
         }
 
         // -- Load TTree to loop over
         cma::INFO("TRAIN :      TTree "+treename);
-        TTreeReader myReader(treename.c_str(), file);
+        TTree* inputTree = (TTree*)file->Get(treename.c_str());
+
+        skimmer skim(config);
+        if (makeSkim) skim.initialize( *file, treename, skimpath+"/"+outputFilename+".root" );
 
         // -- Make new Tree in Root file
-        miniTree miniTTree(config);          // initialize TTree for new file
-        miniTTree.initialize( *outputFile );
+        std::vector<std::unique_ptr<miniTree> > miniTTrees;
+        for (unsigned int c=0; c<nChannels; c++){
+            miniTTrees.emplace_back( new miniTree(config) );    // initialize TTree for new file
+            miniTTrees.back()->initialize( *outputDirs.at(c) );
+        }
 
         // -- Number of Entries to Process -- //
-        maxEntriesToRun = myReader.GetEntries(true);
+        if (metadata.treename.compare(treename)==0 && metadata.entries>=0)
+            maxEntriesToRun = metadata.entries;
+        else{
+            maxEntriesToRun   = inputTree->GetEntries();
+            metadata.treename = treename;
+            metadata.entries  = maxEntriesToRun;
+            index.update( metadata );
+        }
         if (maxEntriesToRun<1) // skip files with no entries
             continue;
 
-        if (nEvents < 0 || ((unsigned int)nEvents+firstEvent) > maxEntriesToRun)
+        if (globalEntries){
+            // entries of this file in the job's share of the chained inputs
+            const fileSegment& segment = jobSegments.at(currentFileNumber-1);
+            firstEvent = segment.begin;
+            numberOfEventsToRun = segment.end - segment.begin;
+        }
+        else if (nEvents < 0 || ((unsigned int)nEvents+firstEvent) > maxEntriesToRun)
             numberOfEventsToRun = maxEntriesToRun - firstEvent;
         else
             numberOfEventsToRun = nEvents;
 
+        // -- Selection results from a previous run (only when running over the full file) -- //
+        bool fullFile = (firstEvent==0 && numberOfEventsToRun==maxEntriesToRun);
+        if (!fullFile) nPartialFiles++;
+        bool useCache = selCache.load( filename, maxEntriesToRun ) && fullFile;
+        for (unsigned int c=0; useCache && c<nChannels; c++){
+            if (selCache.cutflow(c)->GetNbinsX()!=evtSels.at(c)->cutflow()->GetNbinsX())
+                useCache = false;
+        }
+        if (useCache){
+            for (unsigned int c=0; c<nChannels; c++)
+                evtSels.at(c)->restoreCutflows( *selCache.cutflow(c), *selCache.cutflow_unweighted(c) );
+        }
+        const std::vector<Long64_t>& cachedEntries = selCache.entries();
+        std::size_t cachedIndex(0);
+
         // ---------------- //
         // -- Event Loop -- //
         // ---------------- //
         Long64_t imod = 1;                     // print to the terminal
-        Event event = Event(myReader, config);
+        myReader.SetTree( inputTree );
+        if (!eventPtr){
+            eventPtr.reset( new Event(myReader, config) );
+            if (mask.enabled()) eventPtr->setLumiMask( mask );
+            if (duplicates.enabled()) eventPtr->setDuplicateFilter( duplicates );
+        }
+        else
+            eventPtr->newFile();
+        Event& event = *eventPtr;
+
+        // features of the saved AK8 (same keys for every event -- the map is re-used)
+        std::map<std::string,double> features2save;
+
+        monitor.startFile( *file, inputTree, filename,
+                           (useCache) ? cachedEntries.size() : numberOfEventsToRun );
+
+#ifdef CHEETAH_DEBUG_ALLOCATIONS
+        // heap allocations made while building & selecting events (after the first events fill the pools)
+        unsigned long long allocations(0);
+        Long64_t allocationEvents(0);
+        const Long64_t warmupEvents(100);
+#endif
 
         Long64_t eventCounter = 0;    // counting the events processed
         Long64_t entry = firstEvent;  // start at a different event!
-        while (myReader.Next()) {
+        while ( useCache ? cachedIndex<cachedEntries.size() : myReader.Next() ) {
+            if (useCache) entry = cachedEntries.at(cachedIndex++);   // only entries that passed a selection
 
             if (eventCounter+1 > numberOfEventsToRun){
                 cma::INFO("TRAIN : Processed the desired number of events: "+std::to_string(eventCounter)+"/"+std::to_string(numberOfEventsToRun));
@@ -170,71 +418,119 @@ int main(int argc, char** argv) {
                 if(imod<2e4) imod *=10;
             }
 
+#ifdef CHEETAH_DEBUG_ALLOCATIONS
+            unsigned long long allocationsBefore = cma::allocationCount();
+#endif
+
             // -- Build Event -- //
             cma::DEBUG("TRAIN : Execute event");
             event.execute(entry);
             // now we have event object that has the event-level objects in it
             // pass this to the selection tools
 
-            // -- Event Selection -- //
-            cma::DEBUG("TRAIN : Apply event selection");
-            evtSel.setObjects(event);
-            passEvent = evtSel.applySelection();
-
-            if (passEvent){
-                cma::DEBUG("TRAIN : Passed selection, now reconstruct ttbar & save information");
-                event.ttbarReconstruction();
-
-                // For ML, we are training on boosted top quarks in data!
-                // Only save features of the AK8 to the output ntuple/histograms
-                // didn't save metadata -- set these values to 1 for now
-                std::map<std::string,double> features2save;
-                features2save["xsection"] = 1.; //s.XSection;
-                features2save["kfactor"]  = 1.; //s.KFactor;
-                features2save["sumOfWeights"] = 1.; //s.sumOfWeights;
-                features2save["nominal_weight"] = 1.; //event.nominal_weight();
-
-                Ttbar1L tt = event.ttbar1L();             // setup for CWoLa (large-R jet from l+jets events)
-                Ljet ljet = tt.ljet;
-
-                // Quality cuts on the jets
-                // positive CSVv2 values, and subjet charges that aren't really large
-                if (ljet.features.at("ljet_subjet0_bdisc")>0 && ljet.features.at("ljet_subjet1_bdisc")>0 && 
-                    std::abs(ljet.features.at("ljet_subjet0_charge"))<20 && std::abs(ljet.features.at("ljet_subjet1_charge"))<20){
-
-                    for (const auto& x : ljet.features){
-                        features2save[x.first] = x.second;
-                    }
-                    // extra features for plotting
-                    features2save["ljet_BEST_t"] = ljet.BEST_t;
-                    features2save["ljet_BEST_w"] = ljet.BEST_w;
-                    features2save["ljet_BEST_z"] = ljet.BEST_z;
-                    features2save["ljet_BEST_h"] = ljet.BEST_h;
-                    features2save["ljet_BEST_j"] = ljet.BEST_j;
-                    features2save["ljet_SDmass"] = ljet.softDropMass;
-                    features2save["ljet_tau1"]   = ljet.tau1;
-                    features2save["ljet_tau2"]   = ljet.tau2;
-                    features2save["ljet_tau3"]   = ljet.tau3;
-                    features2save["ljet_tau21"]  = ljet.tau21;
-                    features2save["ljet_tau32"]  = ljet.tau32;
-                    features2save["ljet_isHadTop"] = ljet.isHadTop*1.0;
-                    features2save["ljet_contain"] = ljet.containment;
-
-                    miniTTree.saveEvent(features2save);
-                    histMaker.fill(features2save);
-                } // end quality cut on AK8
+            // -- Selections & systematic variations -- //
+            // the event is only read once; only the objects affected by a variation are rebuilt
+            bool passAny(false);
+            for (unsigned int c=0; c<nChannels; c++){
+                event.setVariation( channelVariations.at(c) );
+
+                // -- Event Selection -- //
+                cma::DEBUG("TRAIN : Apply event selection");
+                if (useCache)
+                    passEvent = selCache.passed(c,entry);   // cutflows were restored from the cache
+                else{
+                    evtSels.at(c)->setObjects(event);
+                    passEvent = evtSels.at(c)->applySelection();
+                    if (passEvent) selCache.record(c,entry);
+                }
+                passAny  |= passEvent;
+
+                if (passEvent){
+                    cma::DEBUG("TRAIN : Passed selection, now reconstruct ttbar & save information");
+                    event.ttbarReconstruction();
+
+                    // For ML, we are training on boosted top quarks in data!
+                    // Only save features of the AK8 to the output ntuple/histograms
+                    // sample normalization (1 for data)
+                    features2save["xsection"] = sample.XSection;
+                    features2save["kfactor"]  = sample.KFactor;
+                    features2save["sumOfWeights"] = sample.sumOfWeights;
+                    features2save["nominal_weight"] = 1.; //event.nominal_weight();
+
+                    const Ttbar1L& tt = event.ttbar1L();      // setup for CWoLa (large-R jet from l+jets events)
+                    const Ljet& ljet = tt.ljet;
+
+                    // Quality cuts on the jets
+                    // positive CSVv2 values, and subjet charges that aren't really large
+                    if (ljet.features.at("ljet_subjet0_bdisc")>0 && ljet.features.at("ljet_subjet1_bdisc")>0 && 
+                        std::abs(ljet.features.at("ljet_subjet0_charge"))<20 && std::abs(ljet.features.at("ljet_subjet1_charge"))<20){
+
+                        for (const auto& x : ljet.features){
+                            features2save[x.first] = x.second;
+                        }
+                        // extra features for plotting
+                        features2save["ljet_BEST_t"] = ljet.BEST_t;
+                        features2save["ljet_BEST_w"] = ljet.BEST_w;
+                        features2save["ljet_BEST_z"] = ljet.BEST_z;
+                        features2save["ljet_BEST_h"] = ljet.BEST_h;
+                        features2save["ljet_BEST_j"] = ljet.BEST_j;
+                        features2save["ljet_SDmass"] = ljet.softDropMass;
+                        features2save["ljet_tau1"]   = ljet.tau1;
+                        features2save["ljet_tau2"]   = ljet.tau2;
+                        features2save["ljet_tau3"]   = ljet.tau3;
+                        features2save["ljet_tau21"]  = ljetObservables::get(ljet,ljetObservables::tau21);
+                        features2save["ljet_tau32"]  = ljetObservables::get(ljet,ljetObservables::tau32);
+                        features2save["ljet_isHadTop"] = ljet.isHadTop*1.0;
+                        features2save["ljet_contain"] = ljet.containment;
+
+                        miniTTrees.at(c)->saveEvent(features2save);
+                        histMakers.at(c)->fill(features2save, 1.0, 0);   // slot 0: reduced in overUnderFlow()
+                    } // end quality cut on AK8
+                }
+            } // end loop over channels
+
+            if (makeSkim && passAny) skim.fill( myReader.GetCurrentEntry() );
+            monitor.update( passAny );
+
+#ifdef CHEETAH_DEBUG_ALLOCATIONS
+            if (eventCounter>=warmupEvents){
+                allocations += cma::allocationCount() - allocationsBefore;
+                allocationEvents++;
             }
+#endif
 
             // iterate the entry and number of events processed
             ++entry;
             ++eventCounter;
         } // end event loop
 
+#ifdef CHEETAH_DEBUG_ALLOCATIONS
+        if (allocationEvents>0)
+            cma::INFO("TRAIN :   Heap allocations per event = "+std::to_string(double(allocations)/allocationEvents)+
+                      " ("+std::to_string(allocations)+" in "+std::to_string(allocationEvents)+" events after the first "+std::to_string(warmupEvents)+")");
+#endif
+
+        monitor.endFile();
         event.finalize();
-        miniTTree.finalize();
+        myReader.SetTree( (TTree*)nullptr );   // the input file is closed below
+        if (makeSkim) skim.finalize();
+        for (unsigned int c=0; c<nChannels; c++){
+            miniTTrees.at(c)->finalize();
 
-        // put overflow/underflow content into the first and last bins
-        histMaker.overUnderFlow();
+            // put overflow/underflow content into the first and last bins
+            histMakers.at(c)->overUnderFlow();
+        }
+
+        // -- Save the selection results for the next run -- //
+        if (!useCache && fullFile && eventCounter==(Long64_t)numberOfEventsToRun){
+            std::vector<const TH1*> cutflows;
+            std::vector<const TH1*> cutflows_unweighted;
+            for (unsigned int c=0; c<nChannels; c++){
+                cutflows.push_back( evtSels.at(c)->cutflow() );
+                cutflows_unweighted.push_back( evtSels.at(c)->cutflow_unweighted() );
+            }
+            selCache.save( cutflows, cutflows_unweighted );
+        }
 
         cma::INFO("TRAIN :   END Running  "+filename);
         cma::INFO("TRAIN :   >> Output at "+fullOutputFilename);
@@ -242,12 +538,32 @@ int main(int argc, char** argv) {
         outputFile->Write();
         outputFile->Close();
 
+        if (incremental) manifest.update( filename, fullOutputFilename, maxEntriesToRun, firstEvent, firstEvent+numberOfEventsToRun );
+
         // -- Clean-up stuff
-        delete file;          // free up some memory 
-        file = ((TFile *)0);  // (no errors for too many root files open)
+        input.file.reset();   // free up some memory (no errors for too many root files open)
     } // end file loop
 
     cma::INFO("TRAIN : *** End of file loop *** ");
+    duplicates.summary();
+    mask.summary();
+    if (mask.enabled() && filenames.size()>0){
+        // one report per job, named after its first input (jobs write to the same directory)
+        std::string firstInput = filenames.at(0).substr( filenames.at(0).find_last_of("/")+1 );
+        std::string reportName = "processedLumis_"+firstInput.substr(0,firstInput.find_last_of("."));
+        if (config.nJobs()>1) reportName += "_job"+std::to_string(config.jobIndex());
+        mask.report( outpath+"/"+reportName+".json" );
+
+        if (config.nJobs()>1)
+            cma::WARNING("TRAIN : "+reportName+".json only covers job "+std::to_string(config.jobIndex())+" of "+std::to_string(config.nJobs()));
+        if (nSkippedFiles>0)
+            cma::WARNING("TRAIN : "+reportName+".json does not include "+std::to_string(nSkippedFiles)+" inputs that were skipped (invalid or up to date)");
+        if (nPartialFiles>0)
+            cma::WARNING("TRAIN : "+reportName+".json only includes part of the entries of "+std::to_string(nPartialFiles)+" inputs (firstEvent/NEvents or job splitting)");
+        cma::INFO("TRAIN : Combine the processedLumis_*.json of all jobs for the luminosity (e.g., compareJSON.py --or)");
+    }
+    index.write();
+    if (incremental) manifest.write();
     cma::INFO("TRAIN : Program finished. ");
 }
 
@@ -15,6 +15,7 @@
 #include "TParameter.h"
 #include "TEnv.h"
 #include "TF1.h"
+#include "TVector2.h"
 
 #include <string>
 #include <fstream>
@@ -28,19 +29,23 @@
 #include <vector>
 
 #include "Analysis/cheetah/interface/physicsObjects.h"
+#include "Analysis/cheetah/interface/objectPool.h"
 #include "Analysis/cheetah/interface/configuration.h"
 #include "Analysis/cheetah/interface/truthMatching.h"
 #include "Analysis/cheetah/interface/ttbarReco.h"
 #include "Analysis/cheetah/interface/neutrinoReco.h"
 #include "Analysis/cheetah/interface/deepLearning.h"
+#include "Analysis/cheetah/interface/duplicateFilter.h"
+#include "Analysis/cheetah/interface/lumiMask.h"
 
 
 // Event Class
 class Event {
   public:
     // Constructor
+    // 'myReader' must point to a TTree; the Event can be kept for all files (see newFile())
     Event( TTreeReader &myReader, configuration &cmaConfig);
-    Event( const Event &obj);
+    Event( const Event &obj) = delete;
 
     // Destructor
     virtual ~Event();
@@ -48,6 +53,15 @@ class Event {
     // check during looping over truth events, if reco event match is found
     bool isValidRecoEntry() const {return (m_entry > (long long)-1);}
 
+    // Run when the TTreeReader is pointed to the TTree of a new file (readers are rebound, not remade)
+    void newFile();
+
+    // Data: reject events already seen in another dataset (filter "noDuplicate"); shared by all files & threads
+    void setDuplicateFilter( duplicateFilter& filter );
+
+    // Data: reject events outside the certified luminosity sections (filter "lumiMask"); shared by all files & threads
+    void setLumiMask( lumiMask& mask );
+
     // Execute the event (load information and setup objects)
     void execute(Long64_t entry);
     void updateEntry(Long64_t entry);
@@ -66,13 +80,20 @@ class Event {
     void initialize_filters();
     void initialize_triggers();
 
-    // Get physics information
-    std::vector<Lepton> leptons() const {return m_leptons;}
-    std::vector<Electron> electrons() const {return m_electrons;}
-    std::vector<Muon> muons() const {return m_muons;}
-    std::vector<Neutrino> neutrinos() const {return m_neutrinos;}
-    std::vector<Ljet> ljets() const {return m_ljets;}
-    std::vector<Jet> jets() const {return m_jets;}
+    // Use another specialization of the event builder for this file (e.g., benchmarks) -- false if it cannot be used
+    bool setBuilder( const bool truthMatching, const bool dnnInference, const bool kinematicReco );
+
+    // Systematic variations of the jets in MC (nominal, jerUP, jerDOWN) -- call after execute()
+    void setVariation( const std::string& variation );
+    std::string variation() const {return m_variation;}
+
+    // Get physics information (references are valid until the next event)
+    const std::vector<Lepton>& leptons() const {return m_leptons;}
+    const std::vector<Electron>& electrons() const {return m_electrons;}
+    const std::vector<Muon>& muons() const {return m_muons;}
+    const std::vector<Neutrino>& neutrinos() const {return m_neutrinos;}
+    const std::vector<Ljet>& ljets() const {return m_ljets;}
+    const std::vector<Jet>& jets() const {return m_jets;}
 
     MET met() const {return m_met;}
     float HT() const {return m_HT;}
@@ -80,12 +101,20 @@ class Event {
 
     void ttbarReconstruction();
     void getBtaggedJets( Jet& jet );
-    std::vector<int> btag_jets(const std::string &wkpt) const;
-    std::vector<int> btag_jets() const {return m_btag_jets_default;} // using configured b-tag WP
+    const std::vector<int>& btag_jets(const std::string &wkpt) const;    // CSVv2 working point 'L','M','T'
+    const std::vector<int>& btag_jets(const btag::tagger t, const btag::wkpt w) const {return m_btag_jets.at(btag::index(t,w));}
+    const std::vector<int>& btag_jets() const {return btag_jets(btag::CSVv2,m_btagWkpt);} // using configured b-tag WP
+
+    // number of b-tagged AK4 (one bit per jet; the mask only holds the first 64 jets -- count the list beyond that)
+    unsigned int nbtags(const btag::tagger t, const btag::wkpt w) const {
+        unsigned int i = btag::index(t,w);
+        return (m_jets.size()<=64) ? __builtin_popcountll(m_btag_masks[i]) : m_btag_jets[i].size();
+    }
+    unsigned int nbtags() const {return nbtags(btag::CSVv2,m_btagWkpt);}
 
     // Get truth physics information 
-    std::vector<TruthTop> truth() {return m_truth_tops;}
-    std::vector<Parton> truth_partons() {return m_truth_partons;}
+    const std::vector<TruthTop>& truth() const {return m_truth_tops;}
+    const std::vector<Parton>& truth_partons() const {return m_truth_partons;}
 
     // Get metadata info
     unsigned long long eventNumber() {return **m_eventNumber;}
@@ -94,12 +123,12 @@ class Event {
     unsigned int lumiblock() const {return **m_lumiblock;}
     std::string treeName() const {return m_treeName;}
 
-    std::map<std::string,unsigned int> filters() const {return m_filters;}
-    std::map<std::string,unsigned int> triggers() const {return m_triggers;}
+    const std::map<std::string,unsigned int>& filters() const {return m_filters;}
+    const std::map<std::string,unsigned int>& triggers() const {return m_triggers;}
 
     // kinematic reconstruction, ML
     bool customIsolation( Lepton& lep );
-    Ttbar1L ttbar1L() const {return m_ttbar1L;}
+    const Ttbar1L& ttbar1L() const {return m_ttbar1L;}
     void deepLearningPrediction();
 
     // MC info & weights
@@ -107,6 +136,16 @@ class Event {
 
   protected:
 
+    // Event builders specialized at compile time for the sample type & enabled features
+    // -- the specialization is chosen once per file (setBuilder()); no configuration checks per event
+    void setBuilder();
+    template<bool dnnInference, bool kinematicReco> void buildData();
+    template<bool isTtbar, bool truthMatching, bool dnnInference> void buildMC();
+    template<bool truthMatching, bool dnnInference> void buildLjets();
+    template<bool kinematicReco> void buildReco();
+    void (Event::*m_builder)();
+    void (Event::*m_ljetBuilder)();
+
     // general information
     configuration *m_config;
     TTreeReader &m_ttree;
@@ -129,11 +168,11 @@ class Event {
     bool m_DNNinference;
     bool m_DNNtraining;
 
-    // External tools
-    ttbarReco* m_ttbarRecoTool;            // tool to perform ttbar reconstruction
-    deepLearning* m_cheetahTool;           // tool to perform deep learning on AK8 jets
-    truthMatching* m_truthMatchingTool;    // tool to perform truth-matching
-    neutrinoReco* m_neutrinoRecoTool;      // tool to perform neutrino reconsutrction
+    // External tools (made once per job)
+    std::unique_ptr<ttbarReco> m_ttbarRecoTool;            // tool to perform ttbar reconstruction
+    std::unique_ptr<deepLearning> m_cheetahTool;           // tool to perform deep learning on AK8 jets
+    std::unique_ptr<truthMatching> m_truthMatchingTool;    // tool to perform truth-matching
+    std::unique_ptr<neutrinoReco> m_neutrinoRecoTool;      // tool to perform neutrino reconsutrction
 
     Ttbar1L m_ttbar1L;
 
@@ -147,22 +186,33 @@ class Event {
     std::vector<Neutrino> m_neutrinos;
     std::vector<Ljet> m_ljets;
     std::vector<Jet>  m_jets;
-    std::vector<Jet>  m_jets_iso;          // for 2D lepton isolation
+    std::vector<Jet>  m_jets_iso;          // for 2D lepton isolation (nominal pT)
+
+    // jets are reused from one event to the next (keep the storage of their maps & vectors)
+    objectPool<Jet>  m_jetPool;
+    objectPool<Ljet> m_ljetPool;
+
+    // systematic variations
+    void selectJets();
+    std::string m_variation;
+    bool m_jerVariations;                  // JER variations requested: build the reconstructed objects in MC
+    int m_jerDirection;                    // +1 (jerUP), -1 (jerDOWN), 0 (nominal)
+    int m_ljetTarget;                      // CWoLa target of the nominal large-R jets
+    TVector2 m_metShift;                   // change in AK4 momentum from the nominal
 
     // truth physics object information
     std::vector<Parton> m_truth_partons;
     std::vector<TruthTop> m_truth_tops;
+    objectPool<TruthTop> m_truthTopPool;
     std::map<std::string,int> m_mapOfContainment;
 
-    // b-tagged calo jets with various WP
-    std::map<std::string, std::vector<int> > m_btag_jets;
-    std::vector<int> m_btag_jets_default;
-    float m_cMVAv2L;
-    float m_cMVAv2M;
-    float m_cMVAv2T;
-    float m_CSVv2L;
-    float m_CSVv2M;
-    float m_CSVv2T;
+    // b-tagged calo jets with various taggers & WP (indexed by btag::index())
+    // -- mask of jet indices (AK4 index<64) and list of jet indices
+    unsigned long long m_btag_masks[btag::nTaggers*btag::nWkpts];
+    std::vector<std::vector<int> > m_btag_jets;
+    float m_btag_thresholds[btag::nTaggers*btag::nWkpts];
+    btag::wkpt m_btagWkpt;                 // configured working point
+    void clearBtagging();
 
     // kinematics
     MET m_met;
@@ -172,191 +222,203 @@ class Event {
     float m_HT_ak4;
 
     std::map<std::string,unsigned int> m_filters;
+    duplicateFilter* m_duplicateFilter;    // optional (not owned)
+    unsigned int m_dataset;                // priority of the current dataset in the duplicate filter
+    unsigned int* m_noDuplicate;           // entry of m_filters
+    lumiMask* m_lumiMask;                  // optional (not owned)
+    unsigned int* m_lumiCertified;         // entry of m_filters
+    unsigned int m_lastRun;                // luminosity section of the previous event (same result)
+    unsigned int m_lastLumiblock;
     std::map<std::string,unsigned int> m_triggers;
+    // map entries are made once; the values are updated for each event
+    std::vector<std::pair<unsigned int*, TTreeReaderValue<unsigned int>*> > m_filterValues;
+    std::vector<std::pair<unsigned int*, TTreeReaderValue<unsigned int>*> > m_triggerValues;
 
     // ***********************************
     // TTree variables [all possible ones]
     // ***********************************
+    // owned here and attached to m_ttree (only the branches for the current sample type are read)
+    void initialize_readers();
     // Event info 
-    TTreeReaderValue<unsigned long long> * m_eventNumber;
-    TTreeReaderValue<unsigned int> * m_runNumber;
-    TTreeReaderValue<unsigned int> * m_lumiblock;
-    TTreeReaderValue<float> * m_treeXSection;
-    TTreeReaderValue<float> * m_treeKFactor;
-    TTreeReaderValue<float> * m_treeSumOfWeights;
-    TTreeReaderValue<unsigned int> * m_npv;
-    TTreeReaderValue<float> * m_rho;
-    TTreeReaderValue<unsigned int> * m_true_pileup;
+    std::unique_ptr<TTreeReaderValue<unsigned long long>> m_eventNumber;
+    std::unique_ptr<TTreeReaderValue<unsigned int>> m_runNumber;
+    std::unique_ptr<TTreeReaderValue<unsigned int>> m_lumiblock;
+    std::unique_ptr<TTreeReaderValue<float>> m_treeXSection;
+    std::unique_ptr<TTreeReaderValue<float>> m_treeKFactor;
+    std::unique_ptr<TTreeReaderValue<float>> m_treeSumOfWeights;
+    std::unique_ptr<TTreeReaderValue<unsigned int>> m_npv;
+    std::unique_ptr<TTreeReaderValue<float>> m_rho;
+    std::unique_ptr<TTreeReaderValue<unsigned int>> m_true_pileup;
 
     // MET
-    TTreeReaderValue<float> * m_met_met;
-    TTreeReaderValue<float> * m_met_phi;
-    TTreeReaderValue<float> * m_HTAK8;
-    TTreeReaderValue<float> * m_HTAK4;
+    std::unique_ptr<TTreeReaderValue<float>> m_met_met;
+    std::unique_ptr<TTreeReaderValue<float>> m_met_phi;
+    std::unique_ptr<TTreeReaderValue<float>> m_HTAK8;
+    std::unique_ptr<TTreeReaderValue<float>> m_HTAK4;
 
     // Leptons
-    TTreeReaderValue<std::vector<float>> * m_el_pt;
-    TTreeReaderValue<std::vector<float>> * m_el_eta;
-    TTreeReaderValue<std::vector<float>> * m_el_phi;
-    TTreeReaderValue<std::vector<float>> * m_el_e;
-    TTreeReaderValue<std::vector<float>> * m_el_charge;
-    TTreeReaderValue<std::vector<float>> * m_el_iso;
-    TTreeReaderValue<std::vector<unsigned int>> * m_el_id_loose;
-    TTreeReaderValue<std::vector<unsigned int>> * m_el_id_medium;
-    TTreeReaderValue<std::vector<unsigned int>> * m_el_id_tight;
-    TTreeReaderValue<std::vector<unsigned int>> * m_el_id_loose_noIso;
-    TTreeReaderValue<std::vector<unsigned int>> * m_el_id_medium_noIso;
-    TTreeReaderValue<std::vector<unsigned int>> * m_el_id_tight_noIso;
-
-    TTreeReaderValue<std::vector<float>> * m_mu_pt;
-    TTreeReaderValue<std::vector<float>> * m_mu_eta;
-    TTreeReaderValue<std::vector<float>> * m_mu_phi;
-    TTreeReaderValue<std::vector<float>> * m_mu_e;
-    TTreeReaderValue<std::vector<float>> * m_mu_charge;
-    TTreeReaderValue<std::vector<float>> * m_mu_iso;
-    TTreeReaderValue<std::vector<unsigned int>> * m_mu_id_loose;
-    TTreeReaderValue<std::vector<unsigned int>> * m_mu_id_medium;
-    TTreeReaderValue<std::vector<unsigned int>> * m_mu_id_tight;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_el_pt;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_el_eta;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_el_phi;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_el_e;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_el_charge;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_el_iso;
+    std::unique_ptr<TTreeReaderValue<std::vector<unsigned int>>> m_el_id_loose;
+    std::unique_ptr<TTreeReaderValue<std::vector<unsigned int>>> m_el_id_medium;
+    std::unique_ptr<TTreeReaderValue<std::vector<unsigned int>>> m_el_id_tight;
+    std::unique_ptr<TTreeReaderValue<std::vector<unsigned int>>> m_el_id_loose_noIso;
+    std::unique_ptr<TTreeReaderValue<std::vector<unsigned int>>> m_el_id_medium_noIso;
+    std::unique_ptr<TTreeReaderValue<std::vector<unsigned int>>> m_el_id_tight_noIso;
+
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_mu_pt;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_mu_eta;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_mu_phi;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_mu_e;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_mu_charge;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_mu_iso;
+    std::unique_ptr<TTreeReaderValue<std::vector<unsigned int>>> m_mu_id_loose;
+    std::unique_ptr<TTreeReaderValue<std::vector<unsigned int>>> m_mu_id_medium;
+    std::unique_ptr<TTreeReaderValue<std::vector<unsigned int>>> m_mu_id_tight;
 
     // Reconstructed neutrinos
-    TTreeReaderValue<std::vector<float>> * m_nu_pt;
-    TTreeReaderValue<std::vector<float>> * m_nu_eta;
-    TTreeReaderValue<std::vector<float>> * m_nu_phi;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_nu_pt;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_nu_eta;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_nu_phi;
 
     // large-R jet info
-    TTreeReaderValue<float> * m_dnn_score;
-
-    TTreeReaderValue<std::vector<float>> * m_ljet_pt;
-    TTreeReaderValue<std::vector<float>> * m_ljet_eta;
-    TTreeReaderValue<std::vector<float>> * m_ljet_phi;
-    TTreeReaderValue<std::vector<float>> * m_ljet_m;
-    TTreeReaderValue<std::vector<float>> * m_ljet_tau1;
-    TTreeReaderValue<std::vector<float>> * m_ljet_tau2;
-    TTreeReaderValue<std::vector<float>> * m_ljet_tau3;
-    TTreeReaderValue<std::vector<float>> * m_ljet_BEST_t;
-    TTreeReaderValue<std::vector<float>> * m_ljet_BEST_w;
-    TTreeReaderValue<std::vector<float>> * m_ljet_BEST_z;
-    TTreeReaderValue<std::vector<float>> * m_ljet_BEST_h;
-    TTreeReaderValue<std::vector<float>> * m_ljet_BEST_j;
-    TTreeReaderValue<std::vector<int>> * m_ljet_BEST_class;
-    TTreeReaderValue<std::vector<float>> * m_ljet_charge;
-    TTreeReaderValue<std::vector<float>> * m_ljet_chargeSD;
-    TTreeReaderValue<std::vector<float>> * m_ljet_charge3;
-    TTreeReaderValue<std::vector<float>> * m_ljet_charge10;
-
-    TTreeReaderValue<std::vector<float>> * m_ljet_SDmass;
-    TTreeReaderValue<std::vector<float>> * m_ljet_bdisc;
-    TTreeReaderValue<std::vector<float>> * m_ljet_area;
-    TTreeReaderValue<std::vector<float>> * m_ljet_subjet0_charge;
-    TTreeReaderValue<std::vector<float>> * m_ljet_subjet0_charge3;
-    TTreeReaderValue<std::vector<float>> * m_ljet_subjet0_charge10;
-    TTreeReaderValue<std::vector<float>> * m_ljet_subjet0_bdisc;
-    TTreeReaderValue<std::vector<float>> * m_ljet_subjet0_deepCSV;
-    TTreeReaderValue<std::vector<float>> * m_ljet_subjet0_pt;
-    TTreeReaderValue<std::vector<float>> * m_ljet_subjet0_mass;
-    TTreeReaderValue<std::vector<float>> * m_ljet_subjet0_tau1;
-    TTreeReaderValue<std::vector<float>> * m_ljet_subjet0_tau2;
-    TTreeReaderValue<std::vector<float>> * m_ljet_subjet0_tau3;
-    TTreeReaderValue<std::vector<float>> * m_ljet_subjet1_charge;
-    TTreeReaderValue<std::vector<float>> * m_ljet_subjet1_charge3;
-    TTreeReaderValue<std::vector<float>> * m_ljet_subjet1_charge10;
-    TTreeReaderValue<std::vector<float>> * m_ljet_subjet1_bdisc;
-    TTreeReaderValue<std::vector<float>> * m_ljet_subjet1_deepCSV;
-    TTreeReaderValue<std::vector<float>> * m_ljet_subjet1_pt;
-    TTreeReaderValue<std::vector<float>> * m_ljet_subjet1_mass;
-    TTreeReaderValue<std::vector<float>> * m_ljet_subjet1_tau1;
-    TTreeReaderValue<std::vector<float>> * m_ljet_subjet1_tau2;
-    TTreeReaderValue<std::vector<float>> * m_ljet_subjet1_tau3;
-    TTreeReaderValue<std::vector<float>> * m_ljet_uncorrPt;
-    TTreeReaderValue<std::vector<float>> * m_ljet_uncorrE;
-    TTreeReaderValue<std::vector<float>> * m_ljet_jerSF;
-    TTreeReaderValue<std::vector<float>> * m_ljet_jerSF_UP;
-    TTreeReaderValue<std::vector<float>> * m_ljet_jerSF_DOWN;
+    std::unique_ptr<TTreeReaderValue<float>> m_dnn_score;
+
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_pt;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_eta;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_phi;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_m;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_tau1;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_tau2;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_tau3;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_BEST_t;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_BEST_w;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_BEST_z;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_BEST_h;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_BEST_j;
+    std::unique_ptr<TTreeReaderValue<std::vector<int>>> m_ljet_BEST_class;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_charge;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_chargeSD;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_charge3;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_charge10;
+
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_SDmass;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_bdisc;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_area;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_subjet0_charge;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_subjet0_charge3;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_subjet0_charge10;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_subjet0_bdisc;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_subjet0_deepCSV;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_subjet0_pt;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_subjet0_mass;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_subjet0_tau1;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_subjet0_tau2;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_subjet0_tau3;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_subjet1_charge;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_subjet1_charge3;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_subjet1_charge10;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_subjet1_bdisc;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_subjet1_deepCSV;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_subjet1_pt;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_subjet1_mass;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_subjet1_tau1;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_subjet1_tau2;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_subjet1_tau3;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_uncorrPt;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_uncorrE;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_jerSF;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_jerSF_UP;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_ljet_jerSF_DOWN;
 
     // truth large-R jet info
-    TTreeReaderValue<std::vector<float>> * m_truth_ljet_pt;
-    TTreeReaderValue<std::vector<float>> * m_truth_ljet_eta;
-    TTreeReaderValue<std::vector<float>> * m_truth_ljet_phi;
-    TTreeReaderValue<std::vector<float>> * m_truth_ljet_m;
-    TTreeReaderValue<std::vector<float>> * m_truth_ljet_tau1;
-    TTreeReaderValue<std::vector<float>> * m_truth_ljet_tau2;
-    TTreeReaderValue<std::vector<float>> * m_truth_ljet_tau3;
-    TTreeReaderValue<std::vector<float>> * m_truth_ljet_SDmass;
-    TTreeReaderValue<std::vector<float>> * m_truth_ljet_charge;
-    TTreeReaderValue<std::vector<float>> * m_truth_ljet_area;
-    TTreeReaderValue<std::vector<float>> * m_truth_ljet_subjet0_charge;
-    TTreeReaderValue<std::vector<float>> * m_truth_ljet_subjet0_bdisc;
-    TTreeReaderValue<std::vector<float>> * m_truth_ljet_subjet1_charge;
-    TTreeReaderValue<std::vector<float>> * m_truth_ljet_subjet1_bdisc;
-    TTreeReaderValue<std::vector<float>> * m_truth_ljet_subjet1_deepCSV;
-    TTreeReaderValue<std::vector<float>> * m_truth_ljet_subjet1_pt;
-    TTreeReaderValue<std::vector<float>> * m_truth_ljet_subjet1_mass;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_truth_ljet_pt;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_truth_ljet_eta;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_truth_ljet_phi;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_truth_ljet_m;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_truth_ljet_tau1;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_truth_ljet_tau2;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_truth_ljet_tau3;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_truth_ljet_SDmass;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_truth_ljet_charge;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_truth_ljet_area;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_truth_ljet_subjet0_charge;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_truth_ljet_subjet0_bdisc;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_truth_ljet_subjet1_charge;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_truth_ljet_subjet1_bdisc;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_truth_ljet_subjet1_deepCSV;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_truth_ljet_subjet1_pt;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_truth_ljet_subjet1_mass;
 
 
     // Jet info
-    TTreeReaderValue<std::vector<float>> * m_jet_pt;
-    TTreeReaderValue<std::vector<float>> * m_jet_eta;
-    TTreeReaderValue<std::vector<float>> * m_jet_phi;
-    TTreeReaderValue<std::vector<float>> * m_jet_m;
-    TTreeReaderValue<std::vector<float>> * m_jet_bdisc;
-    TTreeReaderValue<std::vector<float>> * m_jet_deepCSV;
-    TTreeReaderValue<std::vector<float>> * m_jet_area;
-    TTreeReaderValue<std::vector<float>> * m_jet_uncorrPt;
-    TTreeReaderValue<std::vector<float>> * m_jet_uncorrE;
-    TTreeReaderValue<std::vector<float>> * m_jet_jerSF;
-    TTreeReaderValue<std::vector<float>> * m_jet_jerSF_UP;
-    TTreeReaderValue<std::vector<float>> * m_jet_jerSF_DOWN;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_jet_pt;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_jet_eta;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_jet_phi;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_jet_m;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_jet_bdisc;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_jet_deepCSV;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_jet_area;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_jet_uncorrPt;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_jet_uncorrE;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_jet_jerSF;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_jet_jerSF_UP;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_jet_jerSF_DOWN;
 
 
     // Truth jet info
-    TTreeReaderValue<std::vector<float>> * m_truth_jet_pt;
-    TTreeReaderValue<std::vector<float>> * m_truth_jet_eta;
-    TTreeReaderValue<std::vector<float>> * m_truth_jet_phi;
-    TTreeReaderValue<std::vector<float>> * m_truth_jet_e;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_truth_jet_pt;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_truth_jet_eta;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_truth_jet_phi;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_truth_jet_e;
 
 
-    TTreeReaderValue<int> * m_leptop_jet;
-    TTreeReaderValue<int> * m_hadtop_ljet;
+    std::unique_ptr<TTreeReaderValue<int>> m_leptop_jet;
+    std::unique_ptr<TTreeReaderValue<int>> m_hadtop_ljet;
 
     // Truth info
-    TTreeReaderValue<float> * m_weight_mc;
-    TTreeReaderValue<float> * m_weight_pileup;
-    TTreeReaderValue<float> * m_weight_lept_eff;
-    TTreeReaderValue<float> * m_weight_pileup_UP;
-    TTreeReaderValue<float> * m_weight_pileup_DOWN;
-
-    TTreeReaderValue<std::vector<float>> * m_mc_ht;
-    TTreeReaderValue<std::vector<float>> * m_mc_pt;
-    TTreeReaderValue<std::vector<float>> * m_mc_eta;
-    TTreeReaderValue<std::vector<float>> * m_mc_phi;
-    TTreeReaderValue<std::vector<float>> * m_mc_e;
-    TTreeReaderValue<std::vector<int>> * m_mc_pdgId;
-    TTreeReaderValue<std::vector<int>> * m_mc_status;
-    TTreeReaderValue<std::vector<int>> * m_mc_isHadTop;
-    TTreeReaderValue<std::vector<int>> * m_mc_parent_idx;
-    TTreeReaderValue<std::vector<int>> * m_mc_child0_idx;
-    TTreeReaderValue<std::vector<int>> * m_mc_child1_idx;
+    std::unique_ptr<TTreeReaderValue<float>> m_weight_mc;
+    std::unique_ptr<TTreeReaderValue<float>> m_weight_pileup;
+    std::unique_ptr<TTreeReaderValue<float>> m_weight_lept_eff;
+    std::unique_ptr<TTreeReaderValue<float>> m_weight_pileup_UP;
+    std::unique_ptr<TTreeReaderValue<float>> m_weight_pileup_DOWN;
+
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_mc_ht;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_mc_pt;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_mc_eta;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_mc_phi;
+    std::unique_ptr<TTreeReaderValue<std::vector<float>>> m_mc_e;
+    std::unique_ptr<TTreeReaderValue<std::vector<int>>> m_mc_pdgId;
+    std::unique_ptr<TTreeReaderValue<std::vector<int>>> m_mc_status;
+    std::unique_ptr<TTreeReaderValue<std::vector<int>>> m_mc_isHadTop;
+    std::unique_ptr<TTreeReaderValue<std::vector<int>>> m_mc_parent_idx;
+    std::unique_ptr<TTreeReaderValue<std::vector<int>>> m_mc_child0_idx;
+    std::unique_ptr<TTreeReaderValue<std::vector<int>>> m_mc_child1_idx;
 
     // HLT 
-    TTreeReaderValue<unsigned int> * m_HLT_Ele45_CaloIdVT_GsfTrkIdT_PFJet200_PFJet50;
-    TTreeReaderValue<unsigned int> * m_HLT_Ele50_CaloIdVT_GsfTrkIdT_PFJet165;
-    TTreeReaderValue<unsigned int> * m_HLT_Ele115_CaloIdVT_GsfTrkIdT;
-    TTreeReaderValue<unsigned int> * m_HLT_Mu40_Eta2P1_PFJet200_PFJet50;
-    TTreeReaderValue<unsigned int> * m_HLT_Mu50;
-    TTreeReaderValue<unsigned int> * m_HLT_TkMu50;
-    TTreeReaderValue<unsigned int> * m_HLT_PFHT800;
-    TTreeReaderValue<unsigned int> * m_HLT_PFHT900;
-    TTreeReaderValue<unsigned int> * m_HLT_AK8PFJet450;
-    TTreeReaderValue<unsigned int> * m_HLT_PFHT700TrimMass50;
-    TTreeReaderValue<unsigned int> * m_HLT_PFJet360TrimMass30;
+    std::unique_ptr<TTreeReaderValue<unsigned int>> m_HLT_Ele45_CaloIdVT_GsfTrkIdT_PFJet200_PFJet50;
+    std::unique_ptr<TTreeReaderValue<unsigned int>> m_HLT_Ele50_CaloIdVT_GsfTrkIdT_PFJet165;
+    std::unique_ptr<TTreeReaderValue<unsigned int>> m_HLT_Ele115_CaloIdVT_GsfTrkIdT;
+    std::unique_ptr<TTreeReaderValue<unsigned int>> m_HLT_Mu40_Eta2P1_PFJet200_PFJet50;
+    std::unique_ptr<TTreeReaderValue<unsigned int>> m_HLT_Mu50;
+    std::unique_ptr<TTreeReaderValue<unsigned int>> m_HLT_TkMu50;
+    std::unique_ptr<TTreeReaderValue<unsigned int>> m_HLT_PFHT800;
+    std::unique_ptr<TTreeReaderValue<unsigned int>> m_HLT_PFHT900;
+    std::unique_ptr<TTreeReaderValue<unsigned int>> m_HLT_AK8PFJet450;
+    std::unique_ptr<TTreeReaderValue<unsigned int>> m_HLT_PFHT700TrimMass50;
+    std::unique_ptr<TTreeReaderValue<unsigned int>> m_HLT_PFJet360TrimMass30;
 
     // Filters
-    TTreeReaderValue<unsigned int> * m_Flag_goodVertices;
-    TTreeReaderValue<unsigned int> * m_Flag_eeBadScFilter;
-    TTreeReaderValue<unsigned int> * m_Flag_HBHENoiseFilter;
-    TTreeReaderValue<unsigned int> * m_Flag_HBHENoiseIsoFilter;
-    TTreeReaderValue<unsigned int> * m_Flag_globalTightHalo2016Filter;
-    TTreeReaderValue<unsigned int> * m_Flag_EcalDeadCellTriggerPrimitiveFilter;
+    std::unique_ptr<TTreeReaderValue<unsigned int>> m_Flag_goodVertices;
+    std::unique_ptr<TTreeReaderValue<unsigned int>> m_Flag_eeBadScFilter;
+    std::unique_ptr<TTreeReaderValue<unsigned int>> m_Flag_HBHENoiseFilter;
+    std::unique_ptr<TTreeReaderValue<unsigned int>> m_Flag_HBHENoiseIsoFilter;
+    std::unique_ptr<TTreeReaderValue<unsigned int>> m_Flag_globalTightHalo2016Filter;
+    std::unique_ptr<TTreeReaderValue<unsigned int>> m_Flag_EcalDeadCellTriggerPrimitiveFilter;
 };
 
 #endif
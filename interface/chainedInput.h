@@ -0,0 +1,83 @@
+#ifndef CHAINEDINPUT_H
+#define CHAINEDINPUT_H
+
+#include "TROOT.h"
+#include "TFile.h"
+#include "TTree.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+
+#include "Analysis/cheetah/interface/tools.h"
+#include "Analysis/cheetah/interface/configuration.h"
+#include "Analysis/cheetah/interface/fileIndex.h"
+
+
+// Entries [begin,end) in the global entry space of all inputs (can span several files)
+struct entryRange {
+    Long64_t begin;
+    Long64_t end;
+};
+
+// Entries [begin,end) of a single input file (local to that file)
+struct fileSegment {
+    unsigned int file;        // position in the list of inputs
+    std::string filename;
+    Long64_t begin;
+    Long64_t end;
+};
+
+
+// All input files as one sequence of entries (offset table of the TTree in each file)
+// -- ranges of entries are claimed in units of basket clusters, independent of the file boundaries
+// -- the number of entries comes from the file index; only the files of this job are opened (for the clusters)
+class chainedInput {
+  public:
+    // Default
+    chainedInput( configuration& cmaConfig );
+
+    // Default - so we can clean up;
+    virtual ~chainedInput();
+
+    // Run once at the start of the job: number of entries of each file (file index, or opening files not in it)
+    void initialize( const std::vector<std::string>& filenames, const std::string& treename, fileIndex& index );
+
+    // Global entries [first,first+nEntries) (nEntries<0: all), split into 'nJobs' shares; keep share 'jobIndex'
+    void setRange( const Long64_t first, const Long64_t nEntries=-1, const unsigned int jobIndex=0, const unsigned int nJobs=1 );
+
+    // Thread-safe: claim the next range of entries (false when all ranges are claimed)
+    bool claim( entryRange& range );
+    void reset() {m_nextRange = 0;}
+
+    // Pieces of a global range in each file (attribute the entries to their file & sample)
+    std::vector<fileSegment> segments( const entryRange& range ) const;
+    unsigned int fileNumber( const Long64_t entry ) const;
+
+    unsigned int numberOfFiles() const {return m_filenames.size();}
+    const std::string& filename( const unsigned int file ) const {return m_filenames.at(file);}
+    Long64_t fileEntries( const unsigned int file ) const {return m_offsets.at(file+1)-m_offsets.at(file);}
+    Long64_t entries() const {return m_offsets.back();}
+    const std::vector<entryRange>& ranges() const {return m_ranges;}
+
+  protected:
+
+    Long64_t alignToCluster( const Long64_t entry, const Long64_t first, const Long64_t last ) const;
+    void loadClusters( const unsigned int file );
+
+    configuration *m_config;
+
+    std::string m_treename;
+    std::vector<std::string> m_filenames;
+    std::vector<Long64_t> m_offsets;      // global entry of the first entry in each file (+ total at the end)
+    std::vector<Long64_t> m_clusters;     // global entries where a basket cluster starts (sorted; file starts + loaded files)
+    std::vector<bool> m_clustersLoaded;   // clusters inside each file are read when needed
+
+    Long64_t m_rangeSize;                 // minimum number of entries in a claimed range
+    std::vector<entryRange> m_ranges;     // ranges of this job (cluster-aligned)
+    std::atomic<std::size_t> m_nextRange;
+};
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef COMPILEDDNN_H
+#define COMPILEDDNN_H
+
+/* Compiled network (used in deepLearning.cxx)
+   The network is generated from the lwtnn JSON file into the build directory (not tracked):
+   $ python python/lwtnn2header.py config/keras_ttbar_DNN.json [--calibration calibration.json]
+     => $CMSSW_BASE/tmp/$SCRAM_ARCH/cheetah/compiledDNNNetwork.h (on the include path, see BuildFile.xml)
+   -- the generated header defines CHEETAH_COMPILED_DNN
+   -- with the calibration (python/calibrateDNN.py) it also defines CHEETAH_COMPILED_DNN_INT8
+   -- re-compile after generating it ('touch interface/compiledDNN.h' the first time)
+   -- test/testCompiledDNN.cxx compares it to lwtnn
+   -- it records a hash of the JSON file; if 'dnnFile' is a different network, deepLearning uses lwtnn
+*/
+#if defined(__has_include)
+#if __has_include("compiledDNNNetwork.h")
+#include "compiledDNNNetwork.h"
+#endif
+#endif
+
+#endif
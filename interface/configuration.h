@@ -9,10 +9,22 @@
 
 #include <iostream>
 #include <sstream>
+#include <algorithm>
 
 #include "Analysis/cheetah/interface/tools.h"
 
 
+// Sample normalization (from the metadata file)
+struct Sample {
+    std::string sampleType;
+    std::string primaryDataset;
+    float XSection;
+    float sumOfWeights;
+    float KFactor;
+    unsigned int NEvents;
+};
+
+
 class configuration {
   public:
     // Default - so root can load based on a name;
@@ -33,6 +45,7 @@ class configuration {
     // Type of File(s) being processed
     virtual bool isMC() {return m_isMC;}              // must call "checkFileType(file)" or "isMC(file)" first!
     virtual bool isMC( TFile& file );
+    bool isTtbar() {return m_isTtbar;}                 // set with the primary dataset (setMetadata)
 
     // Type of analysis (all-hadronic, semi-leptonic, or di-leptonic)
     virtual bool isOneLeptonAnalysis() {return m_isOneLeptonAnalysis;}
@@ -54,6 +67,9 @@ class configuration {
     float CSVv2L() {return m_CSVv2L;}
     float CSVv2M() {return m_CSVv2M;}
     float CSVv2T() {return m_CSVv2T;}
+    float DeepCSVL() {return m_DeepCSVL;}
+    float DeepCSVM() {return m_DeepCSVM;}
+    float DeepCSVT() {return m_DeepCSVT;}
 
     std::vector<std::string> zeroLeptonTriggers() {return m_zeroLeptonTriggers;}
     std::vector<std::string> ejetsTriggers() {return m_ejetsTriggers;}
@@ -69,11 +85,30 @@ class configuration {
 
     // functions about the file
     void readMetadata(TFile& file, const std::string& metadataTreeName);
+    static std::string readPrimaryDataset(TFile& file, const std::string& metadataTreeName);
+    void setMetadata(const std::string& primaryDataset);
     virtual void inspectFile( TFile& file, const std::string& metadataTreeName="" );
     std::vector<std::string> filesToProcess() {return m_filesToProcess;}
     void setFilename(std::string fileName);
     std::string filename(){ return m_filename;}
     std::string primaryDataset(){ return m_primaryDataset;}
+    std::string metadataTreeName() {return m_metadataTreeName;}        // TTree with the primary dataset of each input
+    Sample sample( const std::string& primaryDataset );   // normalization for a primary dataset
+    std::string fileIndex() {return m_fileIndex;}
+    std::vector<std::string> systematics() {return m_systematics;}   // variations evaluated in the same pass
+    bool makeSkim() {return m_makeSkim;}                               // copy selected input events to a new file
+    std::vector<std::string> skimBranches() {return m_skimBranches;}   // branches to keep in the skim (empty = all)
+    std::string selectionCache() {return m_selectionCache;}            // directory of cached selection results ("" = off)
+    bool incremental() {return m_incremental;}                         // only process new or changed inputs
+    std::string telemetry() {return m_telemetry;}                      // JSON progress reports: file, "stderr", or "" (off)
+    double telemetryInterval() {return m_telemetryInterval;}           // seconds between reports
+    unsigned long long hash();                                         // hash of the options that change the output
+    bool removeDuplicates() {return m_removeDuplicates;}               // data: drop events already seen in another dataset
+    std::string duplicatePriority() {return m_duplicatePriority;}      // datasets in order of priority (comma-separated)
+    double duplicateMaxMemory() {return m_duplicateMaxMemory;}         // MB for the duplicate tables before using disk (0 = no limit)
+    std::string duplicateSpillDirectory() {return m_duplicateSpillDirectory;}
+    unsigned long long duplicateBloomEvents() {return m_duplicateBloomEvents;}   // size of the Bloom filter (0 = off)
+    std::string lumiMask() {return m_lumiMask;}                        // certified luminosity sections (JSON; "" = off)
 
     // return some values from config file
     std::string verboseLevel() {return m_verboseLevel;}
@@ -85,6 +120,9 @@ class configuration {
     std::string getAbsolutePath() {return m_cma_absPath;}
     int nEventsToProcess() {return m_nEventsToProcess;}
     unsigned long long firstEvent() {return m_firstEvent;}
+    bool globalEntries() {return m_globalEntries;}     // firstEvent/NEvents refer to the entries of all inputs (chained)
+    unsigned int nJobs() {return m_nJobs;}             // split the (chained) inputs into this many jobs
+    unsigned int jobIndex() {return m_jobIndex;}       // share of the inputs processed by this job
 
     // DNN
     std::string dnnFile() {return m_dnnFile;}
@@ -92,6 +130,8 @@ class configuration {
     bool DNNinference() {return m_DNNinference;}
     bool DNNtraining() {return m_DNNtraining;}
     std::string dnnKey() {return m_dnnKey;}   // key for lwtnn
+    std::string dnnBackend() {return m_dnnBackend;}   // 'lwtnn', or 'compiled'/'float'/'int8' (interface/compiledDNN.h)
+    bool dnnValidate() {return m_dnnValidate;}        // compare the compiled network to lwtnn
 
     // truth-reco matching
     std::map<std::string,int> mapOfPartonContainment() {return m_containmentMap;}
@@ -105,6 +145,7 @@ class configuration {
 
     // type of file(s)
     bool m_isMC;
+    bool m_isTtbar;
 
     // type of analysis
     bool m_isOneLeptonAnalysis;
@@ -128,6 +169,9 @@ class configuration {
     std::string m_verboseLevel;
     int m_nEventsToProcess;
     unsigned long long m_firstEvent;
+    bool m_globalEntries;
+    unsigned int m_nJobs;
+    unsigned int m_jobIndex;
     std::string m_outputFilePath;
     std::string m_customDirectory;
     bool m_makeTTree;
@@ -135,11 +179,33 @@ class configuration {
     bool m_makeEfficiencies;
     std::string m_cma_absPath;
     std::string m_metadataFile;
+    std::string m_metadataTreeName;
+    unsigned long long m_NTotalEvents;
+    std::string m_fileIndex;
+    std::map<std::string,Sample> m_mapOfSamples;   // loaded on first use
+    std::vector<std::string> m_systematics;
+    std::vector<std::string> m_supportedSystematics = {"nominal","jerUP","jerDOWN"};
+    bool m_makeSkim;
+    std::vector<std::string> m_skimBranches;
+    std::string m_selectionCache;
+    bool m_incremental;
+    std::string m_telemetry;
+    double m_telemetryInterval;
+    bool m_removeDuplicates;
+    std::string m_duplicatePriority;
+    double m_duplicateMaxMemory;
+    std::string m_duplicateSpillDirectory;
+    unsigned long long m_duplicateBloomEvents;
+    std::string m_lumiMask;
+    std::vector<std::string> m_hashIgnoredOptions = {"inputfile","verboseLevel","fileIndex","selectionCache","incremental","telemetry","telemetryInterval","dnnValidate",
+                                                       "duplicateMaxMemory","duplicateSpillDirectory","duplicateBloomEvents"};
     bool m_useDNN;
     bool m_DNNinference;
     bool m_DNNtraining;
     std::string m_dnnFile;
     std::string m_dnnKey;
+    std::string m_dnnBackend;
+    bool m_dnnValidate;
     bool m_doRecoEventLoop;
     bool m_matchTruthToReco;
     bool m_kinematicReco;
@@ -155,6 +221,9 @@ class configuration {
     float m_CSVv2L=0.5426;
     float m_CSVv2M=0.8484;
     float m_CSVv2T=0.9535;
+    float m_DeepCSVL=0.2219;
+    float m_DeepCSVM=0.6324;
+    float m_DeepCSVT=0.8958;
 
     std::vector<std::string> m_filters = {"goodVertices",
         "eeBadScFilter",
@@ -194,6 +263,9 @@ class configuration {
              {"jet_btag_wkpt",         "M"},
              {"NEvents",               "-1"},
              {"firstEvent",            "0"},
+             {"globalEntries",         "false"},
+             {"nJobs",                 "1"},
+             {"jobIndex",              "0"},
              {"selection",             "example"},
              {"output_path",           "./"},
              {"customDirectory",       ""},
@@ -202,9 +274,26 @@ class configuration {
              {"treenames",             "examples/config/treenames_nominal"},
              {"treename",              "tree/eventVars"},
              {"metadataFile",          "config/sampleMetaData.txt"},
+             {"metadataTreeName",      "tree/metadata"},
+             {"fileIndex",             ""},
+             {"systematics",           "nominal"},
+             {"makeSkim",              "false"},
+             {"skimBranches",          ""},
+             {"selectionCache",        ""},
+             {"incremental",           "false"},
+             {"telemetry",             ""},
+             {"telemetryInterval",     "10"},
+             {"removeDuplicates",      "false"},
+             {"duplicatePriority",     "SingleMuon,SingleElectron"},
+             {"duplicateMaxMemory",    "0"},
+             {"duplicateSpillDirectory", "."},
+             {"duplicateBloomEvents",  "0"},
+             {"lumiMask",              ""},
              {"verboseLevel",          "INFO"},
              {"dnnFile",               "config/keras_ttbar_DNN.json"},
              {"dnnKey",                "dnn"},
+             {"dnnBackend",            "lwtnn"},
+             {"dnnValidate",           "false"},
              {"DNNinference",          "false"},
              {"DNNtraining",           "false"},
              {"kinematicReco",         "false"} };
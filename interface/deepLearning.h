@@ -4,6 +4,9 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <memory>
+#include <cmath>
+#include <algorithm>
 
 #include "lwtnn/lwtnn/interface/LightweightNeuralNetwork.hh"
 #include "lwtnn/lwtnn/interface/parse_json.hh"
@@ -11,6 +14,8 @@
 #include "Analysis/CyMiniAna/interface/tools.h"
 #include "Analysis/CyMiniAna/interface/configuration.h"
 #include "Analysis/CyMiniAna/interface/physicsObjects.h"
+#include "Analysis/cheetah/interface/ljetObservables.h"
+#include "Analysis/cheetah/interface/compiledDNN.h"
 
 
 class deepLearning {
@@ -35,9 +40,34 @@ class deepLearning {
 
   protected:
 
+    void initializeCompiled();
+    void inferenceCompiled();
+    void validate(const std::map<std::string,double>& lwtnnPredictions);
+
     configuration *m_config;
 
-    lwt::LightweightNeuralNetwork* m_lwnn;       // LWTNN tool
+    enum dnnBackend {lwtnnBackend=0, compiledBackend=1, floatBackend=2, int8Backend=3};
+    dnnBackend m_backend;                        // network used for inference ('dnnBackend')
+
+    std::unique_ptr<lwt::LightweightNeuralNetwork> m_lwnn;   // LWTNN tool
+
+    // compiled network (interface/compiledDNN.h): inputs/outputs bound to the maps once
+    std::vector<double*> m_compiledInputs;       // entries of m_features in the order of the network inputs
+    std::vector<double*> m_compiledOutputs;      // entries of m_predictions in the order of the network outputs
+    bool m_validate;                             // also run lwtnn and check the deviation ('dnnValidate')
+    double m_tolerance;                          // max. deviation from lwtnn for the backend: |compiled-lwtnn|/max(|lwtnn|,1)
+    unsigned long long m_nValidated;
+    unsigned long long m_nFailed;                // jets with an output outside of the tolerance
+    double m_maxDeviation;
+
+    // features set for every jet: entries of m_features bound once (building the keys would allocate)
+    enum feature {f_target=0,
+                  f_subjet0_bdisc, f_subjet0_charge, f_subjet0_mass, f_subjet0_mrel, f_subjet0_ptrel,
+                  f_subjet0_tau1, f_subjet0_tau2, f_subjet0_tau3, f_subjet0_tau21, f_subjet0_tau32,
+                  f_subjet1_bdisc, f_subjet1_charge, f_subjet1_mass, f_subjet1_mrel, f_subjet1_ptrel,
+                  f_subjet1_tau1, f_subjet1_tau2, f_subjet1_tau3, f_subjet1_tau21, f_subjet1_tau32,
+                  f_charge, f_weight, nFeatures};
+    double* m_featureValues[nFeatures];
 
     std::map<std::string, double> m_features;    // values for inputs to the DNN
     std::map<std::string,double> m_predictions;  // map of DNN predictions
@@ -0,0 +1,101 @@
+#ifndef DUPLICATEFILTER_H
+#define DUPLICATEFILTER_H
+
+#include "TROOT.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdio>
+#include <algorithm>
+
+#include "Analysis/cheetah/interface/tools.h"
+#include "Analysis/cheetah/interface/configuration.h"
+
+
+// Identity of a collision event (exact: different events never share a key)
+struct eventKey {
+    unsigned long long runLumi;      // run<<32 | lumiblock
+    unsigned long long event;
+
+    bool operator==(const eventKey& rhs) const {return runLumi==rhs.runLumi && event==rhs.event;}
+    bool operator<(const eventKey& rhs) const {return (runLumi==rhs.runLumi) ? event<rhs.event : runLumi<rhs.runLumi;}
+};
+
+
+// Events that appear in more than one primary dataset (e.g., SingleElectron & SingleMuon)
+// -- the first time an event is seen it is kept; later copies are duplicates
+// -- input files are ordered by dataset priority, so the event is kept in the preferred dataset
+class duplicateFilter {
+  public:
+    // Default
+    duplicateFilter( configuration& cmaConfig );
+
+    // Default - so we can clean up (removes the spill files);
+    virtual ~duplicateFilter();
+
+    // Run once at the start of the job
+    void initialize();
+    bool enabled() const {return m_enabled;}
+
+    // Sort the input files by the priority of their dataset (stable; unlisted datasets last)
+    void order( std::vector<std::string>& filenames ) const;
+    unsigned int datasetIndex( const std::string& primaryDataset, const std::string& filename ) const;
+
+    // Datasets of the priority list without any file in the inputs (duplicates with them are not found)
+    std::vector<std::string> missingDatasets( const std::vector<std::string>& filenames ) const;
+
+    // Thread-safe: true if the event was seen before; otherwise it is recorded
+    bool isDuplicate( const unsigned int run, const unsigned int lumiblock, const unsigned long long eventNumber, const unsigned int dataset );
+
+    // Events & duplicates per dataset
+    void summary() const;
+
+  protected:
+
+    // Part of the set (selected by the hash of the key) with its own lock
+    struct shard {
+        std::mutex mutex;
+        std::vector<eventKey> slots;          // open addressing; empty slots hold m_emptyKey
+        std::size_t size;
+        FILE* spillFile;                      // sorted keys moved to disk (nullptr = none)
+        std::string spillName;
+        long spillSize;
+    };
+
+    bool inMemory( const shard& s, const eventKey& key, const unsigned long long hash ) const;
+    void insert( shard& s, const eventKey& key, const unsigned long long hash );
+    void rehash( shard& s, const std::size_t capacity );
+    void spill( shard& s, const unsigned int index );
+    bool inSpills( const shard& s, const eventKey& key ) const;
+
+    bool bloomContains( const unsigned long long hash ) const;
+    void bloomAdd( const unsigned long long hash );
+
+    static unsigned long long mix( const eventKey& key );
+
+    configuration *m_config;
+    bool m_enabled;
+    std::vector<std::string> m_priority;         // datasets in order of priority
+
+    static const unsigned int m_shardBits = 6;   // 64 shards
+    std::vector<std::unique_ptr<shard> > m_shards;
+    std::size_t m_initialCapacity;
+    std::size_t m_maxCapacity;                   // slots per shard before spilling to disk (0 = no limit)
+    std::string m_spillDirectory;
+    const eventKey m_emptyKey = {~0ULL,~0ULL};
+
+    // optional prefilter: keys that are definitely new skip the lookup in the spill files
+    std::unique_ptr<std::atomic<unsigned long long>[]> m_bloom;
+    unsigned long long m_bloomBits;
+    unsigned int m_bloomHashes;
+
+    // counters per dataset (last entry: datasets not in the priority list)
+    std::unique_ptr<std::atomic<unsigned long long>[]> m_nEvents;
+    std::unique_ptr<std::atomic<unsigned long long>[]> m_nDuplicates;
+    std::atomic<unsigned long long> m_nSpills;
+};
+
+#endif
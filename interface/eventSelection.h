@@ -40,18 +40,20 @@ class eventSelection{
     virtual void identifySelection();
 
     // Run for every tree (before the event loop)
-    void setCutflowHistograms(TFile& outputFile);
+    void setCutflowHistograms(TDirectory& outputDir);
 
     // Run for every event (in every systematic) that needs saving
     virtual void setObjects(const Event& event);
     virtual bool applySelection();
 
-    // -- Selections put into functions (easily reference them in other cuts)
+    // -- Selections put into functions (stages of the chain; each fills its own cutflow bins)
+    bool filterSelection(float& cutflow_bin);
     bool mcDNNSelection(float& cutflow_bin);
     bool cwolaSelection( float& cutflow_bin);
-    bool oneLeptonSelection(float& cutflow_bin, std::string selection="");
-    bool ejetsSelection( float& cutflow_bin, std::string selection="ejets");
-    bool mujetsSelection(float& cutflow_bin, std::string selection="mujets");
+    bool oneLeptonSelection(float& cutflow_bin);
+    bool ejetsSelection( float& cutflow_bin);
+    bool mujetsSelection(float& cutflow_bin);
+    bool rejectSelection(float& cutflow_bin);
 
     // Helper functions: Provide external access to information in this class
     void fillCutflows(float& cutflow_bin);                                // fill cutflow histograms
@@ -59,6 +61,28 @@ class eventSelection{
     virtual std::vector<std::string> cutNames(){ return m_cutflowNames;}  // Return a vector of the cut names 
     virtual unsigned int numberOfCuts(){ return m_numberOfCuts;}          // Return the number of cuts
 
+    // Cutflows of the current file (e.g., restored from a cache instead of re-running the selection)
+    const TH1D* cutflow() const {return m_cutflow;}
+    const TH1D* cutflow_unweighted() const {return m_cutflow_unw;}
+    bool restoreCutflows(const TH1& cutflow, const TH1& cutflow_unweighted);
+
+    // Version of the event selection code (cached results and manifests are invalid after a change)
+    // -- increase m_codeVersion whenever a change to the selection or to the objects it uses
+    //    changes which events pass
+    static std::string codeVersion();
+    static const unsigned int m_codeVersion = 1;
+
+    // One step of a selection: applied in order until one fails
+    typedef bool (eventSelection::*stageFunction)(float& cutflow_bin);
+    struct selectionStage {
+        std::string name;
+        stageFunction apply;
+        unsigned int firstBin;       // first cutflow bin (after "INITIAL")
+        unsigned int nBins;          // number of cuts in this stage
+    };
+    void addStage(const std::string& name, stageFunction apply, const unsigned int nBins);
+    const std::vector<selectionStage>& stages() const {return m_stages;}
+
   protected:
 
     configuration* m_config;
@@ -76,20 +100,22 @@ class eventSelection{
     TH1D* m_cutflow;
     TH1D* m_cutflow_unw;
 
-    // booleans for each selection
+    // selection resolved into stages (identifySelection())
     bool m_dummySelection;
-    bool m_isCWoLaAnalysis;
-    bool m_mcDNNSelection;
+    std::vector<selectionStage> m_stages;
+    enum leptonChannel {ejets=0, mujets=1, ljets=2};
+    leptonChannel m_leptonChannel;      // used by oneLeptonSelection()
 
     // physics information
     bool m_valid;
     float m_nominal_weight;
-    std::vector<Ljet> m_ljets;
-    std::vector<Jet> m_jets;
-    std::vector<Muon> m_muons;
-    std::vector<Electron> m_electrons;
-    std::vector<Lepton> m_leptons;
-    std::vector<Neutrino> m_neutrinos;
+    // collections are owned by the Event (valid until the next event)
+    const std::vector<Ljet>* m_ljets;
+    const std::vector<Jet>* m_jets;
+    const std::vector<Muon>* m_muons;
+    const std::vector<Electron>* m_electrons;
+    const std::vector<Lepton>* m_leptons;
+    const std::vector<Neutrino>* m_neutrinos;
     MET m_met;
     float m_ht;
     float m_st;
@@ -97,8 +123,8 @@ class eventSelection{
     std::vector<std::string> m_ejetsTriggers;
     std::vector<std::string> m_mujetsTriggers;
 
-    std::map<std::string,unsigned int> m_triggers;
-    std::map<std::string,unsigned int> m_filters;
+    const std::map<std::string,unsigned int>* m_triggers;
+    const std::map<std::string,unsigned int>* m_filters;
 
     unsigned int m_Nbtags;
     unsigned int m_NLeptons;
@@ -107,7 +133,7 @@ class eventSelection{
     unsigned int m_NJets;
     unsigned int m_NLjets;
 
-    Ttbar1L m_ttbar1L;
+    const Ttbar1L* m_ttbar1L;
 };
 
 #endif
@@ -0,0 +1,66 @@
+#ifndef FILEINDEX_H
+#define FILEINDEX_H
+
+#include "TROOT.h"
+#include "TSystem.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+
+#include "Analysis/cheetah/interface/tools.h"
+#include "Analysis/cheetah/interface/configuration.h"
+
+
+// Information about one input file -- valid while the file size and modification time are unchanged
+// (the sample normalization is not stored: it comes from the metadata file, which can change independently)
+struct fileIndexEntry {
+    std::string filename;
+    long long size;
+    long modtime;
+
+    std::string treename;              // TTree that 'entries' refers to
+    long long entries;                 // number of entries in the nominal TTree
+    std::vector<std::string> keys;     // TTrees (and histograms) in the file
+    std::string primaryDataset;
+};
+
+
+class fileIndex {
+  public:
+    // Default
+    fileIndex( configuration& cmaConfig );
+
+    // Default - so we can clean up;
+    virtual ~fileIndex();
+
+    // Run once at the start of the job (read the existing index, if it exists)
+    void initialize( const std::string& indexFile );
+
+    // Thread-safe access (files are inspected on a helper thread)
+    bool lookup( const std::string& filename, fileIndexEntry& entry );
+    void update( const fileIndexEntry& entry );
+
+    // Save the index to disk (merged with the entries other jobs wrote in the meantime)
+    void write();
+
+    // Size and modification time of a file (local or remote)
+    static bool fingerprint( const std::string& filename, long long& size, long& modtime );
+
+    bool enabled() const {return m_indexFile.size()>0;}
+
+  protected:
+
+    // Add the entries of the index file
+    bool read( std::map<std::string,fileIndexEntry>& entries );
+
+    configuration *m_config;
+
+    std::string m_indexFile;
+    std::map<std::string,fileIndexEntry> m_entries;   // key = filename
+    std::map<std::string,fileIndexEntry> m_current;   // files inspected in this job
+    std::mutex m_mutex;
+};
+
+#endif
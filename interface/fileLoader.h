@@ -0,0 +1,61 @@
+#ifndef FILELOADER_H
+#define FILELOADER_H
+
+#include "TROOT.h"
+#include "TFile.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <future>
+
+#include "Analysis/cheetah/interface/tools.h"
+#include "Analysis/cheetah/interface/configuration.h"
+#include "Analysis/cheetah/interface/fileIndex.h"
+
+
+// Input file that has been opened and inspected (ready for the event loop)
+struct inputFile {
+    std::string filename;
+    std::unique_ptr<TFile> file;
+    std::vector<std::string> keys;     // list of keys (TTrees/histograms) in the file
+    std::string primaryDataset;        // read from the metadata tree (if requested)
+    bool isValid;                      // file exists and is not a zombie
+    bool isIndexed;                    // information taken from the file index (no scan needed)
+    fileIndexEntry metadata;           // entry in the file index (if isIndexed)
+};
+
+
+class fileLoader {
+  public:
+    // Default
+    fileLoader();
+
+    // Default - so we can clean up;
+    virtual ~fileLoader();
+
+    // Run once at the start of the job (starts preparing the first file)
+    void initialize( const std::vector<std::string>& filenames, const std::string& metadataTreeName="" );
+    void setFileIndex( fileIndex& index ) {m_index = &index;}
+
+    // Return the next prepared file and start preparing the one after it
+    bool next( inputFile& input );
+
+    unsigned int numberOfFiles() const {return m_filenames.size();}
+
+  protected:
+
+    // Open and inspect a single file -- run on a helper thread
+    static inputFile prepare( const std::string filename, const std::string metadataTreeName, fileIndex* index );
+    void prepareNext();
+
+    fileIndex *m_index;                   // optional: skip inspecting files that are already indexed
+
+    std::vector<std::string> m_filenames;
+    std::string m_metadataTreeName;
+    unsigned int m_nextFile;              // index of the next file to prepare
+
+    std::future<inputFile> m_prepared;    // file being prepared while the current one is processed
+};
+
+#endif
@@ -29,11 +29,11 @@ class histogrammer : public histogrammerBase {
     // Default - so we can clean up;
     virtual ~histogrammer();
 
-    /* fill histograms */
-    void fill( const std::map<std::string,double> top, double weight=1.0 );
+    /* fill histograms (slot>=0 when filling from several threads) */
+    void fill( const std::map<std::string,double>& features, double weight=1.0, const int slot=-1 );
 
     /* Book histograms */
-    void initialize( TFile& outputFile );
+    void initialize( TDirectory& outputDir );
     void bookHists();
 
   protected:
@@ -43,6 +43,14 @@ class histogrammer : public histogrammerBase {
 
     // Target values for system
     std::vector<std::string> m_targets = {"0","1"};
+
+    // Features that are histogrammed & the index of their histogram for each target (set in bookHists)
+    std::vector<std::string> m_features = {"ljet_BEST_t","ljet_BEST_w","ljet_BEST_z","ljet_BEST_h","ljet_BEST_j",
+                                           "ljet_SDmass","ljet_tau1","ljet_tau2","ljet_tau3","ljet_tau21","ljet_tau32",
+                                           "ljet_charge",
+                                           "ljet_subjet0_bdisc","ljet_subjet0_mass","ljet_subjet0_ptrel","ljet_subjet0_charge",
+                                           "ljet_subjet1_bdisc","ljet_subjet1_mass","ljet_subjet1_ptrel","ljet_subjet1_charge"};
+    std::vector<std::vector<int> > m_histIndex;
 };
 
 #endif
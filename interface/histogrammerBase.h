@@ -14,6 +14,7 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <algorithm>
 
 #include "Analysis/cheetah/interface/configuration.h"
 #include "Analysis/cheetah/interface/tools.h"
@@ -52,6 +53,19 @@ class histogrammerBase {
     virtual void fill( const std::string& name, const double& xvalue, const double& yvalue, const double& weight );
     virtual void fill( const std::string& name, const double& xvalue, const double& yvalue, const double& zvalue, const double& weight );
 
+    /* fill histograms from several threads -- one slot per thread (slot<0 fills the histogram directly) */
+    void setNumberOfSlots( const unsigned int nSlots );
+    int histogramIndex( const std::string& name ) const;     // look up once, after init_hist (-1 if it doesn't exist)
+    virtual void fill( const int slot, const unsigned int index, const double& value, const double& weight );
+    virtual void fill( const int slot, const unsigned int index, const double& xvalue, const double& yvalue, const double& weight );
+    virtual void fill( const int slot, const unsigned int index, const double& xvalue, const double& yvalue, const double& zvalue, const double& weight );
+    virtual void fill( const int slot, const std::string& name, const double& value, const double& weight );
+    virtual void fill( const int slot, const std::string& name, const double& xvalue, const double& yvalue, const double& weight );
+    virtual void fill( const int slot, const std::string& name, const double& xvalue, const double& yvalue, const double& zvalue, const double& weight );
+
+    /* Add the content of all slots to the histograms.  Called by overUnderFlow() */
+    void reduce();
+
     /* Put over/underflow in last/first bins.  Called from outside macro */
     void overUnderFlow();
     virtual void overFlow();
@@ -66,6 +80,26 @@ class histogrammerBase {
     std::map<std::string, TH2D*> m_map_histograms2D;
     std::map<std::string, TH3D*> m_map_histograms3D;
 
+    // Per-thread storage: each slot owns one buffer with the bin contents of every histogram
+    //   (sumw, sumw2, entries, statistics); buffers are padded so no two slots share a cache line
+    struct slotHistogram {
+        TH1* hist;
+        unsigned int offset;       // position in the slot buffer
+        unsigned int nCells;       // number of bins, including under/overflow
+    };
+    void bookSlots( TH1* hist );
+    double* slotCells( const int slot, const unsigned int index );
+    void addEntry( double* cells, const slotHistogram& histogram, const int bin, const double& weight, const bool inRange ) const;
+
+    // sums used by TH1::GetStats (same order): w, w2, wx, wx2, wy, wy2, wxy, wz, wz2, wxz, wyz
+    static const unsigned int m_nStats = 11;
+
+    std::map<std::string, unsigned int> m_slotIndex;        // key = histogram name, value = index in m_slotHistograms
+    std::vector<slotHistogram> m_slotHistograms;
+    std::vector<std::vector<double> > m_slots;
+    unsigned int m_slotSize;                                // doubles used by all histograms in one slot
+    const unsigned int m_cacheLine = 8;                     // doubles per cache line (64 bytes)
+
     std::vector<std::string> m_names;
     bool m_putOverflowInLastBin;
     bool m_putUnderflowInFirstBin;
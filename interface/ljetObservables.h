@@ -0,0 +1,44 @@
+#ifndef LJETOBSERVABLES_H
+#define LJETOBSERVABLES_H
+
+#include <string>
+
+#include "Analysis/cheetah/interface/physicsObjects.h"
+
+
+// Observables derived from the large-R jet attributes
+// -- each one is defined once (src/ljetObservables.cxx)
+// -- evaluated the first time it is requested for a jet, then cached in the jet
+namespace ljetObservables {
+
+    enum observable {
+        pt=0, mass,
+        tau21, tau32,
+        subjet0_mrel, subjet0_ptrel, subjet0_tau21, subjet0_tau32,
+        subjet1_mrel, subjet1_ptrel, subjet1_tau21, subjet1_tau32,
+        nObservables
+    };
+    static_assert( nObservables <= sizeof(Ljet::derived)/sizeof(float), "Too many observables for the cache in Ljet" );
+
+    struct definition {
+        const char* name;                  // same name as the feature/branch, e.g., "ljet_tau21"
+        float (*compute)(const Ljet&);
+    };
+
+    extern const definition definitions[nObservables];
+
+    /* Value of an observable (computed once per jet) */
+    inline float get( const Ljet& ljet, const observable obs ){
+        unsigned int bit = 1u << obs;
+        if (!(ljet.derivedMask & bit)){
+            ljet.derived[obs] = definitions[obs].compute(ljet);
+            ljet.derivedMask |= bit;
+        }
+        return ljet.derived[obs];
+    }
+
+    /* Observable from its name (-1 if it does not exist) -- call outside of the event loop */
+    int find( const std::string& name );
+}
+
+#endif
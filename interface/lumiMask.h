@@ -0,0 +1,59 @@
+#ifndef LUMIMASK_H
+#define LUMIMASK_H
+
+#include "TROOT.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <mutex>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+#include "Analysis/cheetah/interface/tools.h"
+#include "Analysis/cheetah/interface/configuration.h"
+
+
+// Certified luminosity sections (good run/lumi JSON) for data
+// -- per run: sorted, non-overlapping ranges of luminosity sections [first,last]
+class lumiMask {
+  public:
+    // Default
+    lumiMask( configuration& cmaConfig );
+
+    // Default - so we can clean up;
+    virtual ~lumiMask();
+
+    // Run once at the start of the job (empty filename: no mask)
+    void initialize( const std::string& jsonFile );
+    bool enabled() const {return m_jsonFile.size()>0;}
+
+    // Thread-safe lookup: binary search of the run, then of its ranges
+    bool certified( const unsigned int run, const unsigned int lumiblock ) const;
+
+    // Thread-safe: record a luminosity section that was processed (once per section is enough)
+    void addProcessed( const unsigned int run, const unsigned int lumiblock, const bool certified );
+
+    // Processed & certified luminosity sections (same JSON format; input for the luminosity calculation)
+    void report( const std::string& filename ) const;
+    void summary() const;
+
+  protected:
+
+    configuration *m_config;
+    std::string m_jsonFile;
+
+    std::vector<unsigned int> m_runs;          // sorted
+    std::vector<unsigned int> m_offsets;       // first range of each run in m_ranges (+ total at the end)
+    std::vector<std::pair<unsigned int,unsigned int> > m_ranges;   // [first,last] luminosity sections
+
+    mutable std::mutex m_mutex;
+    std::set<std::pair<unsigned int,unsigned int> > m_processed;   // (run,lumiblock) certified & processed
+    std::set<std::pair<unsigned int,unsigned int> > m_rejected;    // processed sections outside the mask
+};
+
+#endif
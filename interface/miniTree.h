@@ -4,6 +4,8 @@
 #include "TROOT.h"
 #include "TFile.h"
 #include "TTree.h"
+#include "TBranch.h"
+#include "TLeaf.h"
 #include "TH1.h"
 #include "TSystem.h"
 #include "TMath.h"
@@ -32,10 +34,10 @@ class miniTree {
     virtual ~miniTree();
 
     // Run once at the start of the job;
-    virtual void initialize(TFile& outputFile);
+    virtual void initialize(TDirectory& outputDir);
 
     // Run for every event (in every systematic) that needs saving;
-    virtual void saveEvent(const std::map<std::string,double> features);
+    virtual void saveEvent(const std::map<std::string,double>& features);
 
     // Clear stuff;
     virtual void finalize();
@@ -47,6 +49,8 @@ class miniTree {
     TTree * m_metadataTree;
     configuration * m_config;
 
+    std::vector<std::pair<std::string,float*> > m_floatFeatures;   // float branches: name & address
+
     /**** Training branches ****/
     // weights for inputs
     float m_xsection;
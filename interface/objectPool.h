@@ -0,0 +1,46 @@
+#ifndef OBJECTPOOL_H
+#define OBJECTPOOL_H
+
+#include <vector>
+#include <utility>
+
+
+// Reuse physics objects from one event to the next
+// -- objects are moved (not destroyed) when a collection is released,
+//    so their nested containers (maps, vectors) keep their storage.
+// -- an acquired object is set back to default values with T::reset()
+//    (nothing is left from a previous event).
+template<typename T>
+class objectPool {
+  public:
+    objectPool() {m_spare.clear();}
+    virtual ~objectPool() {}
+
+    // Move every object of a collection into the pool (collection keeps its capacity)
+    void release( std::vector<T>& objects ){
+        for (auto& obj : objects)
+            m_spare.push_back( std::move(obj) );
+        objects.clear();
+        return;
+    }
+
+    // Add an object to a collection -- reused from the pool if one is available
+    T& acquire( std::vector<T>& objects ){
+        if (m_spare.empty())
+            objects.emplace_back();
+        else{
+            objects.push_back( std::move(m_spare.back()) );
+            m_spare.pop_back();
+            objects.back().reset();
+        }
+        return objects.back();
+    }
+
+    unsigned int size() const {return m_spare.size();}
+
+  protected:
+
+    std::vector<T> m_spare;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef OUTPUTMANIFEST_H
+#define OUTPUTMANIFEST_H
+
+#include "TROOT.h"
+#include "TSystem.h"
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include "Analysis/cheetah/interface/tools.h"
+#include "Analysis/cheetah/interface/configuration.h"
+
+
+// One output file and the state of the input & configuration it was made from
+struct manifestEntry {
+    std::string output;
+    std::string input;
+    long long size;          // input file size
+    long modtime;            // input file modification time
+    long long entries;       // entries in the input TTree
+    long long begin;         // entries [begin,end) of the input that are in the output
+    long long end;
+    std::string configHash;  // configuration & code used to make the output
+};
+
+
+class outputManifest {
+  public:
+    // Default
+    outputManifest( configuration& cmaConfig );
+
+    // Default - so we can clean up;
+    virtual ~outputManifest();
+
+    // Run once at the start of the job (read the manifest of the previous run, if it exists)
+    void initialize( const std::string& manifestFile, const std::string& configHash );
+
+    // True if 'output' was made from the same entries of this input (unchanged) with the same configuration
+    bool upToDate( const std::string& input, const std::string& output, const long long entries,
+                   const long long begin, const long long end );
+
+    // Record an output made in this job
+    void update( const std::string& input, const std::string& output, const long long entries,
+                 const long long begin, const long long end );
+
+    // Save the manifest: outputs of this job merged with the entries already in the file (first column = output file)
+    void write();
+
+  protected:
+
+    bool read( std::map<std::string,manifestEntry>& entries );
+
+    configuration *m_config;
+
+    std::string m_manifestFile;
+    std::string m_configHash;
+    std::map<std::string,manifestEntry> m_previous;   // key = output file (jobs sharing an input have separate outputs)
+    std::map<std::string,manifestEntry> m_current;
+};
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef OUTPUTMERGER_H
+#define OUTPUTMERGER_H
+
+#include "TROOT.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TH1.h"
+#include "TKey.h"
+#include "TClass.h"
+#include "TDirectory.h"
+#include "TSystem.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+
+#include "Analysis/cheetah/interface/tools.h"
+
+
+// Metadata of one sample (one entry of the 'metadata' tree after merging)
+struct sampleMetadata {
+    int target;
+    int nEvents;
+};
+
+// Input file opened by a histogram thread, waiting for its trees to be copied
+struct openedFile {
+    std::unique_ptr<TFile> file;       // nullptr if it could not be opened
+    std::vector<std::string> trees;    // paths of the trees in the file
+    bool ready;
+};
+
+
+class outputMerger {
+  public:
+    // Default
+    outputMerger();
+
+    // Default - so we can clean up;
+    virtual ~outputMerger();
+
+    // Run once at the start of the job
+    void initialize( const std::vector<std::string>& filenames, const unsigned int nThreads=0 );
+
+    // Merge the inputs into a single output file (false if the inputs are not consistent)
+    bool execute( const std::string& outputFilename );
+
+    typedef std::map<std::string, std::unique_ptr<TH1> > histogramMap;   // key = path in the file
+
+  protected:
+
+    // Histograms: each thread sums its share of the files, then partial sums are combined in pairs
+    void reduceHistograms( const unsigned int thread, histogramMap& histograms, std::vector<std::string>& errors );
+    void combine( histogramMap& target, histogramMap& source, std::vector<std::string>& errors );
+    void addHistogram( histogramMap& histograms, const std::string& path, const TH1& hist,
+                       const std::string& filename, std::vector<std::string>& errors );
+    bool checkCutflow( const TH1& hist, const std::string& path, const std::string& filename, std::vector<std::string>& errors );
+
+    // Trees: baskets are copied without decompression; metadata trees are rebuilt
+    void mergeTrees( TFile& outputFile );
+    void readMetadata( TTree& tree, const std::string& path );
+    void writeMetadata( TFile& outputFile );
+
+    // Each file is opened once: the histogram thread hands it over to the tree copy (in order)
+    void waitForTurn( const unsigned int f );
+    void handOver( const unsigned int f, std::unique_ptr<TFile> file, const std::vector<std::string>& trees );
+    openedFile takeOver( const unsigned int f );
+
+    void getListOfObjects( TDirectory* dir, const std::string& path,
+                           std::vector<std::string>& histograms, std::vector<std::string>& trees );
+    std::string directoryName( const std::string& path );
+    std::string objectName( const std::string& path );
+    bool isCutflow( const std::string& path );
+
+    std::vector<std::string> m_filenames;
+    unsigned int m_nThreads;
+
+    std::map<std::string, TTree*> m_trees;                                      // key = path in the file
+    std::map<std::string, std::map<std::string,sampleMetadata> > m_metadata;    // path -> sample name -> metadata
+    std::vector<std::string> m_treeErrors;
+    std::vector<std::string> m_warnings;                                        // objects that were skipped
+
+    std::vector<openedFile> m_openedFiles;
+    unsigned int m_nextTreeFile;          // next file for the tree copy
+    unsigned int m_maxOpenFiles;          // files the histogram threads can read ahead of the tree copy
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+};
+
+#endif
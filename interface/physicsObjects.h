@@ -10,6 +10,7 @@
 #include "TLorentzVector.h"
 #include <map>
 #include <string>
+#include <vector>
 
 // base object (consistent reference to TLorentzVector)
 struct CmaBase {
@@ -59,16 +60,38 @@ struct TruthTop {
 
     bool isHadronic;  // W decays to quarks
     bool isLeptonic;  // W decays to leptons
+
+    // back to default values -- the vectors are emptied but keep their storage (objectPool)
+    void reset(){
+        std::vector<int> wdecays, others;
+        wdecays.swap(Wdecays);
+        others.swap(daughters);
+        *this = TruthTop();
+        Wdecays.swap(wdecays);
+        daughters.swap(others);
+        Wdecays.clear();
+        daughters.clear();
+    }
 };
 
 
 
+// b-tagging flags: one bit per tagger & working point (Jet::btagBits)
+namespace btag {
+    enum tagger {CSVv2=0, DeepCSV=1, nTaggers=2};      // (cMVAv2 is not stored in the ntuples)
+    enum wkpt {L=0, M=1, T=2, nWkpts=3};
+    inline unsigned int index(const tagger t, const wkpt w) {return t*nWkpts + w;}
+    inline unsigned int bit(const tagger t, const wkpt w) {return 1u << index(t,w);}
+}
+
+
 // Struct for jets
 // -- common to all types of jets
 struct Jet : CmaBase{
     float bdisc;
     float deepCSV;
-    std::map<std::string, bool> isbtagged;
+    unsigned int btagBits;      // b-tagging flags -- see btag::bit()
+    bool isbtagged(const btag::tagger t, const btag::wkpt w) const {return (btagBits & btag::bit(t,w))!=0;}
     float charge;
 
     int index;       // index in vector of jets
@@ -86,6 +109,15 @@ struct Jet : CmaBase{
     int containment; // level of containment for partons matched to jet
     int matchId;     // keep track if jet is matched to top or anti-top
     std::vector<int> truth_partons;  // vector containing partons that are truth-matched to jet
+
+    // back to default values -- the vector is emptied but keeps its storage (objectPool)
+    void reset(){
+        std::vector<int> partons;
+        partons.swap(truth_partons);
+        *this = Jet();
+        truth_partons.swap(partons);
+        truth_partons.clear();
+    }
 };
 
 struct Ljet : Jet{
@@ -93,8 +125,6 @@ struct Ljet : Jet{
     float tau1;
     float tau2;
     float tau3;
-    float tau21;
-    float tau32;
     float softDropMass;
 
     float BEST_t;
@@ -124,6 +154,32 @@ struct Ljet : Jet{
     int target;
     std::map<std::string, double> features;  // store features in map to easily access later
     std::map<std::string, double> dnn;       // store full dnn results
+
+    // derived observables (tau21, mrel, ...) computed on first use -- see ljetObservables.h
+    // -- 'derivedMask' is cleared by reset(); clear it whenever the jet is filled again
+    mutable unsigned int derivedMask = 0;
+    mutable float derived[32];
+
+    // back to default values -- vectors are emptied and the values in the maps are set to 0:
+    // the containers keep their storage (the same keys are set for every jet)
+    void reset(){
+        std::vector<int> partons;
+        std::vector<Jet> subjetStorage;
+        std::map<std::string, double> featureMap, dnnMap;
+        partons.swap(truth_partons);
+        subjetStorage.swap(subjets);
+        featureMap.swap(features);
+        dnnMap.swap(dnn);
+        *this = Ljet();
+        truth_partons.swap(partons);
+        subjets.swap(subjetStorage);
+        features.swap(featureMap);
+        dnn.swap(dnnMap);
+        truth_partons.clear();
+        subjets.clear();
+        for (auto& x : features) x.second = 0.;
+        for (auto& x : dnn) x.second = 0.;
+    }
 };
 
 
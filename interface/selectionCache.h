@@ -0,0 +1,72 @@
+#ifndef SELECTIONCACHE_H
+#define SELECTIONCACHE_H
+
+#include "TROOT.h"
+#include "TFile.h"
+#include "TDirectory.h"
+#include "TH1.h"
+#include "TNamed.h"
+#include "TEntryList.h"
+#include "TSystem.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "Analysis/cheetah/interface/tools.h"
+#include "Analysis/cheetah/interface/configuration.h"
+
+
+// Entries of an input file that pass each selection channel
+// -- re-used by later runs with the same selections, cuts, and selection code
+//    so only the passing entries are read again (cutflows are restored from the cache)
+class selectionCache {
+  public:
+    // Default
+    selectionCache( configuration& cmaConfig );
+
+    // Default - so we can clean up;
+    virtual ~selectionCache();
+
+    // Run once at the start of the job for every channel (in the order they are evaluated)
+    void addChannel( const std::string& variation, const std::string& selection,
+                     const std::string& cutsfile );
+    void initialize( const std::string& cacheDirectory );
+
+    // Run for every input file: true if a valid cache exists (entries & cutflows are loaded)
+    bool load( const std::string& filename, const Long64_t nEntries );
+
+    // Cache hit: entries that pass at least one channel (sorted)
+    const std::vector<Long64_t>& entries() const {return m_entries;}
+    bool passed( const unsigned int channel, const Long64_t entry ) const {return m_pass.at(channel).at(entry);}
+    const TH1* cutflow( const unsigned int channel ) const {return m_cutflows.at(channel).get();}
+    const TH1* cutflow_unweighted( const unsigned int channel ) const {return m_cutflows_unw.at(channel).get();}
+
+    // Cache miss: record the passing entries, then save with the final cutflows
+    void record( const unsigned int channel, const Long64_t entry );
+    void save( const std::vector<const TH1*>& cutflows, const std::vector<const TH1*>& cutflows_unweighted );
+
+    bool enabled() const {return m_cacheDirectory.size()>0;}
+    std::string key() const {return cma::hashToStr(m_hash);}
+
+  protected:
+
+    std::string cacheFilename( const std::string& filename ) const;
+
+    configuration *m_config;
+
+    std::string m_cacheDirectory;
+    std::string m_channelKeys;        // everything that decides which events pass
+    unsigned int m_nChannels;
+    unsigned long long m_hash;
+
+    // current input file
+    std::string m_filename;
+    Long64_t m_nEntries;
+    std::vector<std::vector<bool> > m_pass;   // [channel][entry]
+    std::vector<Long64_t> m_entries;
+    std::vector<std::unique_ptr<TH1> > m_cutflows;
+    std::vector<std::unique_ptr<TH1> > m_cutflows_unw;
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef SKIMMER_H
+#define SKIMMER_H
+
+#include "TROOT.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TEntryList.h"
+#include "TDirectory.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "Analysis/cheetah/interface/tools.h"
+#include "Analysis/cheetah/interface/configuration.h"
+
+
+// Copy the selected entries of the input TTree to a new file
+// -- the skim can be used as input for later studies (same tree name & branches)
+class skimmer {
+  public:
+    skimmer( configuration& cmaConfig );
+
+    virtual ~skimmer();
+
+    // Run for every input file (before the event loop)
+    void initialize( TFile& inputFile, const std::string& treename, const std::string& outputFilename );
+
+    // Run for every event that passed a selection (entry in the input TTree)
+    void fill( const Long64_t entry );
+
+    // Write the skim (after the event loop)
+    void finalize();
+
+  protected:
+
+    configuration* m_config;
+
+    TTree* m_tree;                           // input TTree (owned by the input file)
+    std::string m_treename;
+    std::string m_outputFilename;
+    std::vector<std::string> m_branches;     // branches to keep (empty = all)
+    std::unique_ptr<TEntryList> m_entryList;
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "TROOT.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TSystem.h"
+
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <chrono>
+
+#include "Analysis/cheetah/interface/tools.h"
+#include "Analysis/cheetah/interface/configuration.h"
+
+
+// Periodic progress & resource usage of the event loop (one JSON object per line)
+class telemetry {
+  public:
+    // Default
+    telemetry( configuration& cmaConfig );
+
+    // Default - so we can clean up;
+    virtual ~telemetry();
+
+    // Run once at the start of the job: "" = off, "stderr", or a file name (appended to)
+    void initialize( const std::string& destination, const double interval=10. );
+
+    // Run for every input file (before the event loop)
+    void startFile( TFile& file, TTree* tree, const std::string& filename, const Long64_t eventsToRun );
+
+    // Run for every event -- only reads the clock every few events
+    void update( const bool selected ){
+        m_events++;
+        if (selected) m_selected++;
+        if (m_enabled && m_events%m_checkEvents==0) check();
+        return;
+    }
+
+    // Run for every input file (after the event loop)
+    void endFile();
+
+    bool enabled() const {return m_enabled;}
+
+  protected:
+
+    void check();
+    void report( const std::string& status );
+    std::string escape( const std::string& value ) const;
+
+    configuration *m_config;
+
+    bool m_enabled;
+    std::ofstream m_file;
+    std::ostream* m_output;
+    double m_interval;                // seconds between reports
+    Long64_t m_checkEvents;           // events between clock reads
+
+    typedef std::chrono::steady_clock clock;
+    clock::time_point m_jobStart;
+    clock::time_point m_fileStart;
+    clock::time_point m_lastReport;
+
+    // current file
+    TFile* m_inputFile;
+    std::string m_filename;
+    unsigned int m_fileNumber;
+    Long64_t m_eventsToRun;
+    Long64_t m_events;
+    Long64_t m_selected;
+    Long64_t m_lastEvents;
+    Long64_t m_lastSelected;
+    Long64_t m_bytesRead;             // at the start of the file
+    Long64_t m_lastBytesRead;
+    double m_compressionFactor;       // uncompressed / compressed size of the TTree
+};
+
+#endif
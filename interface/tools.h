@@ -42,12 +42,20 @@ namespace cma{
     void getListOfBranches( TTree* tree, std::vector<std::string>& treeBranches );
     void getListOfKeys( TFile* file, std::vector<std::string> &fileKeys );
 
+    /* Get a directory in a file, e.g., 'dir/subdir' (created if needed; "" = top of the file) */
+    TDirectory* getDirectory( TFile& file, const std::string& path );
+
     /* Convert string to boolean */
     bool str2bool( const std::string value );
 
     /* Convert vector of strings into a string of comma-separated elements */
     std::string vectorToStr( const std::vector<std::string> &vec );
 
+    /* 64-bit FNV-1a hash of a string (stable between runs -- used for cache keys)
+       pass a previous hash as 'seed' to combine several strings */
+    unsigned long long hash( const std::string& value, unsigned long long seed=14695981039346656037ULL );
+    std::string hashToStr( const unsigned long long hashValue );   // 16 hex digits
+
     /* DeltaR matching of TLorentzVectors (default deltaR=0.75) */
     bool deltaRMatch( const TLorentzVector &particle1, const TLorentzVector &particle2, const double deltaR=0.75 );
 
@@ -69,6 +77,8 @@ namespace cma{
     // debug message handling
     extern std::string m_debugLevel;
     void setVerboseLevel(const std::string& verboseLevel);
+    bool debugEnabled();                   // check before building long DEBUG messages in the event loop
+    void DEBUG(const char* message);       // no std::string is made unless the message is printed
     void DEBUG(const std::string& message);
     void INFO(const std::string& message);
     void WARNING(const std::string& message);
@@ -76,6 +86,12 @@ namespace cma{
     void HELP(const std::string& runExecutable="run");
     std::map<std::string,unsigned int> verboseMap();
     void verbose(const std::string level, const std::string& message);
+
+#ifdef CHEETAH_DEBUG_ALLOCATIONS
+    /* Number of heap allocations made so far (global operator new is replaced in tools.cxx)
+       -- build with -DCHEETAH_DEBUG_ALLOCATIONS to check the event loop for allocations */
+    unsigned long long allocationCount();
+#endif
 }
 
 #endif
@@ -22,8 +22,8 @@ class truthMatching {
     // Default - so we can clean up;
     virtual ~truthMatching();
     void initialize();
-    void setTruthPartons(const std::vector<Parton> truth_partons);
-    void setTruthTops(const std::vector<TruthTop> truth_tops);
+    void setTruthPartons(const std::vector<Parton>& truth_partons);
+    void setTruthTops(const std::vector<TruthTop>& truth_tops);
 
     void matchJetToTruthTop(Jet& jet);
     void matchJetToTruthJet(Jet& jet, const std::vector<Jet>& truth_jets);
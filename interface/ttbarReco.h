@@ -15,7 +15,7 @@ class ttbarReco {
 
     ~ttbarReco();
 
-    Ttbar1L ttbar1L() {return m_ttbar1L;}
+    const Ttbar1L& ttbar1L() const {return m_ttbar1L;}
 
     // single lepton
     void execute(std::vector<Lepton>& leptons, std::vector<Neutrino>& nu, std::vector<Jet>& jets, std::vector<Ljet>& ljets);
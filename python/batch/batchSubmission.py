@@ -10,6 +10,9 @@ Texas A&M University
 Base class for submitting batch jobs.
 Setup for condor system at the LPC
 -- Class can be extended for other batch systems
+-- backend 'local' runs the jobs in a pool of processes on this machine (see localExecutor.py)
+-- one job per input file, except with 'removeDuplicates': the files of the datasets
+   in 'duplicatePriority' go to one job (duplicates are only found within a job)
 """
 import os
 import sys
@@ -17,6 +20,7 @@ import commands
 from collections import OrderedDict
 import Analysis.CyMiniAna.util as util
 import batchScripts as bs
+from localExecutor import LocalExecutor
 
 
 class BatchSubmission(object):
@@ -30,6 +34,8 @@ class BatchSubmission(object):
         self.submit     = True      # don't submit jobs, just testing code
         self.config     = 'config/cmaConfig.txt' # CyMiniAna configuration file
         self.file       = 'share/miniSL_ntuples.txt'
+        self.backend    = 'condor'  # 'condor' or 'local'
+        self.executor   = LocalExecutor()   # runs the jobs for the 'local' backend
 
         self.cmssw_base = os.environ['CMSSW_BASE']            # path to CMSSW directory
         self.cmsRelease = os.environ['CMSSW_VERSION']         # 'CMSSW_8_0_28_patch1'
@@ -134,6 +140,10 @@ class BatchSubmission(object):
         # -- Print the configuration
         if self.verbose_level == "DEBUG": self.Print()
 
+        if self.backend not in ['condor','local']:
+            print " BATCH SUBMISSION : Unknown backend '{0}'; use 'condor' or 'local'".format(self.backend)
+            sys.exit(1)
+
         # -- Make some directories, if needed
         if not os.path.exists('batch'): os.makedirs('batch')
 
@@ -142,9 +152,9 @@ class BatchSubmission(object):
 
         miniSL_ntuples = util.file2list(self.file)   # files to process as inputs
 
-        for l,minisl_ntuple in enumerate(miniSL_ntuples):
+        for name,minisl_ntuple in self.groupInputs(miniSL_ntuples):
             # -- simplify the filename for reference later
-            self.tmp_ntuple = minisl_ntuple.split('/')[-1].replace('.root','')
+            self.tmp_ntuple = name
 
 
             # -- Setup the unique ID for making unique files/configurations/etc.
@@ -161,9 +171,46 @@ class BatchSubmission(object):
 
             self.submit_job()
 
+        # -- Run the local jobs
+        if self.backend=='local' and self.submit:
+            self.run_local()
+
         return
 
 
+    def groupInputs(self,files):
+        """
+        Inputs of each job: (name, files separated by newlines)
+        -- one file per job, except the files of the datasets in 'duplicatePriority'
+           when removing duplicate events: those are processed by a single job
+        """
+        options = OrderedDict()
+        for line in util.file2list(self.config):
+            option = line.split(' ')
+            if len(option)==2: options[option[0]] = option[1]
+
+        groups = OrderedDict()
+        if util.str2bool( options.get('removeDuplicates','false') ):
+            priority = [d for d in options.get('duplicatePriority','SingleMuon,SingleElectron').split(',') if d]
+            name     = "_".join(priority)
+            matched  = [f for f in files if any(dataset in f for dataset in priority)]
+            if matched:
+                groups[name] = matched
+                print " BATCH SUBMISSION : {0} files of {1} are processed in one job to remove duplicate events".format(len(matched),",".join(priority))
+                if int(options.get('nJobs','1'))>1:
+                    print " BATCH SUBMISSION : WARNING : 'nJobs' splits that job again; duplicates are only removed within each part"
+            files = [f for f in files if f not in matched]
+
+        for f in files:
+            groups[ f.split('/')[-1].replace('.root','') ] = [f]
+
+        if options.get('lumiMask','') and len(groups)>1:
+            print " BATCH SUBMISSION : WARNING : each job reports the luminosity sections of its own inputs (processedLumis_<input>.json);"
+            print " BATCH SUBMISSION : WARNING : combine the reports of all {0} jobs for the luminosity".format(len(groups))
+
+        return [(name,"\n".join(group)) for name,group in groups.items()]
+
+
     def submit_job(self):
         """Submit the job"""
         # -- Write the CyMiniAnaAC configuration file
@@ -171,6 +218,19 @@ class BatchSubmission(object):
         self.writeConfiguration()
         self.vb.INFO("BATCH SUBMISSION : Config filename = {0}".format(self.cfg_filename))
 
+        # -- Local jobs: run the executable on the configuration from the base directory
+        if self.backend=='local':
+            command = "{0} {1}".format(self.executable,self.cfg_filename)
+            self.executor.add(self.unique_id_name,command,self.unique_id_batch_path,cwd=self.baseDir)
+            self.vb.INFO("BATCH SUBMISSION : Local command   = {0}".format(command))
+
+            if self.test:
+                if self.submit: self.run_local()
+                self.vb.INFO("BATCH SUBMISSION : Test complete. ")
+                sys.exit(1)
+
+            return
+
         # -- Write the script executed by the batch system
         self.batchFileName = "{0}/run_batch.condor".format(self.unique_id_batch_path)
         self.writeBatchScript()
@@ -196,6 +256,19 @@ class BatchSubmission(object):
 
 
 
+    def run_local(self):
+        """Run the jobs that were prepared for the 'local' backend"""
+        self.executor.verbose_level = self.verbose_level
+        self.executor.initialize(self.vb)
+        nFailed = self.executor.execute()
+
+        if nFailed:
+            self.vb.WARNING("BATCH SUBMISSION : {0} local jobs failed".format(nFailed))
+
+        return
+
+
+
     def Print(self):
         """Print the configuration of arguments for batch submission"""
         print ""
@@ -204,7 +277,7 @@ class BatchSubmission(object):
         print ""
 
         attributes = ['username','executable','config','baseDir',
-        'mode','test','submit','verbose_level']
+        'backend','test','submit','verbose_level']
 
         for attr in attributes:
             print " %-*s : %s" % (16,attr,getattr(self,attr))
@@ -0,0 +1,216 @@
+"""
+Created:        19 October 2026
+Last Updated:   19 October 2026
+
+agent
+agent@local
+-----
+
+Run the jobs prepared by BatchSubmission on the local machine
+(stand-in for condor: production on a single large workstation, or testing)
+
+ - Jobs run in a pool of processes; the number of jobs running at once
+   is limited by the number of CPUs and the available memory
+   ('memory' is reserved for each running job out of the memory available at the start)
+ - Failed jobs are retried (up to 'retries' times)
+ - Output of each attempt is written to a log file in the job's batch directory
+ - A summary of all jobs is printed at the end
+"""
+import os
+import time
+import subprocess
+import multiprocessing
+from collections import OrderedDict
+
+
+class LocalJob(object):
+    """Book-keeping for a single job"""
+    def __init__(self,name,command,directory,cwd):
+        self.name      = name          # unique ID of the job
+        self.command   = command       # command executed in a shell
+        self.directory = directory     # batch directory of the job (for the logs)
+        self.cwd       = cwd           # directory the command is executed from
+
+        self.attempts  = 0
+        self.status    = 'PENDING'     # PENDING, RUNNING, DONE, FAILED
+        self.returncode = None
+        self.duration  = 0.
+        self.logfile   = ''
+        self.process   = None
+        self.start     = 0.
+
+
+class LocalExecutor(object):
+    """Execute jobs in parallel processes on the local machine"""
+    def __init__(self):
+        self.nWorkers   = 0         # maximum number of jobs running at once (<=0: number of CPUs)
+        self.memory     = 0.        # expected memory per job [GB] (<=0: don't check)
+        self.memoryLimit = float('inf')   # memory for all jobs [GB] (available when initialized)
+        self.retries    = 1         # number of times a failed job is re-submitted
+        self.poll       = 1.        # seconds between checks of the running jobs
+        self.jobs       = OrderedDict()
+
+        self.verbose_level = "INFO"
+        self.vb = None
+
+
+    def initialize(self,vb=None):
+        """Setup the number of workers"""
+        self.vb = vb
+
+        nCPUs = multiprocessing.cpu_count()
+        if self.nWorkers<=0 or self.nWorkers>nCPUs:
+            self.nWorkers = nCPUs
+
+        if self.memory>0:
+            self.memoryLimit = availableMemory()
+            if self.memoryLimit<float('inf'):
+                nFit = int( self.memoryLimit / self.memory )
+                if nFit<self.nWorkers:
+                    self.INFO("LOCAL : Memory ({0:.1f} GB) limits the number of jobs to {1}".format(self.memoryLimit,max(nFit,1)))
+                self.nWorkers = max(1,min(self.nWorkers,nFit))
+
+        return
+
+
+    def add(self,name,command,directory,cwd='.'):
+        """Add a job to the queue"""
+        self.jobs[name] = LocalJob(name,command,directory,cwd)
+        return
+
+
+    def canStart(self,nRunning):
+        """
+        Check if another job can start (CPUs and memory)
+        -- the memory of the running jobs is reserved: they may not have allocated it yet,
+           so the memory available now does not tell if another one fits
+        """
+        if nRunning>=self.nWorkers: return False
+        if nRunning<1: return True                  # always run at least one job
+        if self.memory>0 and (nRunning+1)*self.memory>self.memoryLimit: return False
+        return True
+
+
+    def start(self,job):
+        """Start a job; its output goes to a log file for this attempt"""
+        job.attempts += 1
+        job.logfile = "{0}/local_{1}.log".format(job.directory,job.attempts)
+        log = open(job.logfile,'w')
+        log.write(" > Starting LOCAL job {0} (attempt {1}) at {2}\n".format(job.name,job.attempts,time.ctime()))
+        log.write(" > {0}\n".format(job.command))
+        log.flush()
+
+        job.process = subprocess.Popen(job.command,shell=True,cwd=job.cwd,
+                                       stdout=log,stderr=subprocess.STDOUT)
+        log.close()              # the child has its own copy of the file descriptor
+        job.status = 'RUNNING'
+        job.start  = time.time()
+
+        self.INFO("LOCAL : Started {0} (attempt {1})".format(job.name,job.attempts))
+
+        return
+
+
+    def finish(self,job):
+        """Record the result of a job that exited; re-queue it if it failed"""
+        job.returncode = job.process.returncode
+        job.duration  += time.time()-job.start
+        job.process    = None
+
+        with open(job.logfile,'a') as log:
+            log.write(" > Ended at {0} with return code {1}\n".format(time.ctime(),job.returncode))
+
+        if job.returncode==0:
+            job.status = 'DONE'
+            self.INFO("LOCAL : Finished {0}".format(job.name))
+        elif job.attempts<=self.retries:
+            job.status = 'PENDING'
+            self.WARNING("LOCAL : {0} failed (return code {1}); retrying. See {2}".format(job.name,job.returncode,job.logfile))
+        else:
+            job.status = 'FAILED'
+            self.WARNING("LOCAL : {0} failed (return code {1}). See {2}".format(job.name,job.returncode,job.logfile))
+
+        return
+
+
+    def execute(self):
+        """Run all jobs; returns the number of failed jobs"""
+        if not self.jobs: return 0
+
+        self.INFO("LOCAL : Running {0} jobs with up to {1} at once".format(len(self.jobs),self.nWorkers))
+
+        try:
+            while True:
+                running = [j for j in self.jobs.values() if j.status=='RUNNING']
+                for job in running:
+                    if job.process.poll() is not None:
+                        self.finish(job)
+
+                running = [j for j in self.jobs.values() if j.status=='RUNNING']
+                pending = [j for j in self.jobs.values() if j.status=='PENDING']
+                if not running and not pending: break
+
+                for job in pending:
+                    if not self.canStart(len(running)): break
+                    self.start(job)
+                    running.append(job)
+
+                time.sleep(self.poll)
+        except KeyboardInterrupt:
+            self.WARNING("LOCAL : Interrupted; stopping the running jobs")
+            for job in self.jobs.values():
+                if job.status=='RUNNING':
+                    job.process.terminate()
+                    job.process.wait()
+                    self.finish(job)
+                    job.status = 'FAILED'
+
+        self.summary()
+
+        return len([j for j in self.jobs.values() if j.status!='DONE'])
+
+
+    def summary(self):
+        """Print the status of all jobs"""
+        width = max([len(j) for j in self.jobs.keys()]+[3])
+
+        print ""
+        print " LOCAL : Summary "
+        print " --------------- "
+        print " %-*s  %-7s  %8s  %9s  %s" % (width,"job","status","attempts","time [s]","log")
+        for job in self.jobs.values():
+            print " %-*s  %-7s  %8d  %9.1f  %s" % (width,job.name,job.status,job.attempts,job.duration,job.logfile)
+
+        nDone = len([j for j in self.jobs.values() if j.status=='DONE'])
+        print " --------------- "
+        print " %d/%d jobs succeeded" % (nDone,len(self.jobs))
+        print ""
+
+        return
+
+
+    def INFO(self,message):
+        if self.vb is not None: self.vb.INFO(message)
+        else: print " INFO :",message
+        return
+
+    def WARNING(self,message):
+        if self.vb is not None: self.vb.WARNING(message)
+        else: print " WARNING :",message
+        return
+
+
+
+def availableMemory():
+    """Memory available for new processes [GB] (from /proc/meminfo; very large if unknown)"""
+    try:
+        with open('/proc/meminfo','r') as meminfo:
+            for line in meminfo:
+                if line.startswith('MemAvailable:'):
+                    return float(line.split()[1])/1024./1024.
+    except IOError:
+        pass
+    return float('inf')
+
+
+## THE END ##
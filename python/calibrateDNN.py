@@ -0,0 +1,128 @@
+#!/usr/bin/env python
+"""
+Created:        19 October 2026
+Last Updated:   19 October 2026
+
+agent
+agent@local
+-----
+
+Calibrate the reduced-precision (int8) version of the compiled network
+and report the deviation of the float32/int8 scores from the double-precision reference
+
+ - The network (lwtnn JSON) is evaluated with numpy on a sample of the 'features' tree
+ - The range of the inputs to each dense layer (percentile of |x|) sets the int8 scale
+ - The float32 and int8 networks are emulated as in the compiled network (python/lwtnn2header.py)
+
+To run:
+$ python python/calibrateDNN.py config/keras_ttbar_DNN.json features.root [more.root ...] -o calibration.json
+$ python python/lwtnn2header.py config/keras_ttbar_DNN.json --calibration calibration.json
+"""
+import json
+import argparse
+import numpy as np
+import uproot
+
+import lwtnn2header
+
+
+def activate(x,layer,dtype):
+    """Apply the activation function of a layer"""
+    one = dtype(1)
+    if layer.activation=='rectified':      x = np.maximum(x,dtype(0))
+    elif layer.activation=='sigmoid':      x = one/(one+np.exp(-x))
+    elif layer.activation=='tanh':         x = np.tanh(x)
+    elif layer.activation=='hard_sigmoid': x = np.clip(dtype(0.2)*x+dtype(0.5),0,1).astype(dtype)
+    elif layer.activation=='elu':          x = np.where(x>0,x,dtype(layer.alpha)*(np.exp(x)-one))
+    elif layer.activation=='softmax':
+        x = np.exp(x-x.max(axis=1,keepdims=True))
+        x = x/x.sum(axis=1,keepdims=True)
+    return x.astype(dtype)
+
+
+def evaluate(network,config,data,dtype=np.float64,calibration=None,percentile=100.):
+    """
+    Evaluate the network on 'data' (events x inputs)
+    Returns the outputs & the range (percentile of |x|) of the inputs to each dense layer
+    -- with 'calibration', the dense layers use int8 weights & inputs (as computeInt8())
+    """
+    offsets = np.array([i['offset'] for i in config['inputs']],dtype=dtype)
+    scales  = np.array([i['scale'] for i in config['inputs']],dtype=dtype)
+    x = (data.astype(dtype)+offsets)*scales
+
+    ranges = []
+    for layer in network:
+        if layer.weights is not None:
+            ranges.append( float(np.percentile(np.abs(x),percentile)) )
+            bias = np.array(layer.bias,dtype=dtype)
+
+            if calibration is None:
+                x = x.dot( np.array(layer.weights,dtype=dtype).T ) + bias
+            else:
+                inputScale = np.float32( lwtnn2header.inputScale(calibration['layers'][len(ranges)-1]['input_max']) )
+                quantized,wscales = lwtnn2header.quantize(layer.weights)
+                q = np.clip(np.rint(x/inputScale),-127,127).astype(np.int32)
+                sums = q.dot( np.array(quantized,dtype=np.int32).T )
+                x = sums*np.array(wscales,dtype=np.float32)*inputScale + bias
+
+            x = x.astype(dtype)
+
+        x = activate(x,layer,dtype)
+
+    return x,ranges
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Calibrate the int8 network & report deviations from double precision")
+    parser.add_argument('json_file',help='lwtnn JSON file (from keras2json.py)')
+    parser.add_argument('files',nargs='+',help='ROOT files with the features tree')
+    parser.add_argument('-t','--treename',default='features',help='name of the features tree')
+    parser.add_argument('-n','--nEvents',type=int,default=100000,help='number of events used for the calibration')
+    parser.add_argument('-p','--percentile',type=float,default=99.99,help='percentile of |x| used as the int8 range of each layer')
+    parser.add_argument('-o','--output',default='calibration.json',help='output calibration file')
+    args = parser.parse_args()
+
+    with open(args.json_file,'r') as f:
+        config = json.load(f)
+    network = lwtnn2header.layers(config)
+    names   = [i['name'] for i in config['inputs']]
+
+    # sample of features
+    data = []
+    nRead = 0
+    for filename in args.files:
+        tree = uproot.open(filename)[args.treename]
+        df   = tree.pandas.df(names,entrystop=args.nEvents-nRead)
+        data.append( df[names].values )
+        nRead += len(df)
+        if nRead>=args.nEvents: break
+    data = np.concatenate(data)
+    print(" Calibrating with {0} events".format(len(data)))
+
+    # reference & calibration
+    reference,ranges = evaluate(network,config,data,np.float64,percentile=args.percentile)
+    calibration = {'percentile':args.percentile,'nEvents':len(data),
+                   'layers':[{'input_max':r} for r in ranges]}
+
+    # validation report
+    single,_ = evaluate(network,config,data,np.float32)
+    int8,_   = evaluate(network,config,data,np.float32,calibration=calibration)
+
+    report = {}
+    for name,scores in [('float',single),('int8',int8)]:
+        deviation = np.abs(scores.astype(np.float64)-reference)
+        report[name] = {'max_deviation':float(deviation.max()),'mean_deviation':float(deviation.mean())}
+        print(" {0:6s} : max. deviation = {1:.3g}; mean deviation = {2:.3g}".format(name,deviation.max(),deviation.mean()))
+    calibration['report'] = report
+
+    with open(args.output,'w') as f:
+        json.dump(calibration,f,indent=2)
+    print(" Wrote {0}".format(args.output))
+
+    return
+
+
+if __name__ == '__main__':
+    main()
+
+## THE END ##
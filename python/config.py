@@ -78,6 +78,11 @@ class Config(object):
         setattr(self,'activation',   self.get('activation') )
         setattr(self,'nEntries',     int( self.get('nEntries') ))
         setattr(self,'verbose_level',self.get('verbose') )
+        setattr(self,'streaming',    util.str2bool( self.get('streaming') ))
+        setattr(self,'chunk_size',   int( self.get('chunk_size') ))
+        setattr(self,'buffer_size',  int( self.get('buffer_size') ))
+        setattr(self,'nWorkers',     int( self.get('nWorkers') ))
+        setattr(self,'nThreads',     int( self.get('nThreads') ))
 
         return
 
@@ -104,7 +109,12 @@ class Config(object):
                     'percentile':75,
                     'activation':'elu',
                     'nEntries':-1,
-                    'verbose_level':'INFO'}
+                    'verbose_level':'INFO',
+                    'streaming':'false',
+                    'chunk_size':100000,
+                    'buffer_size':1000000,
+                    'nWorkers':1,
+                    'nThreads':0}
 
         return defaults
 
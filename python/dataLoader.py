@@ -0,0 +1,223 @@
+"""
+Created:        19 October 2026
+Last Updated:   19 October 2026
+
+agent
+agent@local
+-----
+
+Streaming access to the physics data (flat ntuples) for the NN
+
+The files are read in fixed-size chunks (via uproot, or pandas for HDF5 tables)
+so the training set does not need to fit in memory:
+  - events are shuffled inside a (large) buffer of chunks
+  - batches are handed to Keras through a generator
+  - k-fold splits are defined by the global event index
+    (same split every time, without holding the indices in memory)
+
+To use:
+    loader = StreamingData(['file1.root','file2.root'],'features',features,'target')
+    loader.initialize()
+    steps = loader.steps(batch_size,fold=0,training=True)
+    model.fit_generator( loader.generator(batch_size,fold=0,training=True), steps_per_epoch=steps )
+"""
+import util
+import numpy as np
+import pandas as pd
+import uproot
+
+
+class StreamingData(object):
+    """Read the physics data in chunks and serve batches for training/testing"""
+    def __init__(self,files=[],treename='features',features=[],target='target'):
+        self.files    = files          # list of ROOT files (or HDF5 tables: '.h5')
+        self.treename = treename       # TTree (or HDF5 key) in each file
+        self.features = features       # branches used as inputs to the NN
+        self.target   = target         # branch with the label
+        self.extra_branches = []       # other branches needed (e.g., for plotting)
+
+        self.chunk_size   = 100000     # number of events read from disk at once
+        self.buffer_size  = 1000000    # number of events shuffled together
+        self.kfold_splits = 2          # number of folds; events assigned by global index
+        self.seed         = 2018
+        self.target_transform = None   # function applied to the labels of each batch (e.g., one-hot encoding)
+
+        self.entries = []              # number of events in each file
+        self.offsets = []              # global index of the first event in each file
+        self.verbose_level = 'INFO'
+
+
+    def initialize(self):
+        """Count the events in each file (no data is read)"""
+        self.msg_svc       = util.VERBOSE()
+        self.msg_svc.level = self.verbose_level
+        self.msg_svc.initialize()
+        self.random = np.random.RandomState(self.seed)   # different order each epoch, same for every job
+
+        if isinstance(self.files,basestring):
+            self.files = getFileList(self.files)
+
+        self.entries = []
+        self.offsets = []
+        offset = 0
+        for filename in self.files:
+            nEntries = self.numEntries(filename)
+            self.entries.append( nEntries )
+            self.offsets.append( offset )
+            offset += nEntries
+
+        self.msg_svc.INFO("DL : Streaming {0} events from {1} files".format(offset,len(self.files)))
+
+        return
+
+
+    def numEntries(self,filename):
+        """Number of events in a single file"""
+        if filename.endswith('.h5'):
+            with pd.HDFStore(filename,'r') as store:
+                return store.get_storer(self.treename).nrows
+        return uproot.open(filename)[self.treename].numentries
+
+
+    def branches(self):
+        """All branches that are read from the files"""
+        branches = self.features+[self.target]
+        branches += [i for i in self.extra_branches if i not in branches]
+        return branches
+
+
+    def read(self,filename,start,stop):
+        """Read events [start,stop) of one file into a DataFrame"""
+        if filename.endswith('.h5'):
+            df = pd.read_hdf(filename,self.treename,start=start,stop=stop,columns=self.branches())
+        else:
+            df = uproot.open(filename)[self.treename].pandas.df(self.branches(),entrystart=start,entrystop=stop)
+        return df.reset_index(drop=True)
+
+
+    def fold(self,index):
+        """
+        Fold of each event given its global index
+        -- splitmix64 of the index & seed (as duplicateFilter::mix()) so the folds are
+           mixed over files/entries for any number of folds, but reproducible
+        -- uint64 arithmetic wraps around (mod 2^64)
+        """
+        with np.errstate(over='ignore'):
+            h  = np.asarray(index,dtype=np.uint64)*np.uint64(0x9E3779B97F4A7C15) ^ np.uint64(self.seed)
+            h ^= h >> np.uint64(30)
+            h *= np.uint64(0xBF58476D1CE4E5B9)
+            h ^= h >> np.uint64(27)
+            h *= np.uint64(0x94D049BB133111EB)
+            h ^= h >> np.uint64(31)
+        return (h % np.uint64(self.kfold_splits)).astype(np.int64)
+
+
+    def select(self,index,fold=None,training=True):
+        """Mask of events that belong to the training (all other folds) or testing (this fold) sample"""
+        if fold is None:
+            return np.ones(len(index),dtype=bool)
+        in_fold = self.fold(index)==fold
+        return ~in_fold if training else in_fold
+
+
+    def chunks(self,fold=None,training=True):
+        """Iterate over the data in chunks; only keep the events of the requested sample"""
+        for filename,nEntries,offset in zip(self.files,self.entries,self.offsets):
+            for start in range(0,nEntries,self.chunk_size):
+                stop  = min(start+self.chunk_size,nEntries)
+                index = np.arange(offset+start,offset+stop)
+                mask  = self.select(index,fold,training)
+                if not mask.any(): continue
+
+                df = self.read(filename,start,stop)
+                yield df[mask].reset_index(drop=True)
+
+
+    def size(self,fold=None,training=True):
+        """Number of events in the sample (computed from the indices only)"""
+        total = sum(self.entries)
+        nEvents = 0
+        for start in range(0,total,self.chunk_size):
+            index = np.arange(start,min(start+self.chunk_size,total))
+            nEvents += np.count_nonzero( self.select(index,fold,training) )
+        return nEvents
+
+
+    def steps(self,batch_size,fold=None,training=True):
+        """Number of batches in one pass over the sample (for Keras 'steps_per_epoch')"""
+        return int( np.ceil(self.size(fold,training) / float(batch_size)) )
+
+
+    def batches(self,batch_size,fold=None,training=True,shuffle=True):
+        """
+        One pass over the sample in batches of (X,Y)
+        -- fill the buffer with chunks, shuffle it, and serve the full batches;
+           the leftover events are carried into the next buffer
+        """
+        buffer = []
+        nBuffer = 0
+
+        def serve(df,last=False):
+            if shuffle: df = df.iloc[self.random.permutation(len(df))]
+            nBatches = len(df)//batch_size
+            if last and len(df)%batch_size: nBatches += 1
+            for b in range(nBatches):
+                yield self.toArrays( df.iloc[b*batch_size:(b+1)*batch_size] )
+            self.leftover = df.iloc[nBatches*batch_size:]
+
+        for chunk in self.chunks(fold,training):
+            buffer.append(chunk)
+            nBuffer += len(chunk)
+            if nBuffer<self.buffer_size: continue
+
+            for batch in serve( pd.concat(buffer,ignore_index=True) ): yield batch
+            buffer  = [self.leftover]
+            nBuffer = len(self.leftover)
+
+        if nBuffer>0:
+            for batch in serve( pd.concat(buffer,ignore_index=True),last=True ): yield batch
+
+        return
+
+
+    def generator(self,batch_size,fold=None,training=True,shuffle=True):
+        """Endless generator of batches for Keras (fit_generator/evaluate_generator/predict_generator)"""
+        while True:
+            for batch in self.batches(batch_size,fold,training,shuffle):
+                yield batch
+
+
+    def toArrays(self,df):
+        """Features and labels of a batch"""
+        X = df[self.features].values
+        Y = df[self.target].values
+        if self.target_transform is not None:
+            Y = self.target_transform(Y)
+        return X,Y
+
+
+    def sample(self,nEvents):
+        """First 'nEvents' events (all branches) as a DataFrame -- e.g., for plotting the features"""
+        dfs = []
+        nRead = 0
+        for chunk in self.chunks():
+            dfs.append(chunk)
+            nRead += len(chunk)
+            if nRead>=nEvents: break
+
+        if not dfs: return pd.DataFrame(columns=self.branches())
+        return pd.concat(dfs,ignore_index=True).iloc[:nEvents]
+
+
+
+def getFileList(hep_data):
+    """
+    List of files from the 'hep_data' option:
+      - single file, comma-separated files, or a text file listing one file per line
+    """
+    if hep_data.endswith('.txt'):
+        return util.file2list(hep_data)
+    return hep_data.split(',')
+
+
+## THE END ##
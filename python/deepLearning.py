@@ -28,9 +28,17 @@ Expandable: Do 'testing' phase later than training phase
             Diagnostics post-training phase
             Different model (PyTorch)
 """
+import os
+import sys
 import json
 import util
+import pickle
+import shutil
+import tempfile
 import datetime
+import subprocess
+import multiprocessing
+from multiprocessing.pool import ThreadPool
 
 import matplotlib
 matplotlib.use('PDF')   # png not supported at LPC; do this before anything else tries to set the backend
@@ -46,6 +54,7 @@ from keras.utils.np_utils import to_categorical
 from sklearn.model_selection import train_test_split,StratifiedKFold
 from sklearn.metrics import roc_curve, auc
 from deepLearningPlotter import DeepLearningPlotter
+from dataLoader import StreamingData,getFileList
 
 
 # fix random seed for reproducibility
@@ -90,6 +99,7 @@ class DeepLearning(object):
         self.dropout = None
         self.metrics = ['accuracy']
         self.features   = []
+        self.variables2plot = []             # extra branches read for the plots (set in load_hep_data)
         self.epochs     = 1        
         self.optimizer  = 'adam'
         self.input_dim  = 1                  # len(self.features)
@@ -100,6 +110,17 @@ class DeepLearning(object):
         self.nHiddenLayers = 1
         self.earlystopping = {}              # {'monitor':'loss','min_delta':0.0001,'patience':5,'mode':'auto'}
 
+        ## Streaming the physics data (datasets larger than memory)
+        self.streaming   = False             # read the data in chunks instead of one DataFrame
+        self.chunk_size  = 100000            # events read from disk at once
+        self.buffer_size = 1000000           # events shuffled together
+        self.nEventsPlot = 100000            # events loaded into 'self.df' for the diagnostic plots
+        self.loader      = None              # StreamingData object (set in load_hep_data)
+
+        ## Parallel k-fold cross-validation (one process per fold, CPU-only)
+        self.nWorkers  = 1                   # number of processes training folds at the same time (1 = sequential)
+        self.nThreads  = 0                   # threads per process (0 = #CPUs / nWorkers)
+
 
     def initialize(self):   #,config):
         """Initialize a few parameters after they've been set by user"""
@@ -128,6 +149,7 @@ class DeepLearning(object):
         self.plotter = DeepLearningPlotter()  # class for plotting relevant NN information
         self.plotter.output_dir   = self.output_dir
         self.plotter.image_format = 'png'
+        self.plotter.nWorkers     = self.nWorkers
         if self.dnn_method!='regression':
             self.plotter.classification = self.dnn_method
             self.plotter.regression     = False
@@ -168,6 +190,7 @@ class DeepLearning(object):
         self.build_model()
 
         # hard-coded :/
+        self.plotter.data_key = self.data_key()
         self.plotter.initialize(self.df,self.target_names,self.target_values)
 
         if self.runDiagnostics:
@@ -237,6 +260,10 @@ class DeepLearning(object):
 
     def train_model(self):
         """Setup for training the model using k-fold cross-validation"""
+        if self.streaming:
+            self.train_model_streaming()
+            return
+
         self.msg_svc.INFO("DL : Train the model!")
 
         callbacks_list = []
@@ -259,10 +286,19 @@ class DeepLearning(object):
         nsplits = kfold.get_n_splits(X,Y)
         cvpredictions = []                 # compare outputs from each cross-validation
 
+        if self.nWorkers>1:
+            self.train_model_parallel(X,Y,kfold)
+            return
+
         self.msg_svc.INFO("DL :   Fitting K-Fold cross validation".format(self.kfold_splits))
+        initial_weights = self.model.get_weights()    # every fold starts from the same weights
         for ind,(train,test) in enumerate(kfold.split(X,Y)):
             self.msg_svc.DEBUG("DL :   - Fitting K-Fold {0}".format(ind))
 
+            if ind>0:
+                self.model.compile(loss=self.loss, optimizer=self.optimizer, metrics=self.metrics)  # new optimizer state
+                self.model.set_weights(initial_weights)
+
             # store test/train data from each k-fold to compare later
             self.test_data['X'].append(X[test])
             self.test_data['Y'].append(Y[test])
@@ -270,23 +306,7 @@ class DeepLearning(object):
             self.train_data['Y'].append(Y[train])
 
             # Fit the model to training data & save the history
-            Y_train = Y[train]
-            Y_test  = Y[test]
-            if self.dnn_method=='multi' or self.dnn_method=='regression' and not np.array_equal(Y_train,(Y_train[0],self.output_dim)):
-                train_shape = Y_train.shape[0]
-                train_total_array = []
-                test_shape = Y_test.shape[0]
-                test_total_array = []
-                for a in range(self.output_dim):
-                    dummy_train = np.zeros(train_shape)
-                    dummy_train[Y[train][0]==a] = 1
-                    train_total_array.append( dummy_train.tolist() )
-
-                    dummy_test = np.zeros(test_shape)
-                    dummy_test[Y[test][0]==a] = 1
-                    test_total_array.append( dummy_test.tolist() )
-                Y_train = np.array(train_total_array).T
-                Y_test  = np.array(test_total_array).T
+            Y_train,Y_test = self.kfold_targets(Y,train,test)
             history = self.model.fit(X[train],Y_train,epochs=self.epochs,\
                                      callbacks=callbacks_list,batch_size=self.batch_size,verbose=self.verbose)
             self.histories.append(history)
@@ -318,6 +338,189 @@ class DeepLearning(object):
         return
 
 
+    def kfold_targets(self,Y,train,test):
+        """Labels of the training & testing samples in the format needed by the model"""
+        Y_train = Y[train]
+        Y_test  = Y[test]
+        if self.dnn_method=='multi' or self.dnn_method=='regression' and not np.array_equal(Y_train,(Y_train[0],self.output_dim)):
+            train_shape = Y_train.shape[0]
+            train_total_array = []
+            test_shape = Y_test.shape[0]
+            test_total_array = []
+            for a in range(self.output_dim):
+                dummy_train = np.zeros(train_shape)
+                dummy_train[Y[train][0]==a] = 1
+                train_total_array.append( dummy_train.tolist() )
+
+                dummy_test = np.zeros(test_shape)
+                dummy_test[Y[test][0]==a] = 1
+                test_total_array.append( dummy_test.tolist() )
+            Y_train = np.array(train_total_array).T
+            Y_test  = np.array(test_total_array).T
+
+        return Y_train,Y_test
+
+
+    def train_model_parallel(self,X,Y,kfold):
+        """
+        Train the k-folds at the same time in separate processes
+        -- each fold is trained in a fresh interpreter ('python deepLearning.py <job>'):
+           TensorFlow is already loaded here, so it cannot be used in forked processes,
+           and the CPU-only/'nThreads' environment has to be set before it is imported
+        -- every fold starts from the initial weights of self.model (as in the sequential loop)
+        -- the features are written once and memory-mapped by the processes (not copied for each fold)
+        """
+        nThreads = self.nThreads if self.nThreads>0 else max(1,multiprocessing.cpu_count()//self.nWorkers)
+        compile_args = {'loss':self.loss,'optimizer':self.optimizer,'metrics':self.metrics}
+        callbacks    = {'earlystopping':self.earlystopping}
+
+        env = dict(os.environ)
+        env['CUDA_VISIBLE_DEVICES'] = ''
+        env['OMP_NUM_THREADS']      = str(nThreads)
+
+        tmp_dir  = tempfile.mkdtemp(prefix='kfolds_',dir=self.output_dir)
+        features = os.path.join(tmp_dir,'features.npy')
+        np.save(features,X)
+
+        initial_weights = self.model.get_weights()
+        jobfiles = []
+        folds    = []
+        for ind,(train,test) in enumerate(kfold.split(X,Y)):
+            Y_train,Y_test = self.kfold_targets(Y,train,test)
+            folds.append( (train,test) )
+            job = {'fold':ind,'model':self.model.to_json(),'weights':initial_weights,'compile':compile_args,
+                   'callbacks':callbacks,'features':features,'train':train,'test':test,'Y_train':Y_train,'Y_test':Y_test,
+                   'epochs':self.epochs,'batch_size':self.batch_size,'threads':nThreads,
+                   'result':os.path.join(tmp_dir,'result{0}.pkl'.format(ind))}
+            jobfiles.append( os.path.join(tmp_dir,'job{0}.pkl'.format(ind)) )
+            with open(jobfiles[-1],'wb') as f:
+                pickle.dump(job,f,protocol=pickle.HIGHEST_PROTOCOL)
+
+        nWorkers = min(self.nWorkers,len(jobfiles))
+        self.msg_svc.INFO("DL :   Fitting K-Fold cross validation with {0} processes ({1} threads each)".format(nWorkers,nThreads))
+
+        script = os.path.splitext(os.path.abspath(__file__))[0]+'.py'
+        def run_fold(jobfile):
+            return subprocess.call([sys.executable,script,jobfile],env=env)
+
+        pool   = ThreadPool(processes=nWorkers)     # each thread waits for one process
+        status = pool.map(run_fold,jobfiles,chunksize=1)
+        pool.close()
+        pool.join()
+
+        failed = [ind for ind,code in enumerate(status) if code!=0]
+        if failed:
+            self.msg_svc.ERROR("DL : Training failed for k-fold(s) {0}; inputs kept in {1}".format(failed,tmp_dir))
+            raise RuntimeError("DL : Parallel k-fold training failed")
+
+        results = []                                # ordered by fold
+        for ind in range(len(jobfiles)):
+            with open(os.path.join(tmp_dir,'result{0}.pkl'.format(ind)),'rb') as f:
+                results.append( pickle.load(f) )
+        shutil.rmtree(tmp_dir)
+
+        cvpredictions = []
+        for (train,test),result in zip(folds,results):
+            self.test_data['X'].append(X[test])
+            self.test_data['Y'].append(Y[test])
+            self.train_data['X'].append(X[train])
+            self.train_data['Y'].append(Y[train])
+
+            self.histories.append( FoldHistory(result['history']) )
+            cvpredictions.append(result['evaluate'][1] * 100)
+            self.msg_svc.DEBUG("DL :   - K-Fold {0} {1}: {2:.2f}%".format(result['fold'],result['metrics_names'][1],result['evaluate'][1]*100))
+
+            self.train_predictions.append( result['train_predictions'] )
+            self.test_predictions.append( result['test_predictions'] )
+
+            # Make ROC curve from test sample
+            if self.dnn_method=='binary':
+                fpr,tpr,_ = roc_curve( Y[test], result['test_predictions'] )
+                self.fpr.append(fpr)
+                self.tpr.append(tpr)
+
+        # keep the model from the last fold (saved after training)
+        self.model.set_weights( results[-1]['weights'] )
+
+        self.msg_svc.INFO("DL :   Finished K-Fold cross-validation: ")
+        self.accuracy = {'mean':np.mean(cvpredictions),'std':np.std(cvpredictions)}
+        self.msg_svc.INFO("DL :   - Accuracy: {0:.2f}% (+/- {1:.2f}%)".format(np.mean(cvpredictions), np.std(cvpredictions)))
+
+        return
+
+
+    def train_model_streaming(self):
+        """
+        Train the model using k-fold cross-validation on data streamed from disk
+        -- folds defined by the event index (StreamingData.fold());
+           only the predictions & labels are kept in memory, not the features
+        """
+        self.msg_svc.INFO("DL : Train the model (streaming the data)!")
+
+        callbacks_list = []
+        if self.earlystopping:
+            earlystop = EarlyStopping(**self.earlystopping)
+            callbacks_list = [earlystop]
+
+        initial_weights = self.model.get_weights()    # every fold starts from the same weights
+        cvpredictions   = []                 # compare outputs from each cross-validation
+
+        self.msg_svc.INFO("DL :   Fitting K-Fold cross validation".format(self.kfold_splits))
+        for ind in range(self.kfold_splits):
+            self.msg_svc.DEBUG("DL :   - Fitting K-Fold {0}".format(ind))
+
+            if ind>0:
+                self.model.compile(loss=self.loss, optimizer=self.optimizer, metrics=self.metrics)  # new optimizer state
+                self.model.set_weights(initial_weights)
+
+            # Fit the model to training data & save the history
+            train_steps = self.loader.steps(self.batch_size,fold=ind,training=True)
+            history = self.model.fit_generator( self.loader.generator(self.batch_size,fold=ind,training=True),
+                                                steps_per_epoch=train_steps,epochs=self.epochs,
+                                                callbacks=callbacks_list,verbose=self.verbose)
+            self.histories.append(history)
+
+            # evaluate the model
+            self.msg_svc.DEBUG("DL :     + Evaluate the model: ")
+            test_steps  = self.loader.steps(self.batch_size,fold=ind,training=False)
+            predictions = self.model.evaluate_generator( self.loader.generator(self.batch_size,fold=ind,training=False,shuffle=False),
+                                                         steps=test_steps )
+            cvpredictions.append(predictions[1] * 100)
+            self.msg_svc.DEBUG("DL :       {0}: {1:.2f}%".format(self.model.metrics_names[1], predictions[1]*100))
+
+            # Evaluate training & test samples (predictions and labels in the same order)
+            train_predictions,train_labels = self.predict_streaming(ind,training=True)
+            self.train_predictions.append( train_predictions )
+            self.train_data['Y'].append( train_labels )
+
+            test_predictions,test_labels = self.predict_streaming(ind,training=False)
+            self.test_predictions.append( test_predictions )
+            self.test_data['Y'].append( test_labels )
+
+            # Make ROC curve from test sample
+            if self.dnn_method=='binary':
+                fpr,tpr,_ = roc_curve( test_labels, test_predictions )
+                self.fpr.append(fpr)
+                self.tpr.append(tpr)
+
+        self.msg_svc.INFO("DL :   Finished K-Fold cross-validation: ")
+        self.accuracy = {'mean':np.mean(cvpredictions),'std':np.std(cvpredictions)}
+        self.msg_svc.INFO("DL :   - Accuracy: {0:.2f}% (+/- {1:.2f}%)".format(np.mean(cvpredictions), np.std(cvpredictions)))
+
+        return
+
+
+    def predict_streaming(self,fold=None,training=False):
+        """Return the prediction and labels for one sample of the streamed data"""
+        predictions = []
+        labels      = []
+        for X,Y in self.loader.batches(self.batch_size,fold,training,shuffle=False):
+            predictions.append( self.model.predict_on_batch(X) )
+            labels.append( Y )
+
+        return np.concatenate(predictions),np.concatenate(labels)
+
+
     def predict(self,data=None):
         """Return the prediction from a test sample"""
         self.msg_svc.DEBUG("DL : Get the DNN prediction")
@@ -336,6 +539,12 @@ class DeepLearning(object):
         @param variables2plot    If there are extra variables to plot, 
                                  that aren't features of the NN, include them here
         """
+        self.variables2plot = variables2plot   # part of the plot-cache key (data_key)
+
+        if self.streaming:
+            self.load_hep_data_streaming(variables2plot)
+            return
+
         file = uproot.open(self.hep_data)
         data = file[self.treename]
         dataframe = data.pandas.df( self.features+['target']+variables2plot )
@@ -357,6 +566,49 @@ class DeepLearning(object):
         return
 
 
+    def load_hep_data_streaming(self,variables2plot=[]):
+        """
+        Setup the chunked access to the physics data (one or more files)
+        Only a subset of the events is kept in 'self.df' (for the diagnostic plots)
+        """
+        self.loader = StreamingData(self.hep_data,self.treename,self.features,'target')
+        self.loader.extra_branches = variables2plot
+        self.loader.chunk_size   = self.chunk_size
+        self.loader.buffer_size  = self.buffer_size
+        self.loader.kfold_splits = self.kfold_splits
+        self.loader.seed          = seed
+        self.loader.verbose_level = self.verbose_level
+        if self.dnn_method=='multi':
+            self.loader.target_transform = lambda y: to_categorical(y,self.output_dim)
+        self.loader.initialize()
+
+        file = uproot.open(self.loader.files[0])
+        self.metadata = file['metadata']   # names of samples, target values, etc.
+
+        self.df = self.loader.sample(self.nEventsPlot)
+
+        return
+
+
+    def data_key(self):
+        """
+        Identify the physics data without reading it -- used to cache plots
+        (files, sizes, modification times, TTree, and the branches that are read)
+        """
+        key = []
+        for filename in getFileList(self.hep_data):
+            try:
+                stat = os.stat(filename)
+                key.append( "{0}:{1}:{2}".format(filename,stat.st_size,int(stat.st_mtime)) )
+            except OSError:
+                return ''        # can't identify the file (e.g., remote); hash the DataFrame instead
+        key.append( "streaming:{0}:{1}".format(self.streaming,self.nEventsPlot) )
+        key.append( "tree:{0}".format(self.treename) )
+        key.append( "branches:{0}".format(','.join(self.features+['target']+self.variables2plot)) )
+
+        return ' '.join(key)
+
+
     def load_model(self,from_lwtnn=False):
         """Load existing model to make plots or predictions"""
         self.model = None
@@ -452,4 +704,61 @@ class DeepLearning(object):
         return
 
 
+
+## Parallel k-fold cross-validation
+class FoldHistory(object):
+    """Loss/metrics per epoch returned by a process (Keras History objects cannot be pickled)"""
+    def __init__(self,history={}):
+        self.history = history
+
+
+def _train_fold(job):
+    """
+    Train & evaluate a single k-fold in a separate process (CPU-only, limited threads)
+    -- CUDA_VISIBLE_DEVICES & OMP_NUM_THREADS are set by the parent before this interpreter starts
+    """
+    import tensorflow as tf
+    from keras import backend as K
+    K.clear_session()
+    np.random.seed(seed)
+    tf.set_random_seed(seed)
+    session_config = tf.ConfigProto(intra_op_parallelism_threads=job['threads'],
+                                    inter_op_parallelism_threads=1,
+                                    device_count={'GPU':0})
+    K.set_session( tf.Session(config=session_config) )
+
+    model = model_from_json(job['model'])
+    model.compile(**job['compile'])
+    model.set_weights(job['weights'])
+
+    callbacks_list = []
+    if job['callbacks']['earlystopping']:
+        callbacks_list = [EarlyStopping(**job['callbacks']['earlystopping'])]
+
+    X = np.load(job['features'],mmap_mode='r')
+    history = model.fit(X[job['train']],job['Y_train'],epochs=job['epochs'],
+                        callbacks=callbacks_list,batch_size=job['batch_size'],verbose=False)
+
+    result = {'fold':job['fold'],
+              'history':history.history,
+              'metrics_names':model.metrics_names,
+              'evaluate':model.evaluate(X[job['test']],job['Y_test'],verbose=False,batch_size=job['batch_size']),
+              'train_predictions':model.predict(X[job['train']]),
+              'test_predictions':model.predict(X[job['test']]),
+              'weights':model.get_weights()}
+
+    return result
+
+
+if __name__ == '__main__':
+    ## Train one k-fold: run by DeepLearning.train_model_parallel() in a fresh interpreter
+    with open(sys.argv[1],'rb') as f:
+        job = pickle.load(f)
+
+    result = _train_fold(job)
+
+    with open(job['result'],'wb') as f:
+        pickle.dump(result,f,protocol=pickle.HIGHEST_PROTOCOL)
+
+
 ## THE END ##
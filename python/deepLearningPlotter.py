@@ -15,13 +15,21 @@ with specific set of software installed
 
 Does not use ROOT!
 Instead, uses matplotlib to generate figures
+
+The data are first reduced to binned summaries (histograms, correlation matrices)
+that are cached on disk (keyed by a hash of the data & configuration),
+then the figures are made from the summaries (in a pool of processes if nWorkers>1).
+Re-making the plots (e.g., style changes) does not need another pass over the data.
 """
 import os
 import sys
 import json
 import util
+import hashlib
+import multiprocessing
 from datetime import date
 import numpy as np
+import pandas as pd
 
 import matplotlib
 import matplotlib.pyplot as plt
@@ -70,6 +78,12 @@ class DeepLearningPlotter(object):
 
         self.CMSlabelStatus = "Internal"
 
+        self.nWorkers  = 1       # processes used to make the figures
+        self.use_cache = True    # save/load binned summaries of the data
+        self.cache_dir = ''      # directory of the summaries (default: <output_dir>/.plotcache)
+        self.data_key  = ''      # identifies the data (e.g., files & modification times); hash of the DataFrame if empty
+        self._data_hash = None
+
 
     def initialize(self,dataframe,target_names=[],target_values=[]):
         """
@@ -78,6 +92,7 @@ class DeepLearningPlotter(object):
         @param dataframe    The dataframe that contains physics information for training/testing
         """
         self.df = dataframe
+        self._data_hash = None
 
         try:
             self.processlabel = self.sample_labels[self.filename].label   # process used in each plot
@@ -109,6 +124,69 @@ class DeepLearningPlotter(object):
         return
 
 
+    ## Cached summaries & parallel rendering
+    def cache_key(self,name,config,data=None):
+        """
+        Key for a summary: data + configuration of the summary
+        -- 'data_key' (e.g., input files & modification times) avoids reading the data to build the key
+        """
+        if data is None:
+            if not self.data_key and self._data_hash is None:
+                self._data_hash = hashData(self.df)
+            data = self.data_key or self._data_hash
+        else:
+            data = hashData(data)
+
+        text = json.dumps({'name':name,'data':data,'config':config},sort_keys=True)
+        return hashlib.md5(text.encode('utf-8')).hexdigest()
+
+
+    def cached(self,name,config,summarize,data=None):
+        """
+        Binned summary of the data needed for a set of plots
+        -- loaded from the cache if it exists, otherwise 'summarize()' is called & the result saved
+        """
+        if not self.use_cache:
+            return summarize()
+
+        cache_dir = self.cache_dir or self.output_dir+'/.plotcache'
+        filename  = "{0}/{1}_{2}.json".format(cache_dir,name,self.cache_key(name,config,data))
+
+        if os.path.isfile(filename):
+            self.msg_svc.DEBUG("DL : Loading {0} summary from {1}".format(name,filename))
+            with open(filename,'r') as f:
+                return json.load(f)
+
+        summary = summarize()
+
+        if not os.path.isdir(cache_dir): os.makedirs(cache_dir)
+        with open(filename+'.tmp','w') as f:
+            json.dump(summary,f)
+        os.rename(filename+'.tmp',filename)   # never leave a partial file in the cache
+
+        return summary
+
+
+    def render(self,function,tasks):
+        """Make one figure per task: 'function(*task)' -- in a pool of processes if nWorkers>1"""
+        nWorkers = min(self.nWorkers,len(tasks))
+        if nWorkers<2:
+            for task in tasks:
+                getattr(self,function)(*task)
+            return
+
+        global _plotter
+        _plotter = self          # shared with the processes through the fork (not pickled)
+        pool = multiprocessing.Pool(processes=nWorkers)
+        pool.map(_render,[(function,task) for task in tasks],chunksize=1)
+        pool.close()
+        pool.join()
+        _plotter = None
+
+        return
+
+
+    ## Plots
     def features(self):
         """
         Plot the features
@@ -119,113 +197,148 @@ class DeepLearningPlotter(object):
 
         target0 = self.targets[0]  # hard-coded for binary comparisons
         target1 = self.targets[1]
-        plt_features = self.df.keys()
-        for hi,feature in enumerate(plt_features):
+        plt_features = [i for i in self.df.keys() if i!='target']
 
-            if feature=='target': continue
+        def summarize():
+            summary = {}
+            for feature in plt_features:
+                binning = self.variable_labels[feature].binning
+                _,edges = np.histogram(np.concatenate([target0.df[feature],target1.df[feature]]),bins=binning)
+                summary[feature] = {'edges':edges.tolist(),
+                                    target0.name:np.histogram(target0.df[feature],bins=edges)[0].tolist(),
+                                    target1.name:np.histogram(target1.df[feature],bins=edges)[0].tolist()}
+            return summary
 
-            binning = self.variable_labels[feature].binning
+        config  = {'features':plt_features,'targets':[(t.name,t.target_value) for t in self.targets],
+                   'binning':[str(self.variable_labels[f].binning) for f in plt_features]}
+        summary = self.cached('features',config,summarize)
 
-            hist = HepPlotter("histogram",1)
+        self.render('plot_feature',[(feature,summary[feature]) for feature in plt_features])
 
-            hist.normed  = True
-            hist.stacked = False
-            hist.logplot = {"y":False,"x":False,"data":False}
-            hist.binning = binning
-            hist.x_label = self.variable_labels[feature].label
-            hist.y_label = "Events"
-            hist.format  = self.image_format
-            hist.saveAs  = self.output_dir+"/hist_"+feature+"_"+self.date
-            hist.ratio_plot  = True
-            hist.ratio_type  = 'ratio'
-            hist.y_ratio_label = '{0}/{1}'.format(target0.label,target1.label)
-            hist.CMSlabel    = 'top left'
-            hist.CMSlabelStatus   = self.CMSlabelStatus
-            hist.numLegendColumns = 1
+        return
 
-            # Add some extra text to the plot
-            if self.processlabel: hist.extra_text.Add(self.processlabel,coords=[0.03,0.80]) # physics process that produces these features
 
-            hist.initialize()
+    def plot_feature(self,feature,summary):
+        """Plot one feature for the targets (from the binned summary)"""
+        target0 = self.targets[0]  # hard-coded for binary comparisons
+        target1 = self.targets[1]
 
-            hist.Add(target0.df[feature], name=target0.name, draw='step',
-                     linecolor=target0.color, label=target0.label,
-                     ratio_num=True,ratio_den=False,ratio_partner=target1.name)
+        binning = np.array(summary['edges'])
+        centers = 0.5*(binning[:-1]+binning[1:])
+
+        hist = HepPlotter("histogram",1)
+
+        hist.normed  = True
+        hist.stacked = False
+        hist.logplot = {"y":False,"x":False,"data":False}
+        hist.binning = binning
+        hist.x_label = self.variable_labels[feature].label
+        hist.y_label = "Events"
+        hist.format  = self.image_format
+        hist.saveAs  = self.output_dir+"/hist_"+feature+"_"+self.date
+        hist.ratio_plot  = True
+        hist.ratio_type  = 'ratio'
+        hist.y_ratio_label = '{0}/{1}'.format(target0.label,target1.label)
+        hist.CMSlabel    = 'top left'
+        hist.CMSlabelStatus   = self.CMSlabelStatus
+        hist.numLegendColumns = 1
+
+        # Add some extra text to the plot
+        if self.processlabel: hist.extra_text.Add(self.processlabel,coords=[0.03,0.80]) # physics process that produces these features
+
+        hist.initialize()
+
+        # histograms are filled with the bin centers weighted by the counts
+        hist.Add(centers, weights=np.array(summary[target0.name]), name=target0.name, draw='step',
+                 linecolor=target0.color, label=target0.label,
+                 ratio_num=True,ratio_den=False,ratio_partner=target1.name)
+
+        hist.Add(centers, weights=np.array(summary[target1.name]), name=target1.name, draw='step',
+                 linecolor=target1.color, label=target1.label,
+                 ratio_num=False,ratio_den=True,ratio_partner=target0.name)
+
+        if self.classification=='binary':
+            widths = np.diff(binning)
+            t0 = density(summary[target0.name],widths)
+            t1 = density(summary[target1.name],widths)
+            separation = util.getSeparation(t0,t1)
+            hist.extra_text.Add("Separation = {0:.4f}".format(separation),coords=[0.03,0.73])
+
+        p = hist.execute()
+        hist.savefig()
 
-            hist.Add(target1.df[feature], name=target1.name, draw='step',
-                     linecolor=target1.color, label=target1.label,
-                     ratio_num=False,ratio_den=True,ratio_partner=target0.name)
+        return
 
-            if self.classification=='binary':
 
-                t0,_ = np.histogram(target0.df[feature],bins=binning,normed=True)
-                t1,_ = np.histogram(target1.df[feature],bins=binning,normed=True)
-                separation = util.getSeparation(t0,t1)
-                hist.extra_text.Add("Separation = {0:.4f}".format(separation),coords=[0.03,0.73])
+    def feature_correlations(self):
+        """Plot correlations between features of the NN"""
+        ## Correlation Matrices of Features (top/antitop) ##
+        def summarize():
+            summary = {}
+            for target in self.targets:
+                keys = [key for key in target.df.keys() if key!='target']
+                corrmat = target.df[keys].corr()
+                summary[target.name] = {'columns':keys,'values':corrmat.values.tolist()}
+            return summary
+
+        config  = {'targets':[(t.name,t.target_value) for t in self.targets]}
+        summary = self.cached('correlations',config,summarize)
 
-            p = hist.execute()
-            hist.savefig()
+        self.render('plot_correlations',[(target.name,summary[target.name]) for target in self.targets])
 
         return
 
 
-    def feature_correlations(self):
-        """Plot correlations between features of the NN"""
-        ## Correlation Matrices of Features (top/antitop) ##
+    def plot_correlations(self,name,summary):
+        """Plot the correlation matrix of one target (from the summary)"""
         fontProperties = {'family':'sans-serif'}
         opts = {'cmap': plt.get_cmap("bwr"), 'vmin': -1, 'vmax': +1}
 
-        for c,target in enumerate(self.targets):
+        target = [t for t in self.targets if t.name==name][0]
+        saveAs = "{0}/correlations_{1}_{2}".format(self.output_dir,target.name,self.date)
 
-            saveAs = "{0}/correlations_{1}_{2}".format(self.output_dir,target.name,self.date)
+        corrmat = pd.DataFrame(summary['values'],index=summary['columns'],columns=summary['columns'])
 
-            allkeys = target.df.keys()
-            keys = []
-            for key in allkeys:
-                if key!='target': keys.append(key)
-            t_ = target.df[keys]
-            corrmat = t_.corr()
+        # Save correlation matrix to CSV file
+        corrmat.to_csv("{0}.csv".format(saveAs))
 
-            # Save correlation matrix to CSV file
-            corrmat.to_csv("{0}.csv".format(saveAs))
-
-            # Use matplotlib directly
-            fig,ax = plt.subplots()
+        # Use matplotlib directly
+        fig,ax = plt.subplots()
 
-            heatmap1 = ax.pcolor(corrmat, **opts)
-            cbar     = plt.colorbar(heatmap1, ax=ax)
+        heatmap1 = ax.pcolor(corrmat, **opts)
+        cbar     = plt.colorbar(heatmap1, ax=ax)
 
-            cbar.ax.set_yticklabels( [i.get_text().strip('$') for i in cbar.ax.get_yticklabels()], **fontProperties )
+        cbar.ax.set_yticklabels( [i.get_text().strip('$') for i in cbar.ax.get_yticklabels()], **fontProperties )
 
-            labels = corrmat.columns.values
-            labels = [i.replace('_','\_') for i in labels]
-            # shift location of ticks to center of the bins
-            ax.set_xticks(np.arange(len(labels))+0.5, minor=False)
-            ax.set_yticks(np.arange(len(labels))+0.5, minor=False)
-            ax.set_xticklabels(labels, fontProperties, fontsize=18, minor=False, ha='right', rotation=70)
-            ax.set_yticklabels(labels, fontProperties, fontsize=18, minor=False)
+        labels = corrmat.columns.values
+        labels = [i.replace('_','\_') for i in labels]
+        # shift location of ticks to center of the bins
+        ax.set_xticks(np.arange(len(labels))+0.5, minor=False)
+        ax.set_yticks(np.arange(len(labels))+0.5, minor=False)
+        ax.set_xticklabels(labels, fontProperties, fontsize=18, minor=False, ha='right', rotation=70)
+        ax.set_yticklabels(labels, fontProperties, fontsize=18, minor=False)
 
-            ## CMS/COM Energy Label + Signal name
-            cms_stamp = hpl.CMSStamp(self.CMSlabelStatus)
-            cms_stamp.coords = [0.02,1.00]
-            cms_stamp.fontsize = 16
-            cms_stamp.va = 'bottom'
-            ax.text(0.02,1.00,cms_stamp.text,fontsize=cms_stamp.fontsize,
-                    ha=cms_stamp.ha,va=cms_stamp.va,transform=ax.transAxes)
+        ## CMS/COM Energy Label + Signal name
+        cms_stamp = hpl.CMSStamp(self.CMSlabelStatus)
+        cms_stamp.coords = [0.02,1.00]
+        cms_stamp.fontsize = 16
+        cms_stamp.va = 'bottom'
+        ax.text(0.02,1.00,cms_stamp.text,fontsize=cms_stamp.fontsize,
+                ha=cms_stamp.ha,va=cms_stamp.va,transform=ax.transAxes)
 
-            energy_stamp    = hpl.EnergyStamp()
-            energy_stamp.ha = 'right'
-            energy_stamp.coords = [0.99,1.00]
-            energy_stamp.fontsize = 16
-            energy_stamp.va = 'bottom'
-            ax.text(energy_stamp.coords[0],energy_stamp.coords[1],energy_stamp.text, 
-                    fontsize=energy_stamp.fontsize,ha=energy_stamp.ha, va=energy_stamp.va, transform=ax.transAxes)
+        energy_stamp    = hpl.EnergyStamp()
+        energy_stamp.ha = 'right'
+        energy_stamp.coords = [0.99,1.00]
+        energy_stamp.fontsize = 16
+        energy_stamp.va = 'bottom'
+        ax.text(energy_stamp.coords[0],energy_stamp.coords[1],energy_stamp.text, 
+                fontsize=energy_stamp.fontsize,ha=energy_stamp.ha, va=energy_stamp.va, transform=ax.transAxes)
 
-            ax.text(0.03,0.93,target.label,fontsize=16,ha='left',va='bottom',transform=ax.transAxes)
+        ax.text(0.03,0.93,target.label,fontsize=16,ha='left',va='bottom',transform=ax.transAxes)
 
-            plt.savefig("{0}.{1}".format(saveAs,self.image_format),
-                        format=self.image_format,dpi=300,bbox_inches='tight')
-            plt.close()
+        plt.savefig("{0}.{1}".format(saveAs,self.image_format),
+                    format=self.image_format,dpi=300,bbox_inches='tight')
+        plt.close()
 
         return
 
@@ -234,72 +347,86 @@ class DeepLearningPlotter(object):
         """Plot the training and testing predictions"""
         self.msg_svc.INFO("DL : Plotting DNN prediction. ")
 
+        binning = [bb/10. for bb in range(11)]
+
+        def summarize():
+            summary = []
+            for train,trainY,test,testY in zip(train_data['X'],train_data['Y'],test_data['X'],test_data['Y']):
+                fold = {}
+                for target in self.targets:
+                    fold[target.name+"_train"] = np.histogram(train[trainY==target.target_value],bins=binning)[0].tolist()
+                    fold[target.name+"_test"]  = np.histogram(test[testY==target.target_value],  bins=binning)[0].tolist()
+                summary.append(fold)
+            return summary
+
+        config  = {'binning':binning,'targets':[(t.name,t.target_value) for t in self.targets]}
+        data    = [np.concatenate([np.ravel(x) for x in train_data['X']+test_data['X']]),
+                   np.concatenate([np.ravel(y) for y in train_data['Y']+test_data['Y']])] if train_data['X'] else []
+        summary = self.cached('prediction',config,summarize,data=data)
+
         # Plot all k-fold cross-validation results
-        for i,(train,trainY,test,testY) in enumerate(zip(train_data['X'],train_data['Y'],test_data['X'],test_data['Y'])):
-
-            hist = HepPlotter("histogram",1)
-
-            hist.ratio_plot    = True
-            hist.ratio_type    = "ratio"
-            hist.y_ratio_label = "Test/Train"
-            hist.label_size    = 14
-            hist.normed  = True  # compare shape differences (likely don't have the same event yield)
-            hist.format  = self.image_format
-            hist.saveAs  = "{0}/hist_DNN_prediction_kfold{1}_{2}".format(self.output_dir,i,self.date)
-            hist.binning = [bb/10. for bb in range(11)]
-            hist.stacked = False
-            hist.logplot = {"y":False,"x":False,"data":False}
-            hist.x_label = "Prediction"
-            hist.y_label = "Arb. Units"
-            hist.CMSlabel = 'top left'
-            hist.CMSlabelStatus   = self.CMSlabelStatus
-            hist.numLegendColumns = 1
-
-            if self.processlabel: hist.extra_text.Add(self.processlabel,coords=[0.03,0.80],fontsize=14)
-
-            hist.initialize()
-
-            test_data  = []
-            train_data = []
-            json_data  = {}
-            for t,target in enumerate(self.targets):
-                ## Training
-                target_value = target.target_value
-                hist.Add(train[ trainY==target_value ], 
-                         name=target.name+'_train', linecolor=target.color,
-                         linewidth=2, draw='step', label=target.label+" Train",
-                         ratio_den=True,ratio_num=False,ratio_partner=target.name+'_test')
-                ## Testing
-                hist.Add(test[ testY==target_value ], 
-                         name=target.name+'_test', linecolor=target.color, color=target.color,
-                         linewidth=0, draw='stepfilled', label=target.label+" Test", alpha=0.5,
-                         ratio_den=False,ratio_num=True,ratio_partner=target.name+'_train')
-
-                ## Save data to JSON file
-                json_data[target.name+"_train"] = {}
-                json_data[target.name+"_test"]  = {}
-                d_tr,b_tr = np.histogram(train[trainY==target_value],bins=hist.binning)
-                d_te,b_te = np.histogram(test[testY==target_value],  bins=hist.binning)
-
-                json_data[target.name+"_train"]["binning"] = b_tr.tolist()
-                json_data[target.name+"_train"]["content"] = d_tr.tolist()
-                json_data[target.name+"_test"]["binning"] = b_te.tolist()
-                json_data[target.name+"_test"]["content"] = d_te.tolist()
-
-                test_data.append(d_te.tolist())
-                train_data.append(d_tr.tolist())
-
-            separation = util.getSeparation(test_data[0],test_data[1])
-            hist.extra_text.Add("Test Separation = {0:.4f}".format(separation),coords=[0.03,0.72])
-
-            p = hist.execute()
-            hist.savefig()
-
-            # save results to JSON file (just histogram values & bins) to re-make plots
-            with open("{0}.json".format(hist.saveAs), 'w') as outfile:
-                json.dump(json_data, outfile)
+        self.render('plot_prediction',[(i,binning,fold) for i,fold in enumerate(summary)])
+
+        return
 
 
+    def plot_prediction(self,i,binning,summary):
+        """Plot the training and testing predictions of one k-fold (from the binned summary)"""
+        binning = np.array(binning)
+        centers = 0.5*(binning[:-1]+binning[1:])
+
+        hist = HepPlotter("histogram",1)
+
+        hist.ratio_plot    = True
+        hist.ratio_type    = "ratio"
+        hist.y_ratio_label = "Test/Train"
+        hist.label_size    = 14
+        hist.normed  = True  # compare shape differences (likely don't have the same event yield)
+        hist.format  = self.image_format
+        hist.saveAs  = "{0}/hist_DNN_prediction_kfold{1}_{2}".format(self.output_dir,i,self.date)
+        hist.binning = binning.tolist()
+        hist.stacked = False
+        hist.logplot = {"y":False,"x":False,"data":False}
+        hist.x_label = "Prediction"
+        hist.y_label = "Arb. Units"
+        hist.CMSlabel = 'top left'
+        hist.CMSlabelStatus   = self.CMSlabelStatus
+        hist.numLegendColumns = 1
+
+        if self.processlabel: hist.extra_text.Add(self.processlabel,coords=[0.03,0.80],fontsize=14)
+
+        hist.initialize()
+
+        test_data  = []
+        json_data  = {}
+        for t,target in enumerate(self.targets):
+            ## Training
+            hist.Add(centers, weights=np.array(summary[target.name+'_train']),
+                     name=target.name+'_train', linecolor=target.color,
+                     linewidth=2, draw='step', label=target.label+" Train",
+                     ratio_den=True,ratio_num=False,ratio_partner=target.name+'_test')
+            ## Testing
+            hist.Add(centers, weights=np.array(summary[target.name+'_test']),
+                     name=target.name+'_test', linecolor=target.color, color=target.color,
+                     linewidth=0, draw='stepfilled', label=target.label+" Test", alpha=0.5,
+                     ratio_den=False,ratio_num=True,ratio_partner=target.name+'_train')
+
+            ## Save data to JSON file
+            for sample in ['_train','_test']:
+                json_data[target.name+sample] = {"binning":binning.tolist(),"content":summary[target.name+sample]}
+
+            test_data.append(summary[target.name+'_test'])
+
+        separation = util.getSeparation(test_data[0],test_data[1])
+        hist.extra_text.Add("Test Separation = {0:.4f}".format(separation),coords=[0.03,0.72])
+
+        p = hist.execute()
+        hist.savefig()
+
+        # save results to JSON file (just histogram values & bins) to re-make plots
+        with open("{0}.json".format(hist.saveAs), 'w') as outfile:
+            json.dump(json_data, outfile)
+
         return
 
 
@@ -435,5 +562,36 @@ class DeepLearningPlotter(object):
         keras_plot(model,to_file='{0}/{1}_model.eps'.format(self.output_dir,name),show_shapes=True)
         return
 
+
+## Helper functions
+_plotter = None     # plotter used by the processes in render(); set before forking
+
+
+def _render(job):
+    """Make one figure in a separate process"""
+    function,task = job
+    getattr(_plotter,function)(*task)
+    return
+
+
+def hashData(data):
+    """Hash of a DataFrame or a list of arrays"""
+    md5 = hashlib.md5()
+    if isinstance(data,pd.DataFrame):
+        md5.update( json.dumps([str(c) for c in data.columns]).encode('utf-8') )
+        md5.update( pd.util.hash_pandas_object(data,index=False).values.tobytes() )
+    else:
+        for d in data:
+            md5.update( np.ascontiguousarray(d).tobytes() )
+    return md5.hexdigest()
+
+
+def density(counts,widths):
+    """Normalized histogram (same as numpy.histogram(...,normed=True))"""
+    counts = np.array(counts,dtype=float)
+    total  = counts.sum()
+    return counts/(total*widths) if total>0 else counts
+
+
 ## THE END ##
 
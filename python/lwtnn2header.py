@@ -0,0 +1,359 @@
+#!/usr/bin/env python
+"""
+Created:        19 October 2026
+Last Updated:   19 October 2026
+
+agent
+agent@local
+-----
+
+Convert the lwtnn JSON file (from python/keras2json.py) of a dense network
+into a C++ header with the network compiled in:
+  - weights & biases as constexpr arrays (fixed sizes)
+  - input normalization and activations inlined
+  - double (compute) and float32 (computeFloat) versions
+  - int8 weights (computeInt8) if a calibration file from python/calibrateDNN.py is given
+The header defines 'CHEETAH_COMPILED_DNN' (and 'CHEETAH_COMPILED_DNN_INT8') and is
+used by deepLearning when the configuration option 'dnnBackend' is 'compiled', 'float', or 'int8'.
+
+The header records the path and a hash of the contents of the JSON file;
+deepLearning uses lwtnn instead if 'dnnFile' is not the same network.
+
+The header is written to the build directory ($CMSSW_BASE/tmp/$SCRAM_ARCH/cheetah/compiledDNNNetwork.h),
+where interface/compiledDNN.h includes it from; the tracked files are not modified.
+
+To run:
+$ python python/lwtnn2header.py config/keras_ttbar_DNN.json [--calibration calibration.json]
+  (re-compile after generating the header; 'touch interface/compiledDNN.h' the first time)
+"""
+import os
+import json
+import argparse
+
+
+# lwtnn activation name -> function in the header
+_activations = {
+    'linear':       None,
+    'rectified':    'rectified',
+    'relu':         'rectified',
+    'sigmoid':      'sigmoid',
+    'tanh':         'tanh',
+    'softmax':      'softmax',
+    'hard_sigmoid': 'hard_sigmoid',
+    'elu':          'elu',
+}
+
+
+class DenseLayer(object):
+    """Dense layer of the network (weights are None for an activation-only layer)"""
+    def __init__(self):
+        self.weights = None     # rows of weights: [nOut][nIn]
+        self.bias    = None
+        self.nIn     = 0
+        self.nOut    = 0
+        self.activation = None  # name of the function in the header
+        self.alpha      = 1.0   # elu parameter
+
+
+def activation(layer):
+    """Name of the activation function & its parameter (elu 'alpha')"""
+    act   = layer.get('activation','linear')
+    alpha = 1.0
+    if isinstance(act,dict):
+        alpha = act.get('alpha',1.0)
+        act   = act['function']
+    if act not in _activations:
+        raise ValueError("Activation '{0}' is not supported".format(act))
+    return _activations[act],alpha
+
+
+def layers(config):
+    """Dense layers of the lwtnn configuration (checks the sizes)"""
+    dense = []
+    nIn   = len(config['inputs'])
+    for l,layer in enumerate(config['layers']):
+        if layer.get('architecture','dense')!='dense':
+            raise ValueError("Layer {0} ('{1}') is not a dense layer".format(l,layer['architecture']))
+
+        d = DenseLayer()
+        d.nIn  = nIn
+        d.nOut = nIn
+        if layer['weights']:
+            d.bias = layer['bias']
+            d.nOut = len(d.bias)
+            if len(layer['weights'])!=d.nOut*nIn:
+                raise ValueError("Layer {0} has {1} weights; expected {2}x{3}".format(l,len(layer['weights']),d.nOut,nIn))
+            d.weights = [layer['weights'][o*nIn:(o+1)*nIn] for o in range(d.nOut)]
+        d.activation,d.alpha = activation(layer)
+
+        dense.append(d)
+        nIn = d.nOut
+
+    if nIn!=len(config['outputs']):
+        raise ValueError("Network has {0} outputs but {1} output names".format(nIn,len(config['outputs'])))
+
+    return dense
+
+
+def quantize(weights):
+    """Symmetric int8 quantization of each row of weights: w = q*scale"""
+    quantized = []
+    scales    = []
+    for row in weights:
+        wmax  = max(abs(w) for w in row)
+        scale = wmax/127. if wmax>0 else 1.
+        quantized.append( [int(round(w/scale)) for w in row] )
+        scales.append( scale )
+    return quantized,scales
+
+
+def inputScale(inputMax):
+    """Symmetric int8 scale for the inputs of a layer"""
+    return inputMax/127. if inputMax>0 else 1.
+
+
+def array(values):
+    """C++ initializer list (full precision)"""
+    return '{'+','.join(repr(float(v)) for v in values)+'}'
+
+
+def intArray(values):
+    """C++ initializer list of integers"""
+    return '{'+','.join(str(int(v)) for v in values)+'}'
+
+
+def matrix(rows,fmt=array):
+    """C++ initializer list of a 2D array"""
+    return '{\n        '+',\n        '.join(fmt(r) for r in rows)+'}'
+
+
+def body(network,nInputs,T,suffix,int8=False):
+    """Body of the compute function for one precision"""
+    text = """        {T} x0[{n}];
+        for (unsigned int i=0; i<nInputs; i++) x0[i] = ({T}(inputs[i])+inputOffsets{S}[i])*inputScales{S}[i];
+""".format(T=T,n=nInputs,S=suffix)
+
+    x = 0
+    for l,layer in enumerate(network):
+        if layer.weights is not None:
+            text += "\n        {0} x{1}[{2}];\n".format(T,x+1,layer.nOut)
+            if int8:
+                text += "        denseInt8(layer{0}_weights_q,layer{0}_bias_f,layer{0}_scales_q,layer{0}_inputScale_q,x{1},x{2});\n".format(l,x,x+1)
+            else:
+                text += "        dense(layer{0}_weights{1},layer{0}_bias{1},x{2},x{3});\n".format(l,suffix,x,x+1)
+            x += 1
+
+        if layer.activation=='elu':
+            text += "        elu(x{0},{1}({2}));\n".format(x,T,repr(float(layer.alpha)))
+        elif layer.activation is not None:
+            text += "        {0}(x{1});\n".format(layer.activation,x)
+
+    text += "\n        for (unsigned int i=0; i<nOutputs; i++) outputs[i] = x{0}[i];\n".format(x)
+
+    return text
+
+
+def contentHash(filename):
+    """64-bit FNV-1a hash of the file contents (same as cma::hashToStr(cma::hash(contents)) in C++)"""
+    h = 14695981039346656037
+    with open(filename,'rb') as f:
+        for c in bytearray(f.read()):
+            h ^= c
+            h  = (h*1099511628211) & 0xFFFFFFFFFFFFFFFF
+    return '{0:016x}'.format(h)
+
+
+def generate(config,source="",sourceHash="",calibration=None):
+    """Text of the header for the lwtnn JSON configuration (and int8 calibration)"""
+    inputs  = config['inputs']
+    outputs = config['outputs']
+    nInputs = len(inputs)
+    network = layers(config)
+    nDense  = sum(1 for l in network if l.weights is not None)
+
+    if calibration is not None and len(calibration['layers'])!=nDense:
+        raise ValueError("Calibration has {0} layers; the network has {1} dense layers".format(len(calibration['layers']),nDense))
+
+    header = """#ifndef COMPILEDDNNNETWORK_H
+#define COMPILEDDNNNETWORK_H
+
+/* Generated by python/lwtnn2header.py from {source} -- do not edit by hand */
+#define CHEETAH_COMPILED_DNN
+{int8define}
+#include <cmath>
+
+
+namespace compiledDNN {{
+
+    constexpr const char* sourceFile = "{source}";   // lwtnn JSON file of the network
+    constexpr const char* sourceHash = "{sourceHash}";   // hash of its contents (compared to 'dnnFile')
+
+    constexpr unsigned int nInputs  = {nInputs};
+    constexpr unsigned int nOutputs = {nOutputs};
+
+    constexpr const char* inputNames[nInputs]   = {{{inputNames}}};
+    constexpr const char* outputNames[nOutputs] = {{{outputNames}}};
+
+    // lwtnn normalization: (x+offset)*scale
+    constexpr double inputOffsets[nInputs] = {offsets};
+    constexpr double inputScales[nInputs]  = {scales};
+    constexpr float inputOffsets_f[nInputs] = {offsets};
+    constexpr float inputScales_f[nInputs]  = {scales};
+
+
+    // -- Layers
+    template<typename T,unsigned int nOut,unsigned int nIn>
+    inline void dense(const T (&weights)[nOut][nIn], const T (&bias)[nOut], const T (&in)[nIn], T (&out)[nOut]){{
+        for (unsigned int o=0; o<nOut; o++){{
+            T sum = bias[o];
+            for (unsigned int i=0; i<nIn; i++) sum += weights[o][i]*in[i];
+            out[o] = sum;
+        }}
+        return;
+    }}
+
+    template<unsigned int nOut,unsigned int nIn>
+    inline void denseInt8(const signed char (&weights)[nOut][nIn], const float (&bias)[nOut], const float (&scales)[nOut],
+                          const float inputScale, const float (&in)[nIn], float (&out)[nOut]){{
+        /* int8 weights & inputs (symmetric: x = q*scale), int32 sums */
+        int q[nIn];
+        for (unsigned int i=0; i<nIn; i++){{
+            float v = std::nearbyint(in[i]/inputScale);
+            q[i] = (v>127.f) ? 127 : (v<-127.f) ? -127 : int(v);
+        }}
+        for (unsigned int o=0; o<nOut; o++){{
+            int sum(0);
+            for (unsigned int i=0; i<nIn; i++) sum += weights[o][i]*q[i];
+            out[o] = sum*scales[o] + bias[o];
+        }}
+        return;
+    }}
+
+    template<typename T,unsigned int n>
+    inline void rectified(T (&x)[n]){{ for (auto& v : x) v = (v>0) ? v : T(0); return; }}
+
+    template<typename T,unsigned int n>
+    inline void sigmoid(T (&x)[n]){{ for (auto& v : x) v = T(1)/(T(1)+std::exp(-v)); return; }}
+
+    template<typename T,unsigned int n>
+    inline void tanh(T (&x)[n]){{ for (auto& v : x) v = std::tanh(v); return; }}
+
+    template<typename T,unsigned int n>
+    inline void hard_sigmoid(T (&x)[n]){{ for (auto& v : x) v = (v<T(-2.5)) ? T(0) : (v>T(2.5)) ? T(1) : T(0.2)*v+T(0.5); return; }}
+
+    template<typename T,unsigned int n>
+    inline void elu(T (&x)[n], const T alpha){{ for (auto& v : x) v = (v>0) ? v : alpha*(std::exp(v)-T(1)); return; }}
+
+    template<typename T,unsigned int n>
+    inline void softmax(T (&x)[n]){{
+        T max(x[0]);
+        for (const auto& v : x) max = (v>max) ? v : max;
+        T sum(0);
+        for (auto& v : x){{ v = std::exp(v-max); sum += v; }}
+        for (auto& v : x) v /= sum;
+        return;
+    }}
+
+
+    // -- Weights
+""".format(source=source,sourceHash=sourceHash,nInputs=nInputs,nOutputs=len(outputs),
+           int8define="#define CHEETAH_COMPILED_DNN_INT8\n" if calibration is not None else "",
+           inputNames=','.join('"{0}"'.format(i['name']) for i in inputs),
+           outputNames=','.join('"{0}"'.format(o) for o in outputs),
+           offsets=array(i['offset'] for i in inputs),
+           scales=array(i['scale'] for i in inputs))
+
+    c = 0
+    for l,layer in enumerate(network):
+        if layer.weights is None: continue
+        header += "    constexpr double layer{0}_weights[{1}][{2}] = {3};\n".format(l,layer.nOut,layer.nIn,matrix(layer.weights))
+        header += "    constexpr double layer{0}_bias[{1}] = {2};\n".format(l,layer.nOut,array(layer.bias))
+        header += "    constexpr float layer{0}_weights_f[{1}][{2}] = {3};\n".format(l,layer.nOut,layer.nIn,matrix(layer.weights))
+        header += "    constexpr float layer{0}_bias_f[{1}] = {2};\n".format(l,layer.nOut,array(layer.bias))
+
+        if calibration is not None:
+            # inputs of each dense layer quantized with the range found in the calibration sample
+            scale = inputScale( calibration['layers'][c]['input_max'] )
+            quantized,scales = quantize(layer.weights)
+            header += "    constexpr signed char layer{0}_weights_q[{1}][{2}] = {3};\n".format(l,layer.nOut,layer.nIn,matrix(quantized,intArray))
+            header += "    constexpr float layer{0}_scales_q[{1}] = {2};\n".format(l,layer.nOut,array(s*scale for s in scales))
+            header += "    constexpr float layer{0}_inputScale_q = {1};\n".format(l,repr(float(scale)))
+            c += 1
+
+        header += "\n"
+
+    header += """
+    // -- Networks
+    inline void compute(const double (&inputs)[nInputs], double (&outputs)[nOutputs]){{
+        /* Evaluate the network for one set of (un-normalized) inputs */
+{double}
+        return;
+    }}
+
+    inline void computeFloat(const double (&inputs)[nInputs], double (&outputs)[nOutputs]){{
+        /* Evaluate the network in single precision */
+{float}
+        return;
+    }}
+""".format(double=body(network,nInputs,'double',''),float=body(network,nInputs,'float','_f'))
+
+    if calibration is not None:
+        header += """
+    inline void computeInt8(const double (&inputs)[nInputs], double (&outputs)[nOutputs]){{
+        /* Evaluate the network with int8 weights (activations in single precision) */
+{int8}
+        return;
+    }}
+""".format(int8=body(network,nInputs,'float','_f',int8=True))
+
+    header += """}
+
+#endif
+"""
+
+    return header
+
+
+def buildHeader():
+    """Generated header in the build directory (on the include path of interface/compiledDNN.h)"""
+    if 'CMSSW_BASE' not in os.environ or 'SCRAM_ARCH' not in os.environ:
+        raise RuntimeError("No CMSSW environment (cmsenv); give the path of the header instead")
+    return os.path.join(os.environ['CMSSW_BASE'],'tmp',os.environ['SCRAM_ARCH'],'cheetah','compiledDNNNetwork.h')
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert lwtnn JSON (dense network) to a C++ header")
+    parser.add_argument('json_file',  help='lwtnn JSON file (from keras2json.py)')
+    parser.add_argument('header_file',nargs='?',default=None,
+                        help='output header (default: $CMSSW_BASE/tmp/$SCRAM_ARCH/cheetah/compiledDNNNetwork.h)')
+    parser.add_argument('--calibration',default=None,help='int8 calibration (from calibrateDNN.py)')
+    args = parser.parse_args()
+
+    with open(args.json_file,'r') as f:
+        config = json.load(f)
+
+    calibration = None
+    if args.calibration is not None:
+        with open(args.calibration,'r') as f:
+            calibration = json.load(f)
+
+    if args.header_file is None:
+        args.header_file = buildHeader()
+    if os.path.dirname(args.header_file) and not os.path.isdir(os.path.dirname(args.header_file)):
+        os.makedirs(os.path.dirname(args.header_file))
+
+    # full path: the unit test (test/testCompiledDNN.cxx) compares to lwtnn with this file
+    header = generate(config,source=os.path.abspath(args.json_file),sourceHash=contentHash(args.json_file),
+                      calibration=calibration)
+    with open(args.header_file,'w') as f:
+        f.write(header)
+
+    print(" Wrote {0}".format(args.header_file))
+
+    return
+
+
+if __name__ == '__main__':
+    main()
+
+## THE END ##
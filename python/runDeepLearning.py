@@ -105,6 +105,11 @@ dnn.batch_size = config.batch_size
 dnn.activations   = config.activation.split(',')
 dnn.kfold_splits  = config.kfold_splits
 dnn.nHiddenLayers = config.nHiddenLayers
+dnn.streaming     = config.streaming      # read hep_data (file, comma-separated files, or .txt list) in chunks
+dnn.chunk_size    = config.chunk_size
+dnn.buffer_size   = config.buffer_size
+dnn.nWorkers      = config.nWorkers       # train k-folds in parallel processes (CPU-only; not used when streaming)
+dnn.nThreads      = config.nThreads
 #dnn.earlystopping = {'monitor':'loss','min_delta':0.0001,'patience':5,'mode':'auto'}
 
 
@@ -16,6 +16,8 @@ This is also designed to submit one batch job at a time.
 To run:
 $ python python/submitBatchJobs.py batchConfig.txt
 where <batchConfig.txt> contains configuration options
+With 'backend local' the jobs run on this machine instead of condor
+(options 'nWorkers', 'memory' [GB per job], and 'retries' control the local executor).
 """
 import os
 import sys
@@ -43,6 +45,7 @@ cfg    = util.read_config(config)
 cfg['test']    = util.str2bool( cfg['test'] )
 cfg['submit']  = util.str2bool( cfg['submit'] )
 cfg['verbose'] = util.str2bool( cfg['verbose'] )
+backend        = cfg.get('backend','condor')
 
 # set 'global' options
 date      = time.strftime("%d%b%Y") if cfg['date']=='today' else cfg['date']
@@ -61,6 +64,12 @@ batch.verbose    = cfg['verbose']          # lots of print statements
 batch.config     = cfg['config']           # configuration file to use
 batch.file       = cfg['files']            # individual root files to process
 batch.batch_subdir = cfg['subdir']         # sub-directory for storing batch scripts
+batch.backend    = backend                 # 'condor' or 'local'
+
+## -- local executor (backend 'local')
+batch.executor.nWorkers = int( cfg.get('nWorkers','0') )      # <=0: number of CPUs
+batch.executor.memory   = float( cfg.get('memory','0') )      # expected memory per job [GB]
+batch.executor.retries  = int( cfg.get('retries','1') )       # re-submit failed jobs
 
 ## Setup output
 eos_path       = cfg['eos_path']+"/"+date  # '/store/user/demarley/'+date; separate jobs by date to minimize over-writing
@@ -82,13 +91,14 @@ batch.local_output_path = local_output_path          # where to store output
 eos_path_full = eos_path+"/"+local_output_path       # files saved in a directory named after the selection
                                                      # as defined in run.cxx/runML.cxx -- update if changed
 
-# create eos directory, if it doesn't exist
-os_err = commands.getoutput("eos root://cmseos.fnal.gov/ mkdir -p {0}".format(eos_path_full))
-if os_err:
-    print "RUNBATCH :: INFO : Attemp to make directory {0}".format(eos_path_full)
-    print "RUNBATCH :: INFO : Message = {0}".format(os_err)
-else:
-    print "RUNBATCH :: INFO : Created directory {0}".format(eos_path_full)
+# create eos directory, if it doesn't exist (local jobs keep the output in 'output_path' of the cmaConfig)
+if backend=='condor':
+    os_err = commands.getoutput("eos root://cmseos.fnal.gov/ mkdir -p {0}".format(eos_path_full))
+    if os_err:
+        print "RUNBATCH :: INFO : Attemp to make directory {0}".format(eos_path_full)
+        print "RUNBATCH :: INFO : Message = {0}".format(os_err)
+    else:
+        print "RUNBATCH :: INFO : Created directory {0}".format(eos_path_full)
 
 
 # define the directory to write the output
@@ -13,59 +13,120 @@ Contains all the objects (& structs) with event information
 */
 #include "Analysis/CyMiniAna/interface/Event.h"
 
+
+namespace {
+    int btagWkptIndex( const std::string& wkpt ){
+        /* Working point name ('L','M','T') to btag::wkpt (-1 if unknown) */
+        if (wkpt.compare("L")==0) return btag::L;
+        if (wkpt.compare("M")==0) return btag::M;
+        if (wkpt.compare("T")==0) return btag::T;
+        return -1;
+    }
+}
+
 // constructor
 Event::Event( TTreeReader &myReader, configuration &cmaConfig ) :
   m_config(&cmaConfig),
   m_ttree(myReader),
   m_treeName("SetMe"),
-  m_fileName("SetMe"){
+  m_fileName("SetMe"),
+  m_variation("nominal"),
+  m_duplicateFilter(nullptr),
+  m_dataset(0),
+  m_noDuplicate(nullptr),
+  m_lumiMask(nullptr),
+  m_lumiCertified(nullptr),
+  m_lastRun(0),
+  m_lastLumiblock(0){
     m_isMC     = m_config->isMC();
     m_treeName = m_ttree.GetTree()->GetName();       // for systematics
     m_fileName = m_config->filename();               // for accessing file metadata
 
     m_mapOfContainment     = m_config->mapOfPartonContainment(); // containment map for truth tops matched to jets
 
+    m_useTruth      = m_config->useTruth();
+    m_kinematicReco = m_config->kinematicReco();
     m_DNNinference  = m_config->DNNinference();            // use DNN to predict values
     m_DNNtraining   = m_config->DNNtraining();             // load DNN features (save/use later)
     m_getDNN        = (m_DNNinference || m_DNNtraining);   // CWoLa
 
+    // JER variations are evaluated on MC (reconstructed AK4, leptons, and MET are then needed)
+    m_jerVariations = false;
+    for (const auto& variation : m_config->systematics())
+        if (variation.compare("nominal")!=0) m_jerVariations = true;
+    m_jerDirection = 0;
+    m_ljetTarget   = -1;
+
     // b-tagging working points
-    m_CSVv2L = m_config->CSVv2L();
-    m_CSVv2M = m_config->CSVv2M();
-    m_CSVv2T = m_config->CSVv2T();
+    m_btag_thresholds[btag::index(btag::CSVv2,btag::L)] = m_config->CSVv2L();
+    m_btag_thresholds[btag::index(btag::CSVv2,btag::M)] = m_config->CSVv2M();
+    m_btag_thresholds[btag::index(btag::CSVv2,btag::T)] = m_config->CSVv2T();
+    m_btag_thresholds[btag::index(btag::DeepCSV,btag::L)] = m_config->DeepCSVL();
+    m_btag_thresholds[btag::index(btag::DeepCSV,btag::M)] = m_config->DeepCSVM();
+    m_btag_thresholds[btag::index(btag::DeepCSV,btag::T)] = m_config->DeepCSVT();
+
+    m_btagWkpt = static_cast<btag::wkpt>( btagWkptIndex(m_config->jet_btagWkpt()) );  // checked in configuration
+    m_btag_jets.resize( btag::nTaggers*btag::nWkpts );
+    clearBtagging();
 
 
     //** Access branches from Tree **//
-    m_eventNumber  = new TTreeReaderValue<unsigned long long>(m_ttree,"eventNumber");
-    m_runNumber    = new TTreeReaderValue<unsigned int>(m_ttree,"runNumber");
-    m_lumiblock    = new TTreeReaderValue<unsigned int>(m_ttree,"lumiblock");
+    m_eventNumber.reset(  new TTreeReaderValue<unsigned long long>(m_ttree,"eventNumber") );
+    m_runNumber.reset(    new TTreeReaderValue<unsigned int>(m_ttree,"runNumber") );
+    m_lumiblock.reset(    new TTreeReaderValue<unsigned int>(m_ttree,"lumiblock") );
 
-    m_npv = new TTreeReaderValue<unsigned int>(m_ttree,"npv");
-    m_rho = new TTreeReaderValue<float>(m_ttree,"rho");
-    m_true_pileup = new TTreeReaderValue<unsigned int>(m_ttree,"true_pileup");
+    m_npv.reset( new TTreeReaderValue<unsigned int>(m_ttree,"npv") );
+    m_rho.reset( new TTreeReaderValue<float>(m_ttree,"rho") );
+    m_true_pileup.reset( new TTreeReaderValue<unsigned int>(m_ttree,"true_pileup") );
 
     /** Triggers **/
-    m_HLT_Ele45_CaloIdVT_GsfTrkIdT_PFJet200_PFJet50 = new TTreeReaderValue<unsigned int>(m_ttree,"HLT_Ele45_CaloIdVT_GsfTrkIdT_PFJet200_PFJet50");
-    m_HLT_Ele50_CaloIdVT_GsfTrkIdT_PFJet165 = new TTreeReaderValue<unsigned int>(m_ttree,"HLT_Ele50_CaloIdVT_GsfTrkIdT_PFJet165");
-    m_HLT_Ele115_CaloIdVT_GsfTrkIdT    = new TTreeReaderValue<unsigned int>(m_ttree,"HLT_Ele115_CaloIdVT_GsfTrkIdT");
-    m_HLT_Mu40_Eta2P1_PFJet200_PFJet50 = new TTreeReaderValue<unsigned int>(m_ttree,"HLT_Mu40_Eta2P1_PFJet200_PFJet50");
-    m_HLT_Mu50    = new TTreeReaderValue<unsigned int>(m_ttree,"HLT_Mu50");
-    m_HLT_TkMu50  = new TTreeReaderValue<unsigned int>(m_ttree,"HLT_TkMu50");
-    m_HLT_PFHT800 = new TTreeReaderValue<unsigned int>(m_ttree,"HLT_PFHT800");
-    m_HLT_PFHT900 = new TTreeReaderValue<unsigned int>(m_ttree,"HLT_PFHT900");
-    m_HLT_AK8PFJet450 = new TTreeReaderValue<unsigned int>(m_ttree,"HLT_AK8PFJet450");
-    m_HLT_PFHT700TrimMass50  = new TTreeReaderValue<unsigned int>(m_ttree,"HLT_PFHT700TrimMass50");
-    m_HLT_PFJet360TrimMass30 = new TTreeReaderValue<unsigned int>(m_ttree,"HLT_PFJet360TrimMass30");
-    //m_HLT_Ele45_WPLoose_Gsf = new TTreeReaderValue<int>(m_ttree,"HLT_Ele45_WPLoose_Gsf");
-    //m_HLT_TkMu50 = new TTreeReaderValue<int>(m_ttree,"HLT_TkMu50");
+    m_HLT_Ele45_CaloIdVT_GsfTrkIdT_PFJet200_PFJet50.reset( new TTreeReaderValue<unsigned int>(m_ttree,"HLT_Ele45_CaloIdVT_GsfTrkIdT_PFJet200_PFJet50") );
+    m_HLT_Ele50_CaloIdVT_GsfTrkIdT_PFJet165.reset( new TTreeReaderValue<unsigned int>(m_ttree,"HLT_Ele50_CaloIdVT_GsfTrkIdT_PFJet165") );
+    m_HLT_Ele115_CaloIdVT_GsfTrkIdT.reset(    new TTreeReaderValue<unsigned int>(m_ttree,"HLT_Ele115_CaloIdVT_GsfTrkIdT") );
+    m_HLT_Mu40_Eta2P1_PFJet200_PFJet50.reset( new TTreeReaderValue<unsigned int>(m_ttree,"HLT_Mu40_Eta2P1_PFJet200_PFJet50") );
+    m_HLT_Mu50.reset(    new TTreeReaderValue<unsigned int>(m_ttree,"HLT_Mu50") );
+    m_HLT_TkMu50.reset(  new TTreeReaderValue<unsigned int>(m_ttree,"HLT_TkMu50") );
+    m_HLT_PFHT800.reset( new TTreeReaderValue<unsigned int>(m_ttree,"HLT_PFHT800") );
+    m_HLT_PFHT900.reset( new TTreeReaderValue<unsigned int>(m_ttree,"HLT_PFHT900") );
+    m_HLT_AK8PFJet450.reset( new TTreeReaderValue<unsigned int>(m_ttree,"HLT_AK8PFJet450") );
+    m_HLT_PFHT700TrimMass50.reset(  new TTreeReaderValue<unsigned int>(m_ttree,"HLT_PFHT700TrimMass50") );
+    m_HLT_PFJet360TrimMass30.reset( new TTreeReaderValue<unsigned int>(m_ttree,"HLT_PFJet360TrimMass30") );
+    //m_HLT_Ele45_WPLoose_Gsf.reset( new TTreeReaderValue<int>(m_ttree,"HLT_Ele45_WPLoose_Gsf") );
+    //m_HLT_TkMu50.reset( new TTreeReaderValue<int>(m_ttree,"HLT_TkMu50") );
 
     /** Filters **/
-    m_Flag_goodVertices  = new TTreeReaderValue<unsigned int>(m_ttree,"Flag_goodVertices");
-    m_Flag_eeBadScFilter = new TTreeReaderValue<unsigned int>(m_ttree,"Flag_eeBadScFilter");
-    m_Flag_HBHENoiseFilter    = new TTreeReaderValue<unsigned int>(m_ttree,"Flag_HBHENoiseFilter");
-    m_Flag_HBHENoiseIsoFilter = new TTreeReaderValue<unsigned int>(m_ttree,"Flag_HBHENoiseIsoFilter");
-    m_Flag_globalTightHalo2016Filter = new TTreeReaderValue<unsigned int>(m_ttree,"Flag_globalTightHalo2016Filter");
-    m_Flag_EcalDeadCellTriggerPrimitiveFilter = new TTreeReaderValue<unsigned int>(m_ttree,"Flag_EcalDeadCellTriggerPrimitiveFilter");
+    m_Flag_goodVertices.reset(  new TTreeReaderValue<unsigned int>(m_ttree,"Flag_goodVertices") );
+    m_Flag_eeBadScFilter.reset( new TTreeReaderValue<unsigned int>(m_ttree,"Flag_eeBadScFilter") );
+    m_Flag_HBHENoiseFilter.reset(    new TTreeReaderValue<unsigned int>(m_ttree,"Flag_HBHENoiseFilter") );
+    m_Flag_HBHENoiseIsoFilter.reset( new TTreeReaderValue<unsigned int>(m_ttree,"Flag_HBHENoiseIsoFilter") );
+    m_Flag_globalTightHalo2016Filter.reset( new TTreeReaderValue<unsigned int>(m_ttree,"Flag_globalTightHalo2016Filter") );
+    m_Flag_EcalDeadCellTriggerPrimitiveFilter.reset( new TTreeReaderValue<unsigned int>(m_ttree,"Flag_EcalDeadCellTriggerPrimitiveFilter") );
+
+    // Connect the trigger & filter maps to the branches (the maps are not rebuilt for each event)
+    std::vector<std::pair<std::string,TTreeReaderValue<unsigned int>*> > filters = {
+        {"goodVertices",  m_Flag_goodVertices.get()},
+        {"eeBadScFilter", m_Flag_eeBadScFilter.get()},
+        {"HBHENoiseFilter",    m_Flag_HBHENoiseFilter.get()},
+        {"HBHENoiseIsoFilter", m_Flag_HBHENoiseIsoFilter.get()},
+        {"globalTightHalo2016Filter", m_Flag_globalTightHalo2016Filter.get()},
+        {"EcalDeadCellTriggerPrimitiveFilter", m_Flag_EcalDeadCellTriggerPrimitiveFilter.get()} };
+    for (const auto& filter : filters)
+        m_filterValues.push_back( std::make_pair(&m_filters[filter.first], filter.second) );
+
+    std::vector<std::pair<std::string,TTreeReaderValue<unsigned int>*> > triggers = {
+        {"HLT_Ele45_CaloIdVT_GsfTrkIdT_PFJet200_PFJet50", m_HLT_Ele45_CaloIdVT_GsfTrkIdT_PFJet200_PFJet50.get()},
+        {"HLT_Ele50_CaloIdVT_GsfTrkIdT_PFJet165", m_HLT_Ele50_CaloIdVT_GsfTrkIdT_PFJet165.get()},
+        {"HLT_Ele115_CaloIdVT_GsfTrkIdT",    m_HLT_Ele115_CaloIdVT_GsfTrkIdT.get()},
+        {"HLT_Mu40_Eta2P1_PFJet200_PFJet50", m_HLT_Mu40_Eta2P1_PFJet200_PFJet50.get()},
+        {"HLT_Mu50",    m_HLT_Mu50.get()},
+        {"HLT_TkMu50",  m_HLT_TkMu50.get()},
+        {"HLT_PFHT800", m_HLT_PFHT800.get()},
+        {"HLT_PFHT900", m_HLT_PFHT900.get()},
+        {"HLT_AK8PFJet450", m_HLT_AK8PFJet450.get()},
+        {"HLT_PFHT700TrimMass50",  m_HLT_PFHT700TrimMass50.get()},
+        {"HLT_PFJet360TrimMass30", m_HLT_PFJet360TrimMass30.get()} };
+    for (const auto& trigger : triggers)
+        m_triggerValues.push_back( std::make_pair(&m_triggers[trigger.first], trigger.second) );
 
 
     // If 'isMC' -> prepare training with truth-matched AK8 jets
@@ -73,141 +134,302 @@ Event::Event( TTreeReader &myReader, configuration &cmaConfig ) :
     // both scenarios require reco AK8 info
 
     // large-R Jet information
-    m_ljet_pt     = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8pt");
-    m_ljet_eta    = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8eta");
-    m_ljet_phi    = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8phi");
-    m_ljet_m      = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8mass");
-    m_ljet_SDmass = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8SDmass");
-    m_ljet_tau1   = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8tau1");
-    m_ljet_tau2   = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8tau2");
-    m_ljet_tau3   = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8tau3");
-    m_ljet_area   = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8area");
-    m_ljet_charge = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8charge");
-    m_ljet_chargeSD = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8chargeSD");
-    m_ljet_charge3  = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8charge3");
-    m_ljet_charge10 = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8charge10");
-    m_ljet_subjet0_bdisc    = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet0bDisc");
-    m_ljet_subjet0_deepCSV  = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet0deepCSV");
-    m_ljet_subjet0_charge   = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet0charge");
-    m_ljet_subjet0_charge3  = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet0charge3");
-    m_ljet_subjet0_charge10 = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet0charge10");
-    m_ljet_subjet0_pt   = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet0pt");
-    m_ljet_subjet0_mass = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet0mass");
-    m_ljet_subjet0_tau1 = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet0tau1");
-    m_ljet_subjet0_tau2 = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet0tau2");
-    m_ljet_subjet0_tau3 = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet0tau3");
-    m_ljet_subjet1_bdisc    = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet1bDisc");
-    m_ljet_subjet1_deepCSV  = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet1deepCSV");
-    m_ljet_subjet1_charge   = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet1charge");
-    m_ljet_subjet1_charge3  = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet1charge3");
-    m_ljet_subjet1_charge10 = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet1charge10");
-    m_ljet_subjet1_pt   = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet1pt");
-    m_ljet_subjet1_mass = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet1mass");
-    m_ljet_subjet1_tau1 = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet1tau1");
-    m_ljet_subjet1_tau2 = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet1tau2");
-    m_ljet_subjet1_tau3 = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet1tau3");
-    m_ljet_BEST_class = new TTreeReaderValue<std::vector<int>>(m_ttree,"AK8BEST_class");
-    m_ljet_BEST_t = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8BEST_t");
-    m_ljet_BEST_w = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8BEST_w");
-    m_ljet_BEST_z = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8BEST_z");
-    m_ljet_BEST_h = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8BEST_h");
-    m_ljet_BEST_j = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8BEST_j");
-    m_ljet_uncorrPt = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8uncorrPt");
-    m_ljet_uncorrE  = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8uncorrE");
-    m_ljet_jerSF    = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8jerSF");
-    m_ljet_jerSF_UP = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8jerSF_UP");
-    m_ljet_jerSF_DOWN = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8jerSF_DOWN");
+    m_ljet_pt.reset(     new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8pt") );
+    m_ljet_eta.reset(    new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8eta") );
+    m_ljet_phi.reset(    new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8phi") );
+    m_ljet_m.reset(      new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8mass") );
+    m_ljet_SDmass.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8SDmass") );
+    m_ljet_tau1.reset(   new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8tau1") );
+    m_ljet_tau2.reset(   new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8tau2") );
+    m_ljet_tau3.reset(   new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8tau3") );
+    m_ljet_area.reset(   new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8area") );
+    m_ljet_charge.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8charge") );
+    m_ljet_chargeSD.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8chargeSD") );
+    m_ljet_charge3.reset(  new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8charge3") );
+    m_ljet_charge10.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8charge10") );
+    m_ljet_subjet0_bdisc.reset(    new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet0bDisc") );
+    m_ljet_subjet0_deepCSV.reset(  new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet0deepCSV") );
+    m_ljet_subjet0_charge.reset(   new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet0charge") );
+    m_ljet_subjet0_charge3.reset(  new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet0charge3") );
+    m_ljet_subjet0_charge10.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet0charge10") );
+    m_ljet_subjet0_pt.reset(   new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet0pt") );
+    m_ljet_subjet0_mass.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet0mass") );
+    m_ljet_subjet0_tau1.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet0tau1") );
+    m_ljet_subjet0_tau2.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet0tau2") );
+    m_ljet_subjet0_tau3.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet0tau3") );
+    m_ljet_subjet1_bdisc.reset(    new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet1bDisc") );
+    m_ljet_subjet1_deepCSV.reset(  new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet1deepCSV") );
+    m_ljet_subjet1_charge.reset(   new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet1charge") );
+    m_ljet_subjet1_charge3.reset(  new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet1charge3") );
+    m_ljet_subjet1_charge10.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet1charge10") );
+    m_ljet_subjet1_pt.reset(   new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet1pt") );
+    m_ljet_subjet1_mass.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet1mass") );
+    m_ljet_subjet1_tau1.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet1tau1") );
+    m_ljet_subjet1_tau2.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet1tau2") );
+    m_ljet_subjet1_tau3.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8subjet1tau3") );
+    m_ljet_BEST_class.reset( new TTreeReaderValue<std::vector<int>>(m_ttree,"AK8BEST_class") );
+    m_ljet_BEST_t.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8BEST_t") );
+    m_ljet_BEST_w.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8BEST_w") );
+    m_ljet_BEST_z.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8BEST_z") );
+    m_ljet_BEST_h.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8BEST_h") );
+    m_ljet_BEST_j.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8BEST_j") );
+    m_ljet_uncorrPt.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8uncorrPt") );
+    m_ljet_uncorrE.reset(  new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8uncorrE") );
+
+    initialize_readers();   // data or MC branches
 
-    if (!m_isMC){
+    // Truth matching tool
+    m_truthMatchingTool.reset( new truthMatching(cmaConfig) );
+    m_truthMatchingTool->initialize();
+
+    // DNN material (the network is only parsed once per job)
+    m_cheetahTool.reset( new deepLearning(cmaConfig) );
+
+    // Kinematic reconstruction algorithms
+    m_ttbarRecoTool.reset(    new ttbarReco(cmaConfig) );
+    m_neutrinoRecoTool.reset( new neutrinoReco(cmaConfig) );
+
+    setBuilder();
+} // end constructor
+
+
+Event::~Event() {}
+
+
+void Event::initialize_readers(){
+    /* Readers of the branches that only exist in data or in MC
+       - reconstructed AK4, leptons, and MET: data, and MC when JER variations are evaluated
+       - the readers that are not needed are released
+    */
+    if (!m_isMC || m_jerVariations){
       /** JETS **/
       // small-R jet information
-      m_jet_pt  = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK4pt");
-      m_jet_eta = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK4eta");
-      m_jet_phi = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK4phi");
-      m_jet_m   = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK4mass");
-      m_jet_bdisc    = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK4bDisc");
-      m_jet_deepCSV  = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK4deepCSV");
-      m_jet_area     = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK4area");
-      m_jet_uncorrPt = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK4uncorrPt");
-      m_jet_uncorrE  = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK4uncorrE");
-      m_jet_jerSF    = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK4jerSF");
-      m_jet_jerSF_UP = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK4jerSF_UP");
-      m_jet_jerSF_DOWN = new TTreeReaderValue<std::vector<float>>(m_ttree,"AK4jerSF_DOWN");
+      m_jet_pt.reset(  new TTreeReaderValue<std::vector<float>>(m_ttree,"AK4pt") );
+      m_jet_eta.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK4eta") );
+      m_jet_phi.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK4phi") );
+      m_jet_m.reset(   new TTreeReaderValue<std::vector<float>>(m_ttree,"AK4mass") );
+      m_jet_bdisc.reset(    new TTreeReaderValue<std::vector<float>>(m_ttree,"AK4bDisc") );
+      m_jet_deepCSV.reset(  new TTreeReaderValue<std::vector<float>>(m_ttree,"AK4deepCSV") );
+      m_jet_area.reset(     new TTreeReaderValue<std::vector<float>>(m_ttree,"AK4area") );
+      m_jet_uncorrPt.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK4uncorrPt") );
+      m_jet_uncorrE.reset(  new TTreeReaderValue<std::vector<float>>(m_ttree,"AK4uncorrE") );
+      m_jet_jerSF.reset(    new TTreeReaderValue<std::vector<float>>(m_ttree,"AK4jerSF") );
+      m_jet_jerSF_UP.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK4jerSF_UP") );
+      m_jet_jerSF_DOWN.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK4jerSF_DOWN") );
 
       /** LEPTONS **/
-      m_el_pt  = new TTreeReaderValue<std::vector<float>>(m_ttree,"ELpt");
-      m_el_eta = new TTreeReaderValue<std::vector<float>>(m_ttree,"ELeta");
-      m_el_phi = new TTreeReaderValue<std::vector<float>>(m_ttree,"ELphi");
-      m_el_e   = new TTreeReaderValue<std::vector<float>>(m_ttree,"ELenergy");
-      m_el_charge = new TTreeReaderValue<std::vector<float>>(m_ttree,"ELcharge");
-      m_el_id_loose  = new TTreeReaderValue<std::vector<unsigned int>>(m_ttree,"ELlooseID");
-      m_el_id_medium = new TTreeReaderValue<std::vector<unsigned int>>(m_ttree,"ELmediumID");
-      m_el_id_tight  = new TTreeReaderValue<std::vector<unsigned int>>(m_ttree,"ELtightID");
-      m_el_id_loose_noIso  = new TTreeReaderValue<std::vector<unsigned int>>(m_ttree,"ELlooseIDnoIso");
-      m_el_id_medium_noIso = new TTreeReaderValue<std::vector<unsigned int>>(m_ttree,"ELmediumIDnoIso");
-      m_el_id_tight_noIso  = new TTreeReaderValue<std::vector<unsigned int>>(m_ttree,"ELtightIDnoIso");
-
-      m_mu_pt  = new TTreeReaderValue<std::vector<float>>(m_ttree,"MUpt");
-      m_mu_eta = new TTreeReaderValue<std::vector<float>>(m_ttree,"MUeta");
-      m_mu_phi = new TTreeReaderValue<std::vector<float>>(m_ttree,"MUphi");
-      m_mu_e   = new TTreeReaderValue<std::vector<float>>(m_ttree,"MUenergy");
-      m_mu_charge = new TTreeReaderValue<std::vector<float>>(m_ttree,"MUcharge");
-      m_mu_iso = new TTreeReaderValue<std::vector<float>>(m_ttree,"MUcorrIso");
-      m_mu_id_loose  = new TTreeReaderValue<std::vector<unsigned int>>(m_ttree,"MUlooseID");
-      m_mu_id_medium = new TTreeReaderValue<std::vector<unsigned int>>(m_ttree,"MUmediumID");
-      m_mu_id_tight  = new TTreeReaderValue<std::vector<unsigned int>>(m_ttree,"MUtightID");
-
-      m_met_met  = new TTreeReaderValue<float>(m_ttree,"METpt");
-      m_met_phi  = new TTreeReaderValue<float>(m_ttree,"METphi");
-
-      m_HTAK8    = new TTreeReaderValue<float>(m_ttree,"HTak8");
-      m_HTAK4    = new TTreeReaderValue<float>(m_ttree,"HTak4");
+      m_el_pt.reset(  new TTreeReaderValue<std::vector<float>>(m_ttree,"ELpt") );
+      m_el_eta.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"ELeta") );
+      m_el_phi.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"ELphi") );
+      m_el_e.reset(   new TTreeReaderValue<std::vector<float>>(m_ttree,"ELenergy") );
+      m_el_charge.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"ELcharge") );
+      m_el_id_loose.reset(  new TTreeReaderValue<std::vector<unsigned int>>(m_ttree,"ELlooseID") );
+      m_el_id_medium.reset( new TTreeReaderValue<std::vector<unsigned int>>(m_ttree,"ELmediumID") );
+      m_el_id_tight.reset(  new TTreeReaderValue<std::vector<unsigned int>>(m_ttree,"ELtightID") );
+      m_el_id_loose_noIso.reset(  new TTreeReaderValue<std::vector<unsigned int>>(m_ttree,"ELlooseIDnoIso") );
+      m_el_id_medium_noIso.reset( new TTreeReaderValue<std::vector<unsigned int>>(m_ttree,"ELmediumIDnoIso") );
+      m_el_id_tight_noIso.reset(  new TTreeReaderValue<std::vector<unsigned int>>(m_ttree,"ELtightIDnoIso") );
+
+      m_mu_pt.reset(  new TTreeReaderValue<std::vector<float>>(m_ttree,"MUpt") );
+      m_mu_eta.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"MUeta") );
+      m_mu_phi.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"MUphi") );
+      m_mu_e.reset(   new TTreeReaderValue<std::vector<float>>(m_ttree,"MUenergy") );
+      m_mu_charge.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"MUcharge") );
+      m_mu_iso.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"MUcorrIso") );
+      m_mu_id_loose.reset(  new TTreeReaderValue<std::vector<unsigned int>>(m_ttree,"MUlooseID") );
+      m_mu_id_medium.reset( new TTreeReaderValue<std::vector<unsigned int>>(m_ttree,"MUmediumID") );
+      m_mu_id_tight.reset(  new TTreeReaderValue<std::vector<unsigned int>>(m_ttree,"MUtightID") );
+
+      m_met_met.reset(  new TTreeReaderValue<float>(m_ttree,"METpt") );
+      m_met_phi.reset(  new TTreeReaderValue<float>(m_ttree,"METphi") );
+
+      m_HTAK8.reset(    new TTreeReaderValue<float>(m_ttree,"HTak8") );
+      m_HTAK4.reset(    new TTreeReaderValue<float>(m_ttree,"HTak4") );
+    }
+    else{
+      m_jet_pt.reset();
+      m_jet_eta.reset();
+      m_jet_phi.reset();
+      m_jet_m.reset();
+      m_jet_bdisc.reset();
+      m_jet_deepCSV.reset();
+      m_jet_area.reset();
+      m_jet_uncorrPt.reset();
+      m_jet_uncorrE.reset();
+      m_jet_jerSF.reset();
+      m_jet_jerSF_UP.reset();
+      m_jet_jerSF_DOWN.reset();
+      m_el_pt.reset();
+      m_el_eta.reset();
+      m_el_phi.reset();
+      m_el_e.reset();
+      m_el_charge.reset();
+      m_el_id_loose.reset();
+      m_el_id_medium.reset();
+      m_el_id_tight.reset();
+      m_el_id_loose_noIso.reset();
+      m_el_id_medium_noIso.reset();
+      m_el_id_tight_noIso.reset();
+      m_mu_pt.reset();
+      m_mu_eta.reset();
+      m_mu_phi.reset();
+      m_mu_e.reset();
+      m_mu_charge.reset();
+      m_mu_iso.reset();
+      m_mu_id_loose.reset();
+      m_mu_id_medium.reset();
+      m_mu_id_tight.reset();
+      m_met_met.reset();
+      m_met_phi.reset();
+      m_HTAK8.reset();
+      m_HTAK4.reset();
+    }
+
+    if (!m_isMC){
+      m_mc_pt.reset();
+      m_mc_eta.reset();
+      m_mc_phi.reset();
+      m_mc_e.reset();
+      m_mc_pdgId.reset();
+      m_mc_status.reset();
+      m_mc_parent_idx.reset();
+      m_mc_child0_idx.reset();
+      m_mc_child1_idx.reset();
+      m_mc_isHadTop.reset();
+      m_ljet_jerSF.reset();
+      m_ljet_jerSF_UP.reset();
+      m_ljet_jerSF_DOWN.reset();
     }
     else{
+      // AK8 JER scale factors (no smearing in data)
+      m_ljet_jerSF.reset(    new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8jerSF") );
+      m_ljet_jerSF_UP.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8jerSF_UP") );
+      m_ljet_jerSF_DOWN.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"AK8jerSF_DOWN") );
+
       // MC information
-      m_mc_pt  = new TTreeReaderValue<std::vector<float>>(m_ttree,"GENpt");
-      m_mc_eta = new TTreeReaderValue<std::vector<float>>(m_ttree,"GENeta");
-      m_mc_phi = new TTreeReaderValue<std::vector<float>>(m_ttree,"GENphi");
-      m_mc_e   = new TTreeReaderValue<std::vector<float>>(m_ttree,"GENenergy");
-      m_mc_pdgId  = new TTreeReaderValue<std::vector<int>>(m_ttree,"GENid");
-      m_mc_status = new TTreeReaderValue<std::vector<int>>(m_ttree,"GENstatus");
-      m_mc_parent_idx = new TTreeReaderValue<std::vector<int>>(m_ttree,"GENparent_idx");
-      m_mc_child0_idx = new TTreeReaderValue<std::vector<int>>(m_ttree,"GENchild0_idx");
-      m_mc_child1_idx = new TTreeReaderValue<std::vector<int>>(m_ttree,"GENchild1_idx");
-      m_mc_isHadTop = new TTreeReaderValue<std::vector<int>>(m_ttree,"GENisHadTop");
+      m_mc_pt.reset(  new TTreeReaderValue<std::vector<float>>(m_ttree,"GENpt") );
+      m_mc_eta.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"GENeta") );
+      m_mc_phi.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"GENphi") );
+      m_mc_e.reset(   new TTreeReaderValue<std::vector<float>>(m_ttree,"GENenergy") );
+      m_mc_pdgId.reset(  new TTreeReaderValue<std::vector<int>>(m_ttree,"GENid") );
+      m_mc_status.reset( new TTreeReaderValue<std::vector<int>>(m_ttree,"GENstatus") );
+      m_mc_parent_idx.reset( new TTreeReaderValue<std::vector<int>>(m_ttree,"GENparent_idx") );
+      m_mc_child0_idx.reset( new TTreeReaderValue<std::vector<int>>(m_ttree,"GENchild0_idx") );
+      m_mc_child1_idx.reset( new TTreeReaderValue<std::vector<int>>(m_ttree,"GENchild1_idx") );
+      m_mc_isHadTop.reset( new TTreeReaderValue<std::vector<int>>(m_ttree,"GENisHadTop") );
 /*
-      m_mc_ht = new TTreeReaderValue<float>(m_ttree,"evt_Gen_Ht");
-      m_truth_jet_pt  = new TTreeReaderValue<float>(m_ttree,"jetAK4CHS_GenJetPt");
-      m_truth_jet_eta = new TTreeReaderValue<std::vector<float>>(m_ttree,"jetAK4CHS_GenJetEta");
-      m_truth_jet_phi = new TTreeReaderValue<std::vector<float>>(m_ttree,"jetAK4CHS_GenJetPhi");
-      m_truth_jet_e   = new TTreeReaderValue<std::vector<float>>(m_ttree,"jetAK4CHS_GenJetCharge");
-      m_truth_ljet_pt  = new TTreeReaderValue<std::vector<float>>(m_ttree,"jetAK8CHS_GenJetPt");
-      m_truth_ljet_eta = new TTreeReaderValue<std::vector<float>>(m_ttree,"jetAK8CHS_GenJetEta");
-      m_truth_ljet_phi = new TTreeReaderValue<std::vector<float>>(m_ttree,"jetAK8CHS_GenJetPhi");
-      m_truth_ljet_e   = new TTreeReaderValue<std::vector<float>>(m_ttree,"jetAK8CHS_GenJetE");
-      m_truth_ljet_charge     = new TTreeReaderValue<std::vector<float>>(m_ttree,"jetAK8CHS_GenJetCharge");
-      m_truth_ljet_subjet_charge = new TTreeReaderValue<std::vector<float>>(m_ttree,"subjetAK8CHS_GenJetCharge");
+      m_mc_ht.reset( new TTreeReaderValue<float>(m_ttree,"evt_Gen_Ht") );
+      m_truth_jet_pt.reset(  new TTreeReaderValue<float>(m_ttree,"jetAK4CHS_GenJetPt") );
+      m_truth_jet_eta.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"jetAK4CHS_GenJetEta") );
+      m_truth_jet_phi.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"jetAK4CHS_GenJetPhi") );
+      m_truth_jet_e.reset(   new TTreeReaderValue<std::vector<float>>(m_ttree,"jetAK4CHS_GenJetCharge") );
+      m_truth_ljet_pt.reset(  new TTreeReaderValue<std::vector<float>>(m_ttree,"jetAK8CHS_GenJetPt") );
+      m_truth_ljet_eta.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"jetAK8CHS_GenJetEta") );
+      m_truth_ljet_phi.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"jetAK8CHS_GenJetPhi") );
+      m_truth_ljet_e.reset(   new TTreeReaderValue<std::vector<float>>(m_ttree,"jetAK8CHS_GenJetE") );
+      m_truth_ljet_charge.reset(     new TTreeReaderValue<std::vector<float>>(m_ttree,"jetAK8CHS_GenJetCharge") );
+      m_truth_ljet_subjet_charge.reset( new TTreeReaderValue<std::vector<float>>(m_ttree,"subjetAK8CHS_GenJetCharge") );
 */
     } // end isMC
 
-    // Truth matching tool
-    m_truthMatchingTool = new truthMatching(cmaConfig);
-    m_truthMatchingTool->initialize();
+    return;
+}
 
-    // DNN material
-    m_cheetahTool = new deepLearning(cmaConfig);
 
-    // Kinematic reconstruction algorithms
-    m_ttbarRecoTool    = new ttbarReco(cmaConfig);
-    m_neutrinoRecoTool = new neutrinoReco(cmaConfig);
-} // end constructor
+void Event::newFile(){
+    /* The TTreeReader now points to the TTree of another file:
+       readers attached to it are rebound by the TTreeReader; only update the file information
+       (and the data/MC readers if the sample type changed)
+    */
+    m_treeName = m_ttree.GetTree()->GetName();
+    m_fileName = m_config->filename();
 
+    if (m_config->isMC()!=m_isMC){
+        m_isMC = m_config->isMC();
+        initialize_readers();
+    }
 
-Event::~Event() {}
+    setBuilder();      // sample type may have changed
+
+    if (m_duplicateFilter)
+        m_dataset = m_duplicateFilter->datasetIndex( m_config->primaryDataset(), m_fileName );
+
+    return;
+}
+
+
+void Event::setDuplicateFilter( duplicateFilter& filter ){
+    /* Check every data event against the events of the files processed before */
+    m_duplicateFilter = &filter;
+    m_dataset     = m_duplicateFilter->datasetIndex( m_config->primaryDataset(), m_fileName );
+    m_noDuplicate = &m_filters["noDuplicate"];
+    *m_noDuplicate = 1;
+
+    return;
+}
+
+
+void Event::setLumiMask( lumiMask& mask ){
+    /* Check every data event against the certified luminosity sections */
+    m_lumiMask = &mask;
+    m_lumiCertified  = &m_filters["lumiMask"];
+    *m_lumiCertified = 0;
+    m_lastRun = 0;               // no run 0 in data: the first event is always looked up
+    m_lastLumiblock = 0;
+
+    return;
+}
+
+
+void Event::setBuilder(){
+    /* Choose the event builder for this file (sample type & features from the configuration) */
+    setBuilder( m_isMC && m_config->isTtbar() && m_useTruth, m_DNNinference, m_kinematicReco );
+    return;
+}
+
+
+bool Event::setBuilder( const bool truthMatching, const bool dnnInference, const bool kinematicReco ){
+    /* Choose a specialization of the event builder for this file
+       -- false if it cannot be used (the builder is not changed):
+          truth matching needs a ttbar sample, and DNN inference needs the network ('DNNinference')
+       -- the MC builders do not depend on kinematicReco (only used for the JER variations)
+    */
+    if (dnnInference && !m_DNNinference) return false;
+
+    if (m_isMC){
+        bool isTtbar = m_config->isTtbar();
+        if (truthMatching && !isTtbar) return false;
+
+        if (truthMatching)
+            m_builder = (dnnInference) ? &Event::buildMC<true,true,true>   : &Event::buildMC<true,true,false>;
+        else if (isTtbar)
+            m_builder = (dnnInference) ? &Event::buildMC<true,false,true>  : &Event::buildMC<true,false,false>;
+        else
+            m_builder = (dnnInference) ? &Event::buildMC<false,false,true> : &Event::buildMC<false,false,false>;
+
+        if (truthMatching)
+            m_ljetBuilder = (dnnInference) ? &Event::buildLjets<true,true>  : &Event::buildLjets<true,false>;
+        else
+            m_ljetBuilder = (dnnInference) ? &Event::buildLjets<false,true> : &Event::buildLjets<false,false>;
+    }
+    else{
+        if (truthMatching) return false;
+
+        // buildData<dnnInference,kinematicReco>
+        if (kinematicReco)
+            m_builder = (dnnInference) ? &Event::buildData<true,true>  : &Event::buildData<false,true>;
+        else
+            m_builder = (dnnInference) ? &Event::buildData<true,false> : &Event::buildData<false,false>;
+
+        m_ljetBuilder = (dnnInference) ? &Event::buildLjets<false,true> : &Event::buildLjets<false,false>;
+    }
+
+    return true;
+}
 
 void Event::updateEntry(Long64_t entry){
     /* Update the entry -> update all TTree variables */
-    cma::DEBUG("EVENT : Update Entry "+std::to_string(entry) );
+    if (cma::debugEnabled()) cma::DEBUG("EVENT : Update Entry "+std::to_string(entry) );
     m_entry = entry;
 
     // make sure the entry exists
@@ -221,15 +443,21 @@ void Event::updateEntry(Long64_t entry){
 
 
 void Event::clear(){
-    /* Clear many of the vectors/maps for each event -- SAFETY PRECAUTION */
-    m_jets.clear();
-    m_ljets.clear();
+    /* Clear many of the vectors/maps for each event -- SAFETY PRECAUTION
+       - Containers keep their storage: objects go back to the pools
+         and the b-tagging map keeps one (empty) vector per working point
+    */
+    m_jetPool.release(m_jets);
+    m_ljetPool.release(m_ljets);
     m_leptons.clear();
     m_neutrinos.clear();
 
-    m_btag_jets.clear();
-    m_btag_jets_default.clear();
+    clearBtagging();
     m_weight_btag_default = 1.0;
+
+    m_variation = "nominal";
+    m_jerDirection = 0;
+    m_metShift.Set(0.,0.);
     m_nominal_weight = 1.0;
 
     m_HT = 0;
@@ -249,44 +477,83 @@ void Event::execute(Long64_t entry){
     // Reset many event-level values
     clear();
 
-    // Large-R Jets
-    initialize_ljets();
-    cma::DEBUG("EVENT : Setup large-R jets ");
+    // Build the physics objects (specialized for this file in setBuilder())
+    (this->*m_builder)();
 
-    // Truth Information
-    if (m_isMC){
+    cma::DEBUG("EVENT : Setup Event ");
+
+    return;
+}
+
+
+template<bool isTtbar, bool truthMatching, bool dnnInference>
+void Event::buildMC(){
+    /* Simulation: truth information and large-R jets */
+    // Truth Information (first: the large-R jets are matched to it)
+    if (isTtbar){
         initialize_truth();
         cma::DEBUG("EVENT : Setup truth information ");
     }
     else{
-        // Filters
-        initialize_filters();
+        m_truth_partons.clear();                   // only needed for ttbar
+        m_truthTopPool.release(m_truth_tops);
+    }
+
+    // Large-R Jets
+    buildLjets<truthMatching,dnnInference>();
+    cma::DEBUG("EVENT : Setup large-R jets ");
+
+    // Reconstructed objects: only needed to evaluate the JER variations
+    if (m_jerVariations){
+        if (m_kinematicReco) buildReco<true>();
+        else buildReco<false>();
+    }
+
+    return;
+}
 
-        // Triggers
-        initialize_triggers();
 
-        // Jets
-        initialize_jets();
-        cma::DEBUG("EVENT : Setup small-R jets ");
+template<bool dnnInference, bool kinematicReco>
+void Event::buildData(){
+    /* Data: reconstructed objects for the l+jets selection */
+    // Large-R Jets
+    buildLjets<false,dnnInference>();
+    cma::DEBUG("EVENT : Setup large-R jets ");
 
-        // Leptons
-        initialize_leptons();
-        cma::DEBUG("EVENT : Setup leptons ");
+    // Filters
+    initialize_filters();
 
-        // Get some kinematic variables (MET, HT, ST)
-        initialize_kinematics();
-        cma::DEBUG("EVENT : Setup kinematic variables ");
+    // Triggers
+    initialize_triggers();
 
-        // Neutrinos
-        initialize_neutrinos();
-        cma::DEBUG("EVENT : Setup neutrinos ");
+    buildReco<kinematicReco>();
 
-        // Kinematic reconstruction (if they values aren't in the root file)
-        m_ttbar1L = {};
-        if (m_kinematicReco) ttbarReconstruction();
-    }
+    return;
+}
 
-    cma::DEBUG("EVENT : Setup Event ");
+
+template<bool kinematicReco>
+void Event::buildReco(){
+    /* Reconstructed objects for the l+jets selection (AK4, leptons, MET, neutrinos) */
+    // Jets
+    initialize_jets();
+    cma::DEBUG("EVENT : Setup small-R jets ");
+
+    // Leptons
+    initialize_leptons();
+    cma::DEBUG("EVENT : Setup leptons ");
+
+    // Get some kinematic variables (MET, HT, ST)
+    initialize_kinematics();
+    cma::DEBUG("EVENT : Setup kinematic variables ");
+
+    // Neutrinos
+    initialize_neutrinos();
+    cma::DEBUG("EVENT : Setup neutrinos ");
+
+    // Kinematic reconstruction (if they values aren't in the root file)
+    if (kinematicReco) ttbarReconstruction();
+    else m_ttbar1L = {};
 
     return;
 }
@@ -294,7 +561,6 @@ void Event::execute(Long64_t entry){
 
 void Event::ttbarReconstruction(){
     /* Reconstruct ttbar system -- after event selection! */
-    m_ttbar1L = {};
     m_ttbarRecoTool->execute(m_leptons,m_neutrinos,m_jets,m_ljets);
     m_ttbar1L = m_ttbarRecoTool->ttbar1L();
     return;
@@ -302,50 +568,47 @@ void Event::ttbarReconstruction(){
 
 
 void Event::initialize_filters(){
-    /* Setup the filters */
-    m_filters.clear();
+    /* Setup the filters (map entries are made in the constructor) */
+    for (auto& filter : m_filterValues)
+        *filter.first = **filter.second;
+
+    if (m_lumiCertified){
+        // events come in blocks of the same luminosity section: only look up a new section
+        unsigned int run  = runNumber();
+        unsigned int lumi = lumiblock();
+        if (run!=m_lastRun || lumi!=m_lastLumiblock){
+            m_lastRun = run;
+            m_lastLumiblock  = lumi;
+            *m_lumiCertified = m_lumiMask->certified(run,lumi);
+            m_lumiMask->addProcessed( run, lumi, *m_lumiCertified );
+        }
+    }
 
-    m_filters["goodVertices"] = **m_Flag_goodVertices;
-    m_filters["eeBadScFilter"] = **m_Flag_eeBadScFilter;
-    m_filters["HBHENoiseFilter"] = **m_Flag_HBHENoiseFilter;
-    m_filters["HBHENoiseIsoFilter"] = **m_Flag_HBHENoiseIsoFilter;
-    m_filters["globalTightHalo2016Filter"] = **m_Flag_globalTightHalo2016Filter;
-    m_filters["EcalDeadCellTriggerPrimitiveFilter"] = **m_Flag_EcalDeadCellTriggerPrimitiveFilter;
+    // only certified events enter the duplicate filter
+    if (m_noDuplicate)
+        *m_noDuplicate = (m_lumiCertified && !*m_lumiCertified) ||
+                         !m_duplicateFilter->isDuplicate( runNumber(), lumiblock(), eventNumber(), m_dataset );
 
     return;
 }
 
 
 void Event::initialize_triggers(){
-    /* Setup triggers */
-    m_triggers.clear();
-
-    m_triggers["HLT_Ele45_CaloIdVT_GsfTrkIdT_PFJet200_PFJet50"] = **m_HLT_Ele45_CaloIdVT_GsfTrkIdT_PFJet200_PFJet50;
-    m_triggers["HLT_Ele50_CaloIdVT_GsfTrkIdT_PFJet165"] = **m_HLT_Ele50_CaloIdVT_GsfTrkIdT_PFJet165;
-    m_triggers["HLT_Ele115_CaloIdVT_GsfTrkIdT"]    = **m_HLT_Ele115_CaloIdVT_GsfTrkIdT;
-    m_triggers["HLT_Mu40_Eta2P1_PFJet200_PFJet50"] = **m_HLT_Mu40_Eta2P1_PFJet200_PFJet50;
-    m_triggers["HLT_Mu50"]    = **m_HLT_Mu50;
-    m_triggers["HLT_TkMu50"]  = **m_HLT_TkMu50;
-    m_triggers["HLT_PFHT800"] = **m_HLT_PFHT800;
-    m_triggers["HLT_PFHT900"] = **m_HLT_PFHT900;
-    m_triggers["HLT_AK8PFJet450"] = **m_HLT_AK8PFJet450;
-    m_triggers["HLT_PFHT700TrimMass50"]  = **m_HLT_PFHT700TrimMass50;
-    m_triggers["HLT_PFJet360TrimMass30"] = **m_HLT_PFJet360TrimMass30;
+    /* Setup triggers (map entries are made in the constructor) */
+    for (auto& trigger : m_triggerValues)
+        *trigger.first = **trigger.second;
 
     return;
 }
 
 
 void Event::initialize_truth(){
-    /* Setup struct of truth information */
+    /* Setup struct of truth information (only needed for ttbar -- see setBuilder()) */
     m_truth_partons.clear();
-    m_truth_tops.clear();
-
-    if (!m_config->isTtbar()) return;   // don't need this for MC other than ttbar
+    m_truthTopPool.release(m_truth_tops);
 
-    // only care about this for ttbar
     unsigned int nPartons( (*m_mc_pt)->size() );
-    cma::DEBUG("EVENT : N Partons = "+std::to_string(nPartons));
+    if (cma::debugEnabled()) cma::DEBUG("EVENT : N Partons = "+std::to_string(nPartons));
 
     // Collect truth top information into one value
     unsigned int t_idx(0);  // keeping track of tops in m_truth_tops
@@ -395,12 +658,9 @@ void Event::initialize_truth(){
 
         // build truth top structs
         // in truth parton record, the top should arrive before its children
-        TruthTop top;
-
         if (parton.isTop){
             cma::DEBUG("EVENT : is top ");
-            top.Wdecays.clear();    // for storing W daughters
-            top.daughters.clear();  // for storing non-W/bottom daughters
+            TruthTop& top = m_truthTopPool.acquire(m_truth_tops);   // store tops now, add information from children in future iterations
 
             top.Top       = parton.index;
             top.isTop     = (pdgId>0);
@@ -411,12 +671,11 @@ void Event::initialize_truth(){
             parton.containment = m_mapOfContainment.at("FULL");   // only considering truth tops right now, not the decay products
             if (parton.pdgId<0) parton.containment *= -1;         // negative value for anti-tops
 
-            m_truth_tops.push_back(top);   // store tops now, add information from children in future iterations
             t_idx++;
         }
         else if (!parton.isTop && parton.parent_idx>0) {
             int parent_pdgid = (*m_mc_pdgId)->at(parton.parent_idx);
-            cma::DEBUG("EVENT : it's not a top, it's a "+std::to_string(pdgId)+"; parent idx = "+std::to_string(parton.parent_idx)+"; parent pdgid = "+std::to_string(parent_pdgid));
+            if (cma::debugEnabled()) cma::DEBUG("EVENT : it's not a top, it's a "+std::to_string(pdgId)+"; parent idx = "+std::to_string(parton.parent_idx)+"; parent pdgid = "+std::to_string(parent_pdgid));
 
             // check if W is decaying to itself
             if (std::abs(parent_pdgid) == 24 && parent_pdgid == parton.pdgId) {// look at grandparent
@@ -437,11 +696,11 @@ void Event::initialize_truth(){
             }
             if (top_index<0) continue;    // weird element in truth record, just skip it
             parton.top_index = top_index;
-            cma::DEBUG("EVENT : Top index = "+std::to_string(top_index));
+            if (cma::debugEnabled()) cma::DEBUG("EVENT : Top index = "+std::to_string(top_index));
 
             // Parent is Top (W or b)
             if (parent.isTop){
-                top = m_truth_tops.at(parent.top_index);
+                TruthTop& top = m_truth_tops.at(parent.top_index);  // update entry
                 if (parton.isW) top.W = parton.index;
                 else if (parton.isBottom) {
                     top.bottom = parton.index;
@@ -449,19 +708,16 @@ void Event::initialize_truth(){
                     if (top.isAntiTop) parton.containment*=-1;
                 }
                 else top.daughters.push_back( parton.index );        // non-W/bottom daughter
-                m_truth_tops[parent.top_index] = top;                // update entry
             }
             // Parent is W
             else if (parent.isW){
-                top = m_truth_tops.at(top_index);
+                TruthTop& top = m_truth_tops.at(top_index);         // update entry
                 top.Wdecays.push_back(parton.index);
                 top.isHadronic = (parton.isQuark);
                 top.isLeptonic = (parton.isLepton);
 
                 parton.containment = m_mapOfContainment.at("QONLY");
                 if (top.isAntiTop) parton.containment*=-1;
-
-                m_truth_tops[top_index] = top;      // update entry
             }
         } // end else if not top
 
@@ -485,24 +741,19 @@ void Event::initialize_jets(){
         CSVv2T 0.9535
      */
     unsigned int nJets = (*m_jet_pt)->size();
-    m_jets.clear();
-    m_jets_iso.clear();  // jet collection for lepton 2D isolation
+    m_jetPool.release(m_jets_iso);  // jet collection for lepton 2D isolation (& nominal AK4 for systematic variations)
 
-    for (const auto& btagWP : m_config->btagWkpts() ){
-        m_btag_jets[btagWP].clear();
-    }
-
-    unsigned int idx(0);
-    unsigned int idx_iso(0);
     for (unsigned int i=0; i<nJets; i++){
-        Jet jet;
-        jet.p4.SetPtEtaPhiM( (*m_jet_pt)->at(i),(*m_jet_eta)->at(i),(*m_jet_phi)->at(i),(*m_jet_m)->at(i));
+        TLorentzVector p4;
+        p4.SetPtEtaPhiM( (*m_jet_pt)->at(i),(*m_jet_eta)->at(i),(*m_jet_phi)->at(i),(*m_jet_m)->at(i));
 
-        bool isGoodIso( jet.p4.Pt()>15 && std::abs(jet.p4.Eta())<2.4);
-        bool isGood(jet.p4.Pt()>50 && std::abs(jet.p4.Eta())<2.4);
+        bool isGoodIso( p4.Pt()>15 && std::abs(p4.Eta())<2.4);
+        bool isGood(p4.Pt()>50 && std::abs(p4.Eta())<2.4);
 
         if (!isGood && !isGoodIso) continue;
 
+        Jet& jet = m_jetPool.acquire(m_jets_iso);
+        jet.p4 = p4;
         jet.isGood = isGood;
 
         jet.bdisc    = (*m_jet_bdisc)->at(i);
@@ -514,62 +765,145 @@ void Event::initialize_jets(){
         jet.jerSF_UP = (*m_jet_jerSF_UP)->at(i);
         jet.jerSF_DOWN = (*m_jet_jerSF_DOWN)->at(i);
 
-        jet.index  = idx;
+        jet.index  = m_jets_iso.size()-1;     // b-tagging only for the 'real' AK4 (selectJets)
+    }
 
-        if (isGood){
-            m_jets.push_back(jet);
-            getBtaggedJets(jet);          // only care about b-tagging for 'real' AK4
-            idx++;
-        }
-        if (isGoodIso){
-            m_jets_iso.push_back(jet);    // used for 2D isolation
-            idx_iso++;
+    selectJets();                         // 'real' AK4 (pT>50 GeV) for the current variation
+
+    return;
+}
+
+
+void Event::selectJets(){
+    /* Build the AK4 collection (& b-tagging) from the nominal jets
+       - For JER variations, the jet pT is scaled by jerSF_var/jerSF and
+         the change in jet momentum is kept to propagate to the MET
+    */
+    m_jetPool.release(m_jets);
+    m_metShift.Set(0.,0.);
+    clearBtagging();
+
+    unsigned int idx(0);
+    for (const auto& nominal : m_jets_iso){
+        TLorentzVector p4(nominal.p4);
+
+        if (m_jerDirection!=0 && nominal.jerSF>0){
+            float scale = (m_jerDirection>0) ? nominal.jerSF_UP/nominal.jerSF : nominal.jerSF_DOWN/nominal.jerSF;
+            p4 *= scale;
+            m_metShift += TVector2( p4.Px()-nominal.p4.Px(), p4.Py()-nominal.p4.Py() );
         }
+
+        if (!(p4.Pt()>50 && std::abs(p4.Eta())<2.4)) continue;
+
+        Jet& jet = m_jetPool.acquire(m_jets);   // set the attributes one-by-one (a copy would replace the truth_partons storage)
+        jet.p4 = p4;
+        jet.isGood = true;
+        jet.index  = idx;
+        jet.bdisc    = nominal.bdisc;
+        jet.deepCSV  = nominal.deepCSV;
+        jet.area     = nominal.area;
+        jet.uncorrE  = nominal.uncorrE;
+        jet.uncorrPt = nominal.uncorrPt;
+        jet.jerSF    = nominal.jerSF;
+        jet.jerSF_UP = nominal.jerSF_UP;
+        jet.jerSF_DOWN = nominal.jerSF_DOWN;
+        getBtaggedJets(jet);              // only care about b-tagging for 'real' AK4
+        idx++;
     }
 
-    m_btag_jets_default = m_btag_jets.at(m_config->jet_btagWkpt());
+    return;
+}
+
+
+void Event::setVariation( const std::string& variation ){
+    /* Rebuild the objects that depend on the jet energy resolution (MC only: no smearing in data)
+       - The event is read (and the nominal objects are built) once in execute()
+       - Large-R jets are rebuilt from the branches with the varied AK8 scale factors
+       - AK4 jets are rescaled from the nominal jets; leptons (incl. 2D isolation) are not changed
+    */
+    if (!m_isMC) return;
+
+    if (variation.compare(m_variation)==0) return;
+    m_variation = variation;
+
+    if (m_variation.compare("jerUP")==0) m_jerDirection = 1;
+    else if (m_variation.compare("jerDOWN")==0) m_jerDirection = -1;
+    else m_jerDirection = 0;
+
+    if (cma::debugEnabled()) cma::DEBUG("EVENT : Set variation "+m_variation);
+
+    initialize_ljets();
+    selectJets();
+    initialize_kinematics();
+    initialize_neutrinos();
+
+    if (m_kinematicReco) ttbarReconstruction();
+    else m_ttbar1L = {};
 
     return;
 }
 
 
 void Event::initialize_ljets(){
+    /* Setup struct of large-R jets (builder for this file) */
+    (this->*m_ljetBuilder)();
+    return;
+}
+
+
+template<bool truthMatching, bool dnnInference>
+void Event::buildLjets(){
     /* Setup struct of large-R jets and relevant information 
       0 :: Top      (lepton Q < 0)
       1 :: Anti-top (lepton Q > 0)
     */
     unsigned int nLjets = (*m_ljet_pt)->size();
-    m_ljets.clear();
+    m_ljetPool.release(m_ljets);
 
     // Define CWoLa classification based on lepton charge (only single lepton events)
-    int target(-1);
-    if (m_config->isOneLeptonAnalysis() && m_leptons.size()>0){
-        int charge = m_leptons.at(0).charge;
-        target = (charge>0) ? 1:0;
+    // -- the JER variations keep the target of the nominal jets
+    if (m_jerDirection==0){
+        m_ljetTarget = -1;
+        if (m_config->isOneLeptonAnalysis() && m_leptons.size()>0){
+            int charge = m_leptons.at(0).charge;
+            m_ljetTarget = (charge>0) ? 1:0;
+        }
     }
+    int target(m_ljetTarget);
 
     unsigned int idx(0);
     for (unsigned int i=0; i<nLjets; i++){
-        Ljet ljet;
-        ljet.p4.SetPtEtaPhiM( (*m_ljet_pt)->at(i),(*m_ljet_eta)->at(i),(*m_ljet_phi)->at(i),(*m_ljet_m)->at(i));
-        ljet.softDropMass = (*m_ljet_SDmass)->at(i);
-
-        ljet.tau1   = (*m_ljet_tau1)->at(i);
-        ljet.tau2   = (*m_ljet_tau2)->at(i);
-        ljet.tau3   = (*m_ljet_tau3)->at(i);
-        ljet.tau21  = ljet.tau2 / ljet.tau1;
-        ljet.tau32  = ljet.tau3 / ljet.tau2;
-        //bool toptag = (ljet.softDropMass>105. && ljet.softDropMass<210 && ljet.tau32<0.65);  // apply in eventSelection
+        TLorentzVector p4;
+        p4.SetPtEtaPhiM( (*m_ljet_pt)->at(i),(*m_ljet_eta)->at(i),(*m_ljet_phi)->at(i),(*m_ljet_m)->at(i));
+
+        // JER scale factors (MC only) -- the varied jets are scaled by jerSF_var/jerSF before the selection
+        float jerSF(1.0), jerSF_UP(1.0), jerSF_DOWN(1.0);
+        if (m_isMC){
+            jerSF      = (*m_ljet_jerSF)->at(i);
+            jerSF_UP   = (*m_ljet_jerSF_UP)->at(i);
+            jerSF_DOWN = (*m_ljet_jerSF_DOWN)->at(i);
+            if (m_jerDirection!=0 && jerSF>0)
+                p4 *= (m_jerDirection>0) ? jerSF_UP/jerSF : jerSF_DOWN/jerSF;
+        }
 
         float subjet0_bdisc = (*m_ljet_subjet0_bdisc)->at(i);  // want the subjets to have "real" b-disc values
         float subjet1_bdisc = (*m_ljet_subjet1_bdisc)->at(i);
 
         // check if the AK8 is 'good'
-        bool isGood(ljet.p4.Pt()>400. && fabs(ljet.p4.Eta())<2.4 && subjet0_bdisc>=0 && subjet1_bdisc>=0);
-        ljet.isGood = isGood;
+        bool isGood(p4.Pt()>400. && fabs(p4.Eta())<2.4 && subjet0_bdisc>=0 && subjet1_bdisc>=0);
 
         if (!isGood) continue;
 
+        Ljet& ljet = m_ljetPool.acquire(m_ljets);   // reused from a previous event (reset by the pool)
+        ljet.p4 = p4;
+        ljet.isGood = isGood;
+        ljet.softDropMass = (*m_ljet_SDmass)->at(i);
+
+        ljet.tau1   = (*m_ljet_tau1)->at(i);
+        ljet.tau2   = (*m_ljet_tau2)->at(i);
+        ljet.tau3   = (*m_ljet_tau3)->at(i);
+        //bool toptag = (ljet.softDropMass>105. && ljet.softDropMass<210 && tau32<0.65);  // apply in eventSelection
+
         ljet.BEST_t = (*m_ljet_BEST_t)->at(i);
         ljet.BEST_w = (*m_ljet_BEST_w)->at(i);
         ljet.BEST_z = (*m_ljet_BEST_z)->at(i);
@@ -601,25 +935,23 @@ void Event::initialize_ljets(){
         ljet.uncorrE  = (*m_ljet_uncorrE)->at(i);
         ljet.uncorrPt = (*m_ljet_uncorrPt)->at(i);
 
-        ljet.jerSF    = 1.0; //(*m_ljet_jerSF)->at(i);
-        ljet.jerSF_UP = 1.0; //(*m_ljet_jerSF_UP)->at(i);
-        ljet.jerSF_DOWN = 1.0; //(*m_ljet_jerSF_DOWN)->at(i);
+        ljet.jerSF    = jerSF;
+        ljet.jerSF_UP = jerSF_UP;
+        ljet.jerSF_DOWN = jerSF_DOWN;
 
         // Truth-matching to jet
-        ljet.truth_partons.clear();
-        if (m_useTruth && m_config->isTtbar()) {
+        if (truthMatching) {
             cma::DEBUG("EVENT : Truth match AK8");          // match subjets (and then the AK8 jet) to truth tops
 
             m_truthMatchingTool->matchJetToTruthTop(ljet);  // match to partons
 
-            cma::DEBUG("EVENT : ++ Ljet had top = "+std::to_string(ljet.isHadTop)+" for truth top "+std::to_string(ljet.matchId));
+            if (cma::debugEnabled()) cma::DEBUG("EVENT : ++ Ljet had top = "+std::to_string(ljet.isHadTop)+" for truth top "+std::to_string(ljet.matchId));
         } // end truth matching ljet to partons
 
-        m_ljets.push_back(ljet);
         idx++;
     }
 
-    if (m_DNNinference)
+    if (dnnInference)
         deepLearningPrediction();   // store features in map (easily access later)
 
     return;
@@ -690,7 +1022,7 @@ void Event::initialize_leptons(){
         m_leptons.push_back(el);
     }
 
-    cma::DEBUG("EVENT : Found "+std::to_string(m_leptons.size())+" leptons!");
+    if (cma::debugEnabled()) cma::DEBUG("EVENT : Found "+std::to_string(m_leptons.size())+" leptons!");
 
     return;
 }
@@ -732,9 +1064,13 @@ void Event::initialize_kinematics(){
         m_HT += small_jet.p4.Pt();
     }
 
-    // set MET
+    // set MET (propagate changes in the AK4 momenta)
     m_met.p4.SetPtEtaPhiM(**m_met_met,0.,**m_met_phi,0.);
-    cma::DEBUG("EVENT : MET = "+std::to_string(m_met.p4.Pt()));
+    if (m_metShift.Mod()>0){
+        TVector2 met( m_met.p4.Px()-m_metShift.Px(), m_met.p4.Py()-m_metShift.Py() );
+        m_met.p4.SetPtEtaPhiM(met.Mod(),0.,met.Phi(),0.);
+    }
+    if (cma::debugEnabled()) cma::DEBUG("EVENT : MET = "+std::to_string(m_met.p4.Pt()));
 
     // Get MET and lepton transverse energy
     m_ST += m_HT;
@@ -749,7 +1085,7 @@ void Event::initialize_kinematics(){
     float mtw(0.0);
 
     if (m_leptons.size()>0){
-        Lepton lep = m_leptons.at(0);
+        const Lepton& lep = m_leptons.at(0);
         float dphi = m_met.p4.Phi() - lep.p4.Phi();
         mtw = sqrt( 2 * lep.p4.Pt() * m_met.p4.Pt() * (1-cos(dphi)) );
     }
@@ -791,21 +1127,25 @@ bool Event::customIsolation( Lepton& lep ){
 
 
 void Event::getBtaggedJets( Jet& jet ){
-    /* Determine the b-tagging */
-    jet.isbtagged["L"] = false;
-    jet.isbtagged["M"] = false;
-    jet.isbtagged["T"] = false;
-
-    if (jet.bdisc > m_CSVv2L){
-        jet.isbtagged["L"] = true;
-        m_btag_jets["L"].push_back(jet.index);  // 0 = index of this jet
-        if (jet.bdisc > m_CSVv2M){
-            jet.isbtagged["M"] = true;
-            m_btag_jets["M"].push_back(jet.index);
-            if (jet.bdisc > m_CSVv2T){
-                jet.isbtagged["T"] = true;
-                m_btag_jets["T"].push_back(jet.index);
-            }
+    /* Determine the b-tagging for all taggers & working points
+       - set the flags of the jet
+       - add the jet to the event masks (jet index < 64) and lists of b-tagged jets
+    */
+    float discriminants[btag::nTaggers];
+    discriminants[btag::CSVv2]   = jet.bdisc;
+    discriminants[btag::DeepCSV] = jet.deepCSV;
+
+    jet.btagBits = 0;
+    unsigned long long jetBit = (jet.index>=0 && jet.index<64) ? (1ULL << jet.index) : 0;
+
+    for (unsigned int t=0; t<btag::nTaggers; t++){
+        for (unsigned int w=0; w<btag::nWkpts; w++){
+            unsigned int i = t*btag::nWkpts + w;
+            if (discriminants[t] <= m_btag_thresholds[i]) break;   // tighter working points fail too
+
+            jet.btagBits |= (1u << i);
+            m_btag_masks[i] |= jetBit;
+            m_btag_jets[i].push_back(jet.index);
         }
     }
 
@@ -813,16 +1153,27 @@ void Event::getBtaggedJets( Jet& jet ){
 }
 
 
+void Event::clearBtagging(){
+    /* Reset the b-tagged jets (the lists keep their storage) */
+    for (unsigned int i=0, size=btag::nTaggers*btag::nWkpts; i<size; i++){
+        m_btag_masks[i] = 0;
+        m_btag_jets[i].clear();
+    }
+
+    return;
+}
+
+
 /*** RETURN PHYSICS INFORMATION ***/
-std::vector<int> Event::btag_jets(const std::string &wkpt) const{
+const std::vector<int>& Event::btag_jets(const std::string &wkpt) const{
     /* Small-R Jet b-tagging */
-    std::string tmp_wkpt(wkpt);
-    if(m_btag_jets.find(wkpt) == m_btag_jets.end()){
+    int w = btagWkptIndex(wkpt);
+    if (w<0){
         cma::WARNING("EVENT : B-tagging working point "+wkpt+" does not exist.");
         cma::WARNING("EVENT : Return vector of b-tagged jets for default working point "+m_config->jet_btagWkpt());
-        tmp_wkpt = m_config->jet_btagWkpt();
+        w = m_btagWkpt;
     }
-    return m_btag_jets.at(tmp_wkpt);
+    return btag_jets(btag::CSVv2, static_cast<btag::wkpt>(w));
 }
 
 void Event::deepLearningPrediction(){
@@ -837,100 +1188,7 @@ void Event::deepLearningPrediction(){
 
 /*** DELETE VARIABLES ***/
 void Event::finalize(){
-    // delete variables
-    cma::DEBUG("EVENT : Finalize() ");
-    delete m_eventNumber;
-    delete m_runNumber;
-    delete m_lumiblock;
-
-    delete m_ljet_pt;
-    delete m_ljet_eta;
-    delete m_ljet_phi;
-    delete m_ljet_m;
-    delete m_ljet_tau1;
-    delete m_ljet_tau2;
-    delete m_ljet_tau3;
-    delete m_ljet_charge;
-    delete m_ljet_SDmass;
-    delete m_ljet_subjet0_charge;
-    delete m_ljet_subjet0_bdisc;
-    delete m_ljet_subjet0_deepCSV;
-    delete m_ljet_subjet0_pt;
-    delete m_ljet_subjet0_mass;
-    delete m_ljet_subjet1_charge;
-    delete m_ljet_subjet1_bdisc;
-    delete m_ljet_subjet1_deepCSV;
-    delete m_ljet_subjet1_pt;
-    delete m_ljet_subjet1_mass;
-    delete m_ljet_area;
-    delete m_ljet_uncorrPt;
-    delete m_ljet_uncorrE;
-
-    if (m_isMC){
-      delete m_mc_pt;
-      delete m_mc_eta;
-      delete m_mc_phi;
-      delete m_mc_e;
-      delete m_mc_pdgId;
-      delete m_mc_status;
-      delete m_mc_isHadTop;
-    }
-    else{
-      delete m_jet_pt;
-      delete m_jet_eta;
-      delete m_jet_phi;
-      delete m_jet_m;
-      delete m_jet_bdisc;
-      delete m_jet_deepCSV;
-      delete m_jet_area;
-      delete m_jet_uncorrPt;
-      delete m_jet_uncorrE;
-
-      delete m_el_pt;
-      delete m_el_eta;
-      delete m_el_phi;
-      delete m_el_e;
-      delete m_el_charge;
-      //delete m_el_iso;
-      delete m_el_id_loose;
-      delete m_el_id_medium;
-      delete m_el_id_tight;
-      delete m_el_id_loose_noIso;
-      delete m_el_id_medium_noIso;
-      delete m_el_id_tight_noIso;
-
-      delete m_mu_pt;
-      delete m_mu_eta;
-      delete m_mu_phi;
-      delete m_mu_e;
-      delete m_mu_charge;
-      delete m_mu_iso;
-      delete m_mu_id_loose;
-      delete m_mu_id_medium;
-      delete m_mu_id_tight;
-      delete m_met_met;
-      delete m_met_phi;
-      delete m_HTAK8;
-      delete m_HTAK4;
-
-      delete m_HLT_Ele45_CaloIdVT_GsfTrkIdT_PFJet200_PFJet50;
-      delete m_HLT_Ele50_CaloIdVT_GsfTrkIdT_PFJet165;
-      delete m_HLT_Ele115_CaloIdVT_GsfTrkIdT;
-      delete m_HLT_Mu40_Eta2P1_PFJet200_PFJet50;
-      delete m_HLT_Mu50;
-      delete m_HLT_PFHT800;
-      delete m_HLT_PFHT900;
-      delete m_HLT_AK8PFJet450;
-      delete m_HLT_PFHT700TrimMass50;
-      delete m_HLT_PFJet360TrimMass30;
-
-      delete m_Flag_goodVertices;
-      delete m_Flag_eeBadScFilter;
-      delete m_Flag_HBHENoiseFilter;
-      delete m_Flag_HBHENoiseIsoFilter;
-      delete m_Flag_globalTightHalo2016Filter;
-      delete m_Flag_EcalDeadCellTriggerPrimitiveFilter;
-    }
+    /* End of a file -- readers & tools are owned by the Event and kept for the next file */
     return;
 }
 
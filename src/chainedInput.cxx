@@ -0,0 +1,227 @@
+/*
+Created:        19 October 2026
+Last Updated:   19 October 2026
+
+agent
+agent@local
+-----
+
+Chain of input files with a global entry index
+
+The number of entries of the TTree in each file is read once, giving an offset table:
+  global entry = offset of the file + local entry
+The entries are taken from the file index ('fileIndex'), so only files that are not
+in the index are opened for this. The basket clusters of a file are read when a
+boundary of this job falls in it or the job processes it.
+Ranges of global entries start and end on cluster boundaries
+(the start of each file is a cluster boundary), so a range that crosses
+a file boundary never splits a cluster. Each range is mapped back to
+the entries of each file with segments().
+
+Jobs (processes) take contiguous shares of the global range with setRange();
+workers (threads) of one job claim the ranges of the share with claim().
+*/
+#include "Analysis/cheetah/interface/chainedInput.h"
+
+
+chainedInput::chainedInput( configuration& cmaConfig ) :
+  m_config(&cmaConfig),
+  m_treename(""),
+  m_rangeSize(100000),
+  m_nextRange(0){
+    m_filenames.clear();
+    m_offsets.clear();
+    m_clusters.clear();
+    m_clustersLoaded.clear();
+    m_ranges.clear();
+  }
+
+chainedInput::~chainedInput() {}
+
+
+void chainedInput::initialize( const std::vector<std::string>& filenames, const std::string& treename, fileIndex& index ){
+    /* Build the offset table (the start of each file is a cluster boundary) */
+    m_treename  = treename;
+    m_filenames = filenames;
+    m_offsets.assign(1,0);
+    m_clusters.clear();
+    m_clustersLoaded.assign(m_filenames.size(),false);
+
+    unsigned int nOpened(0);
+    for (unsigned int f=0; f<m_filenames.size(); f++){
+        const std::string& filename = m_filenames.at(f);
+        Long64_t offset   = m_offsets.back();
+        Long64_t nEntries = 0;
+
+        fileIndexEntry indexed;
+        if (index.lookup(filename,indexed) && indexed.entries>=0 && indexed.treename.compare(treename)==0)
+            nEntries = indexed.entries;
+        else{
+            // not indexed: open the file once (and keep its clusters)
+            nOpened++;
+            std::unique_ptr<TFile> file( TFile::Open(filename.c_str()) );
+            TTree* tree = (file && !file->IsZombie()) ? (TTree*)file->Get(treename.c_str()) : nullptr;
+
+            if (tree){
+                nEntries = tree->GetEntries();
+
+                TTree::TClusterIterator clusters = tree->GetClusterIterator(0);
+                Long64_t start;
+                while ( (start = clusters()) < nEntries )
+                    m_clusters.push_back( offset+start );
+            }
+            else
+                cma::WARNING("CHAINEDINPUT : No TTree "+treename+" in "+filename+"; no entries used from this file");
+            m_clustersLoaded.at(f) = true;
+        }
+
+        if (nEntries>0)
+            m_clusters.push_back( offset );
+        m_offsets.push_back( offset+nEntries );
+    }
+
+    std::sort( m_clusters.begin(), m_clusters.end() );
+    m_clusters.erase( std::unique(m_clusters.begin(), m_clusters.end()), m_clusters.end() );
+
+    cma::INFO("CHAINEDINPUT : "+std::to_string(entries())+" entries in "+std::to_string(m_filenames.size())+" files ("
+              +std::to_string(m_filenames.size()-nOpened)+" from the file index)");
+
+    return;
+}
+
+
+void chainedInput::loadClusters( const unsigned int file ){
+    /* Add the cluster boundaries inside a file (opened once) */
+    if (file>=m_filenames.size() || m_clustersLoaded.at(file)) return;
+    m_clustersLoaded.at(file) = true;
+
+    Long64_t offset   = m_offsets.at(file);
+    Long64_t nEntries = fileEntries(file);
+    if (nEntries<1) return;
+
+    std::unique_ptr<TFile> tfile( TFile::Open(m_filenames.at(file).c_str()) );
+    TTree* tree = (tfile && !tfile->IsZombie()) ? (TTree*)tfile->Get(m_treename.c_str()) : nullptr;
+    if (!tree){
+        cma::WARNING("CHAINEDINPUT : Cannot read the clusters of "+m_filenames.at(file)+"; using the whole file as one cluster");
+        return;
+    }
+
+    std::vector<Long64_t> clusters;
+    TTree::TClusterIterator iterator = tree->GetClusterIterator(0);
+    Long64_t start;
+    while ( (start = iterator()) < nEntries )
+        clusters.push_back( offset+start );
+
+    std::size_t middle = m_clusters.size();
+    m_clusters.insert( m_clusters.end(), clusters.begin(), clusters.end() );
+    std::inplace_merge( m_clusters.begin(), m_clusters.begin()+middle, m_clusters.end() );
+    m_clusters.erase( std::unique(m_clusters.begin(), m_clusters.end()), m_clusters.end() );
+
+    return;
+}
+
+
+void chainedInput::setRange( const Long64_t first, const Long64_t nEntries, const unsigned int jobIndex, const unsigned int nJobs ){
+    /* Split the requested entries into the shares of each job, then into ranges of at least m_rangeSize */
+    m_ranges.clear();
+    m_nextRange = 0;
+
+    Long64_t begin = std::min( std::max(first,(Long64_t)0), entries() );
+    Long64_t end   = (nEntries<0) ? entries() : std::min( begin+nEntries, entries() );
+
+    // share of this job (boundaries moved to the nearest cluster -- of the file they fall in,
+    // so that neighbouring jobs agree on the boundary)
+    Long64_t size = end-begin;
+    Long64_t shareBegin = begin+size*jobIndex/nJobs;
+    Long64_t shareEnd   = begin+size*(jobIndex+1)/nJobs;
+    if (shareBegin<entries()) loadClusters( fileNumber(shareBegin) );
+    if (shareEnd<entries())   loadClusters( fileNumber(shareEnd) );
+
+    Long64_t jobBegin = alignToCluster( shareBegin, begin, end );
+    Long64_t jobEnd   = alignToCluster( shareEnd, begin, end );
+
+    // clusters of the files processed by this job
+    for (unsigned int f=(jobBegin<entries()) ? fileNumber(jobBegin) : m_filenames.size(); f<m_filenames.size() && m_offsets.at(f)<jobEnd; f++)
+        loadClusters( f );
+
+    // ranges made of whole clusters (except at the edges of the share)
+    auto cluster = std::upper_bound( m_clusters.begin(), m_clusters.end(), jobBegin );
+    Long64_t start = jobBegin;
+    while (start<jobEnd){
+        Long64_t stop = (cluster!=m_clusters.end()) ? std::min(*cluster,jobEnd) : jobEnd;
+        if (cluster!=m_clusters.end()) ++cluster;
+
+        if (stop-start < m_rangeSize && stop<jobEnd)
+            continue;            // keep adding clusters to this range
+
+        m_ranges.push_back( {start,stop} );
+        start = stop;
+    }
+
+    cma::INFO("CHAINEDINPUT : Job "+std::to_string(jobIndex)+"/"+std::to_string(nJobs)+" processes entries ["
+              +std::to_string(jobBegin)+","+std::to_string(jobEnd)+") in "+std::to_string(m_ranges.size())+" ranges");
+
+    return;
+}
+
+
+Long64_t chainedInput::alignToCluster( const Long64_t entry, const Long64_t first, const Long64_t last ) const{
+    /* Nearest cluster boundary to 'entry' inside [first,last] (first & last are always allowed) */
+    if (entry<=first) return first;
+    if (entry>=last)  return last;
+
+    Long64_t aligned = first;
+    auto above = std::lower_bound( m_clusters.begin(), m_clusters.end(), entry );
+    if (above!=m_clusters.end() && *above<last)
+        aligned = *above;
+    else
+        aligned = last;
+
+    if (above!=m_clusters.begin()){
+        Long64_t below = *(above-1);
+        if (below>first && entry-below < aligned-entry)
+            aligned = below;
+    }
+
+    return aligned;
+}
+
+
+bool chainedInput::claim( entryRange& range ){
+    /* Hand out the next range (each range is claimed once, also with several threads) */
+    std::size_t next = m_nextRange.fetch_add(1);
+    if (next>=m_ranges.size())
+        return false;
+
+    range = m_ranges.at(next);
+
+    return true;
+}
+
+
+unsigned int chainedInput::fileNumber( const Long64_t entry ) const{
+    /* File that contains a global entry (empty files are skipped) */
+    auto file = std::upper_bound( m_offsets.begin(), m_offsets.end(), entry );
+    return (file - m_offsets.begin()) - 1;
+}
+
+
+std::vector<fileSegment> chainedInput::segments( const entryRange& range ) const{
+    /* Split a global range at the file boundaries */
+    std::vector<fileSegment> pieces;
+
+    Long64_t begin = range.begin;
+    unsigned int file = fileNumber( begin );
+    while (begin<range.end && file<m_filenames.size()){
+        Long64_t end = std::min( range.end, m_offsets.at(file+1) );
+        if (end>begin)
+            pieces.push_back( {file, m_filenames.at(file), begin-m_offsets.at(file), end-m_offsets.at(file)} );
+
+        begin = end;
+        file++;
+    }
+
+    return pieces;
+}
+
+// THE END
@@ -18,19 +18,37 @@ Configuration class
 configuration::configuration(const std::string &configFile) : 
   m_configFile(configFile),
   m_isMC(false),
+  m_isTtbar(false),
   m_treename("SetMe"),
   m_filename("SetMe"),
   m_verboseLevel("SetMe"),
   m_nEventsToProcess(0),
   m_firstEvent(0),
+  m_globalEntries(false),
+  m_nJobs(1),
+  m_jobIndex(0),
   m_outputFilePath("SetMe"),
   m_customDirectory("SetMe"),
   m_cma_absPath("SetMe"),
   m_metadataFile("SetMe"),
+  m_metadataTreeName(""),
+  m_fileIndex(""),
+  m_selectionCache(""),
+  m_incremental(false),
+  m_telemetry(""),
+  m_telemetryInterval(10.),
+  m_removeDuplicates(false),
+  m_duplicatePriority(""),
+  m_duplicateMaxMemory(0.),
+  m_duplicateSpillDirectory("."),
+  m_duplicateBloomEvents(0),
+  m_lumiMask(""),
   m_DNNinference(false),
   m_DNNtraining(false),
   m_dnnFile("SetMe"),
   m_dnnKey("SetMe"),
+  m_dnnBackend("lwtnn"),
+  m_dnnValidate(false),
   m_jet_btag_wkpt("SetMe"){
     m_selections.clear();
     m_cutsfiles.clear();
@@ -101,6 +119,16 @@ void configuration::initialize() {
     // Assign values
     m_nEventsToProcess = std::stoi(getConfigOption("NEvents"));
     m_firstEvent       = std::stoi(getConfigOption("firstEvent"));
+    int nJobs          = std::stoi(getConfigOption("nJobs"));
+    int jobIndex       = std::stoi(getConfigOption("jobIndex"));
+    m_nJobs            = (nJobs>1) ? nJobs : 1;
+    m_jobIndex         = (jobIndex>0) ? jobIndex : 0;
+    m_globalEntries    = cma::str2bool( getConfigOption("globalEntries") ) || m_nJobs>1;   // jobs are split over the chained inputs
+    if (m_jobIndex>=m_nJobs){
+        // running another job's share would duplicate its output
+        cma::ERROR("CONFIG : jobIndex ("+std::to_string(m_jobIndex)+") must be less than nJobs ("+std::to_string(m_nJobs)+"). Aborting!");
+        exit(EXIT_FAILURE);
+    }
     m_input_selection  = getConfigOption("input_selection"); // "grid", "pre", etc.
     cma::split( m_map_config.at("selection"), ',', m_selections );  // different event selections
     cma::split( m_map_config.at("cutsfile"), ',', m_cutsfiles );  // different event selections
@@ -111,8 +139,40 @@ void configuration::initialize() {
     m_jet_btag_wkpt    = getConfigOption("jet_btag_wkpt");
     m_outputFilePath   = getConfigOption("output_path");
     m_customDirectory  = getConfigOption("customDirectory");
+    m_metadataFile     = getConfigOption("metadataFile");
+    m_metadataTreeName = getConfigOption("metadataTreeName");
+    m_fileIndex        = getConfigOption("fileIndex");
+
+    // systematic variations (each written to its own directory; nominal at the top of the file)
+    std::vector<std::string> systematics;
+    cma::split( getConfigOption("systematics"), ',', systematics );
+    m_systematics.clear();
+    for (const auto& syst : systematics){
+        if (std::find(m_supportedSystematics.begin(), m_supportedSystematics.end(), syst)==m_supportedSystematics.end())
+            cma::WARNING("CONFIG : Systematic variation "+syst+" is not supported -- skipping it");
+        else if (std::find(m_systematics.begin(), m_systematics.end(), syst)==m_systematics.end())
+            m_systematics.push_back(syst);
+    }
+    if (m_systematics.size()<1) m_systematics.push_back("nominal");
+
+    m_makeSkim = cma::str2bool( getConfigOption("makeSkim") );
+    m_skimBranches.clear();
+    cma::split( getConfigOption("skimBranches"), ',', m_skimBranches );
+    m_selectionCache = getConfigOption("selectionCache");
+    m_incremental    = cma::str2bool( getConfigOption("incremental") );
+    m_telemetry      = getConfigOption("telemetry");
+    m_telemetryInterval = std::stod( getConfigOption("telemetryInterval") );
+    m_removeDuplicates  = cma::str2bool( getConfigOption("removeDuplicates") );
+    m_duplicatePriority = getConfigOption("duplicatePriority");
+    m_duplicateMaxMemory = std::stod( getConfigOption("duplicateMaxMemory") );
+    m_duplicateSpillDirectory = getConfigOption("duplicateSpillDirectory");
+    m_duplicateBloomEvents = std::stoull( getConfigOption("duplicateBloomEvents") );
+    m_lumiMask          = getConfigOption("lumiMask");
+
     m_dnnFile          = getConfigOption("dnnFile");
     m_dnnKey           = getConfigOption("dnnKey");
+    m_dnnBackend       = getConfigOption("dnnBackend");
+    m_dnnValidate      = cma::str2bool( getConfigOption("dnnValidate") );
     m_DNNinference     = cma::str2bool( getConfigOption("DNNinference") );
     m_DNNtraining      = cma::str2bool( getConfigOption("DNNtraining") );
 
@@ -124,6 +184,33 @@ void configuration::initialize() {
 }
 
 
+unsigned long long configuration::hash(){
+    /* Hash of the effective configuration (options + contents of the files that define the output)
+       - options that do not change the output files (list of inputs, verbosity, caches) are ignored
+    */
+    unsigned long long hashValue = cma::hash("");
+
+    for (const auto& config : m_map_config){     // sorted by name: same order every time
+        if (std::find(m_hashIgnoredOptions.begin(), m_hashIgnoredOptions.end(), config.first)!=m_hashIgnoredOptions.end())
+            continue;
+        hashValue = cma::hash( config.first+"="+config.second+"\n", hashValue );
+    }
+
+    std::vector<std::string> files(m_cutsfiles);
+    files.push_back( m_metadataFile );
+    files.push_back( m_dnnFile );                  // network used for inference
+    if (m_lumiMask.size()>0) files.push_back( m_lumiMask );
+    for (const auto& filename : files){
+        std::ifstream file(filename.c_str());
+        std::stringstream contents;
+        if (file) contents << file.rdbuf();
+        hashValue = cma::hash( filename+"\n"+contents.str(), hashValue );
+    }
+
+    return hashValue;
+}
+
+
 void configuration::print(){
     // -- Print the configuration
     std::cout << " ** CyMiniAna ** " << std::endl;
@@ -158,26 +245,42 @@ std::string configuration::getConfigOption( std::string item ){
 
 void configuration::readMetadata(TFile& file,const std::string& metadataTreeName){
     /* Read metadata TTree */
-    m_primaryDataset = "";
-    m_isMC = false;
+    setMetadata( readPrimaryDataset(file,metadataTreeName) );
+    return;
+}
 
-    if (metadataTreeName.size()<1) return;  // no metadata tree to read
+
+std::string configuration::readPrimaryDataset(TFile& file,const std::string& metadataTreeName){
+    /* Read the primary dataset from the metadata TTree 
+       - static so it can be called before the file is handed to the configuration
+    */
+    if (metadataTreeName.size()<1) return "";  // no metadata tree to read
+    if (!file.Get(metadataTreeName.c_str())) return "";
 
     TTreeReader metadata(metadataTreeName.c_str(), &file);
 
     TTreeReaderValue<std::string> primaryDataset(metadata, "primaryDataset");
     metadata.Next();
 
-    std::string pd  = *primaryDataset;
+    return *primaryDataset;
+}
+
+
+void configuration::setMetadata(const std::string& primaryDataset){
+    /* Set the primary dataset and determine if this is MC */
+    m_NTotalEvents   = 0;
+    m_primaryDataset = primaryDataset;
+    m_isMC = false;
+    m_isTtbar = false;
+
     for (const auto& x : m_mapOfPrimaryDatasets){   // only contains MC samples
-        if (x.second==pd){
+        if (x.second==m_primaryDataset){
             m_isMC = true;
+            m_isTtbar = (x.first.find("ttbar")==0);
             break;
         }
     }
 
-    m_primaryDataset   = pd;
-
     cma::DEBUG("CONFIGURATION : Primary dataset = "+m_primaryDataset);
 
     return;
@@ -189,12 +292,38 @@ void configuration::inspectFile( TFile& file, const std::string& metadataTreeNam
     m_NTotalEvents   = 0;
     m_primaryDataset = "";
     m_isMC = false;
+    m_isTtbar = false;
     readMetadata(file,metadataTreeName);                 // access metadata
 
     return;
 }
 
 
+Sample configuration::sample( const std::string& primaryDataset ){
+    /* Normalization for a sample (default values of 1 for data or unknown samples)
+       - metadata file only read the first time this is needed
+    */
+    if (m_mapOfSamples.size()<1){
+        std::vector<std::string> metadata;
+        cma::read_file( m_metadataFile, metadata );
+
+        for (const auto& line : metadata){
+            std::istringstream lineStream(line);
+            Sample s;
+            lineStream >> s.sampleType >> s.primaryDataset >> s.XSection >> s.sumOfWeights >> s.KFactor >> s.NEvents;
+            if (lineStream.fail()) continue;
+            m_mapOfSamples[s.primaryDataset] = s;
+        }
+    }
+
+    Sample s = {"data",primaryDataset,1.,1.,1.,1};
+    if (m_mapOfSamples.find(primaryDataset)!=m_mapOfSamples.end())
+        s = m_mapOfSamples.at(primaryDataset);
+
+    return s;
+}
+
+
 void configuration::setTreename(std::string treeName){
     m_treename = treeName;
     return;
@@ -8,30 +8,106 @@ Texas A&M University
 -----
 
 Tool for performing deep learning tasks
-- Inference: LWTNN
+- Inference: LWTNN or the compiled network (generated by python/lwtnn2header.py, see interface/compiledDNN.h)
+             in double, float32, or int8 (weights calibrated with python/calibrateDNN.py)
 - Training: save features to flat ntuple; train in python environment
 
 -- Setup as of 2 March: Top/Antitop tagging (CHEETAH)
 */
 #include "Analysis/cheetah/interface/deepLearning.h"
 
+#include <fstream>
+#include <sstream>
+
 
 deepLearning::deepLearning( configuration& cmaConfig ) :
   m_config(&cmaConfig),
-  m_lwnn(nullptr){
+  m_backend(lwtnnBackend),
+  m_validate(false),
+  m_tolerance(1e-6),
+  m_nValidated(0),
+  m_nFailed(0),
+  m_maxDeviation(0.){
     m_features.clear();
+    m_predictions.clear();
+    m_compiledInputs.clear();
+    m_compiledOutputs.clear();
+
+    static const char* featureNames[nFeatures] = {
+        "target",
+        "ljet_subjet0_bdisc", "ljet_subjet0_charge", "ljet_subjet0_mass", "ljet_subjet0_mrel", "ljet_subjet0_ptrel",
+        "ljet_subjet0_tau1", "ljet_subjet0_tau2", "ljet_subjet0_tau3", "ljet_subjet0_tau21", "ljet_subjet0_tau32",
+        "ljet_subjet1_bdisc", "ljet_subjet1_charge", "ljet_subjet1_mass", "ljet_subjet1_mrel", "ljet_subjet1_ptrel",
+        "ljet_subjet1_tau1", "ljet_subjet1_tau2", "ljet_subjet1_tau3", "ljet_subjet1_tau21", "ljet_subjet1_tau32",
+        "ljet_charge", "weight"};
+    for (unsigned int i=0; i<nFeatures; i++)
+        m_featureValues[i] = &m_features[featureNames[i]];
 
-    // Setup lwtnn
     m_dnnKey = m_config->dnnKey();
     if (m_config->DNNinference()){
-      std::ifstream input_cfg = cma::open_file( m_config->dnnFile() );
-      lwt::JSONConfig cfg     = lwt::parse_json( input_cfg );
-      m_lwnn   = new lwt::LightweightNeuralNetwork(cfg.inputs, cfg.layers, cfg.outputs);
+      // Choose the backend
+      std::string backend = m_config->dnnBackend();
+      if (backend.compare("compiled")==0)   m_backend = compiledBackend;
+      else if (backend.compare("float")==0) m_backend = floatBackend;
+      else if (backend.compare("int8")==0)  m_backend = int8Backend;
+      else if (backend.compare("lwtnn")!=0)
+          cma::WARNING("DEEPLEARNING : Unknown dnnBackend '"+backend+"'; using lwtnn");
+
+#ifndef CHEETAH_COMPILED_DNN
+      if (m_backend!=lwtnnBackend){
+          cma::WARNING("DEEPLEARNING : The compiled network has not been generated (python/lwtnn2header.py); using lwtnn");
+          m_backend = lwtnnBackend;
+      }
+#endif
+#ifndef CHEETAH_COMPILED_DNN_INT8
+      if (m_backend==int8Backend){
+          cma::WARNING("DEEPLEARNING : The compiled network was generated without an int8 calibration (python/calibrateDNN.py); using float");
+          m_backend = floatBackend;
+      }
+#endif
+
+#ifdef CHEETAH_COMPILED_DNN
+      // the compiled network must be generated from the network in 'dnnFile'
+      if (m_backend!=lwtnnBackend){
+          std::ifstream dnnFile( m_config->dnnFile().c_str(), std::ios::binary );
+          std::stringstream contents;
+          contents << dnnFile.rdbuf();
+          if (cma::hashToStr(cma::hash(contents.str())).compare(compiledDNN::sourceHash)!=0){
+              cma::ERROR("DEEPLEARNING : The compiled network was generated from "+std::string(compiledDNN::sourceFile)+
+                         ", not from dnnFile "+m_config->dnnFile()+" (re-run python/lwtnn2header.py); using lwtnn");
+              m_backend = lwtnnBackend;
+          }
+      }
+#endif
+
+      // compare the compiled network to lwtnn (double precision reference)
+      m_validate = (m_config->dnnValidate() && m_backend!=lwtnnBackend);
+      if (m_backend==floatBackend)     m_tolerance = 1e-4;
+      else if (m_backend==int8Backend) m_tolerance = 5e-2;   // depends on the calibration (see python/calibrateDNN.py)
+
+      // Setup lwtnn
+      if (m_backend==lwtnnBackend || m_validate){
+          std::ifstream input_cfg = cma::open_file( m_config->dnnFile() );
+          lwt::JSONConfig cfg     = lwt::parse_json( input_cfg );
+          m_lwnn.reset( new lwt::LightweightNeuralNetwork(cfg.inputs, cfg.layers, cfg.outputs) );
+      }
+
+      // Setup compiled network
+      if (m_backend!=lwtnnBackend)
+          initializeCompiled();
     }
   }
 
 deepLearning::~deepLearning() {
-    delete m_lwnn;
+    /* Report the deviation of the compiled network from lwtnn */
+    if (m_validate){
+        std::string summary = "Max. deviation of "+m_config->dnnBackend()+" network from lwtnn = "+std::to_string(m_maxDeviation)+
+                              " ("+std::to_string(m_nValidated)+" jets; tolerance "+std::to_string(m_tolerance)+")";
+        if (m_nFailed>0)
+            cma::ERROR("DEEPLEARNING : "+summary+": "+std::to_string(m_nFailed)+" jets outside of the tolerance");
+        else
+            cma::INFO("DEEPLEARNING : "+summary);
+    }
 }
 
 
@@ -60,7 +136,15 @@ void deepLearning::inference(std::vector<Ljet>& ljets){
 void deepLearning::inference(Ljet& ljet){
     /* Calculate DNN prediction */
     loadFeatures(ljet);
-    m_predictions = m_lwnn->compute(m_features);
+
+    if (m_backend==lwtnnBackend)
+        m_predictions = m_lwnn->compute(m_features);
+    else{
+        inferenceCompiled();
+        if (m_validate)
+            validate( m_lwnn->compute(m_features) );
+    }
+
     ljet.dnn = m_predictions;
     m_DNN    = m_predictions.at(m_dnnKey);        // set default value
 
@@ -69,42 +153,125 @@ void deepLearning::inference(Ljet& ljet){
 
 
 void deepLearning::loadFeatures(const Ljet& ljet){
-    /* Calculate DNN features */
-    m_features.clear();
+    /* Calculate DNN features (the same keys are set for every jet -- the map is not cleared) */
 
     // feature calculations
-    m_features["target"] = ljet.target;
-
-    m_features["ljet_subjet0_bdisc"]  = ljet.subjet0_bdisc;
-    m_features["ljet_subjet0_charge"] = ljet.subjet0_charge;
-    m_features["ljet_subjet0_mass"]   = ljet.subjet0_mass;
-    m_features["ljet_subjet0_mrel"]   = ljet.subjet0_mass/ljet.p4.M();
-    m_features["ljet_subjet0_ptrel"]  = ljet.subjet0_pt/ljet.p4.Pt();
-    m_features["ljet_subjet0_tau1"]   = ljet.subjet0_tau1;
-    m_features["ljet_subjet0_tau2"]   = ljet.subjet0_tau2;
-    m_features["ljet_subjet0_tau3"]   = ljet.subjet0_tau3;
-    m_features["ljet_subjet0_tau21"]  = ljet.subjet0_tau2 / ljet.subjet0_tau1;
-    m_features["ljet_subjet0_tau32"]  = ljet.subjet0_tau3 / ljet.subjet0_tau2;
-    m_features["ljet_subjet1_bdisc"]  = ljet.subjet1_bdisc;
-    m_features["ljet_subjet1_charge"] = ljet.subjet1_charge;
-    m_features["ljet_subjet1_mass"]   = ljet.subjet1_mass;
-    m_features["ljet_subjet1_mrel"]   = ljet.subjet1_mass/ljet.p4.M();
-    m_features["ljet_subjet1_ptrel"]  = ljet.subjet1_pt/ljet.p4.Pt();
-    m_features["ljet_subjet1_tau1"]   = ljet.subjet1_tau1;
-    m_features["ljet_subjet1_tau2"]   = ljet.subjet1_tau2;
-    m_features["ljet_subjet1_tau3"]   = ljet.subjet1_tau3;
-    m_features["ljet_subjet1_tau21"]  = ljet.subjet1_tau2 / ljet.subjet1_tau1;
-    m_features["ljet_subjet1_tau32"]  = ljet.subjet1_tau3 / ljet.subjet1_tau2;
-
-    m_features["ljet_charge"] = ljet.charge;
-
-    m_features["weight"] = 1.;  // 1/ljet.p4.Pt() or something
+    *m_featureValues[f_target] = ljet.target;
+
+    *m_featureValues[f_subjet0_bdisc]      = ljet.subjet0_bdisc;
+    *m_featureValues[f_subjet0_charge]     = ljet.subjet0_charge;
+    *m_featureValues[f_subjet0_mass]       = ljet.subjet0_mass;
+    *m_featureValues[f_subjet0_mrel]       = ljetObservables::get(ljet,ljetObservables::subjet0_mrel);
+    *m_featureValues[f_subjet0_ptrel]      = ljetObservables::get(ljet,ljetObservables::subjet0_ptrel);
+    *m_featureValues[f_subjet0_tau1]       = ljet.subjet0_tau1;
+    *m_featureValues[f_subjet0_tau2]       = ljet.subjet0_tau2;
+    *m_featureValues[f_subjet0_tau3]       = ljet.subjet0_tau3;
+    *m_featureValues[f_subjet0_tau21]      = ljetObservables::get(ljet,ljetObservables::subjet0_tau21);
+    *m_featureValues[f_subjet0_tau32]      = ljetObservables::get(ljet,ljetObservables::subjet0_tau32);
+    *m_featureValues[f_subjet1_bdisc]      = ljet.subjet1_bdisc;
+    *m_featureValues[f_subjet1_charge]     = ljet.subjet1_charge;
+    *m_featureValues[f_subjet1_mass]       = ljet.subjet1_mass;
+    *m_featureValues[f_subjet1_mrel]       = ljetObservables::get(ljet,ljetObservables::subjet1_mrel);
+    *m_featureValues[f_subjet1_ptrel]      = ljetObservables::get(ljet,ljetObservables::subjet1_ptrel);
+    *m_featureValues[f_subjet1_tau1]       = ljet.subjet1_tau1;
+    *m_featureValues[f_subjet1_tau2]       = ljet.subjet1_tau2;
+    *m_featureValues[f_subjet1_tau3]       = ljet.subjet1_tau3;
+    *m_featureValues[f_subjet1_tau21]      = ljetObservables::get(ljet,ljetObservables::subjet1_tau21);
+    *m_featureValues[f_subjet1_tau32]      = ljetObservables::get(ljet,ljetObservables::subjet1_tau32);
+
+    *m_featureValues[f_charge] = ljet.charge;
+
+    *m_featureValues[f_weight] = 1.;  // 1/ljet.p4.Pt() or something
 
     cma::DEBUG("EVENT : Set DNN input values ");
 
     return;
 }
 
+void deepLearning::initializeCompiled(){
+    /* Bind the inputs & outputs of the compiled network to the maps of features & predictions
+       -- entries of std::map are never moved, and the maps are not cleared after this
+    */
+#ifdef CHEETAH_COMPILED_DNN
+    loadFeatures( Ljet() );    // set every key of the features
+
+    for (unsigned int i=0; i<compiledDNN::nInputs; i++){
+        std::string name(compiledDNN::inputNames[i]);
+        if (m_features.find(name)==m_features.end()){
+            cma::ERROR("DEEPLEARNING : Input "+name+" of the compiled network is not a feature (see loadFeatures()). Aborting!");
+            exit(EXIT_FAILURE);
+        }
+        m_compiledInputs.push_back( &m_features.at(name) );
+    }
+
+    for (unsigned int i=0; i<compiledDNN::nOutputs; i++)
+        m_compiledOutputs.push_back( &m_predictions[compiledDNN::outputNames[i]] );
+
+    if (m_predictions.find(m_dnnKey)==m_predictions.end())
+        cma::WARNING("DEEPLEARNING : dnnKey "+m_dnnKey+" is not an output of the compiled network");
+#endif
+
+    return;
+}
+
+
+void deepLearning::inferenceCompiled(){
+    /* Calculate DNN prediction with the compiled network (fixed sizes, no allocation) */
+#ifdef CHEETAH_COMPILED_DNN
+    double inputs[compiledDNN::nInputs];
+    double outputs[compiledDNN::nOutputs];
+
+    for (unsigned int i=0; i<compiledDNN::nInputs; i++)
+        inputs[i] = *m_compiledInputs[i];
+
+    if (m_backend==floatBackend)
+        compiledDNN::computeFloat(inputs,outputs);
+#ifdef CHEETAH_COMPILED_DNN_INT8
+    else if (m_backend==int8Backend)
+        compiledDNN::computeInt8(inputs,outputs);
+#endif
+    else
+        compiledDNN::compute(inputs,outputs);
+
+    for (unsigned int i=0; i<compiledDNN::nOutputs; i++)
+        *m_compiledOutputs[i] = outputs[i];
+#endif
+
+    return;
+}
+
+
+void deepLearning::validate(const std::map<std::string,double>& lwtnnPredictions){
+    /* Compare the compiled network to lwtnn ('dnnValidate'); the first jet outside of the tolerance
+       is reported when it is found, the number of them & the maximum deviation at the end */
+    bool failed(false);
+    for (const auto& lwtnn : lwtnnPredictions){
+        auto compiled = m_predictions.find(lwtnn.first);
+        if (compiled==m_predictions.end()){
+            cma::WARNING("DEEPLEARNING : Output "+lwtnn.first+" of lwtnn is not an output of the compiled network");
+            continue;
+        }
+
+        double diff = std::abs(compiled->second - lwtnn.second) / std::max(std::abs(lwtnn.second),1.);
+        if (diff>m_maxDeviation){
+            m_maxDeviation = diff;
+            if (cma::debugEnabled()) cma::DEBUG("DEEPLEARNING : New max. deviation from lwtnn for "+lwtnn.first+" = "+std::to_string(diff));
+        }
+
+        if (diff>m_tolerance && !failed){
+            failed = true;
+            if (m_nFailed==0)
+                cma::WARNING("DEEPLEARNING : "+m_config->dnnBackend()+" network differs from lwtnn for "+lwtnn.first+": "+
+                             std::to_string(compiled->second)+" vs "+std::to_string(lwtnn.second)+" (tolerance "+std::to_string(m_tolerance)+")");
+            m_nFailed++;
+        }
+    }
+    m_nValidated++;
+
+    return;
+}
+
+
 double deepLearning::prediction(const std::string& key) const{
     /* Just return the prediction (after execute!) */
     return m_predictions.at(key);
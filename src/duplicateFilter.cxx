@@ -0,0 +1,352 @@
+/*
+Created:        19 October 2026
+Last Updated:   19 October 2026
+
+agent
+agent@local
+-----
+
+Remove events that are in more than one primary dataset
+
+Events are identified by (runNumber, lumiblock, eventNumber), stored
+exactly in 16 bytes. The set is split into shards by the hash of the key;
+each shard is an open-addressing table with its own lock, so the
+filter can be shared by all files and threads of a job.
+
+Duplicates are only found among the inputs of one job: the batch submission
+puts the files of all datasets in the priority list into the same job.
+
+Options:
+  removeDuplicates         turn the filter on (data only)
+  duplicatePriority        datasets in order of priority, e.g., SingleMuon,SingleElectron
+                           (matched to the primary dataset, or to the file path)
+  duplicateMaxMemory       memory for the tables [MB]; full shards are sorted and
+                           moved to disk (0 = keep everything in memory)
+  duplicateSpillDirectory  where the spilled keys are written (removed at the end of the job)
+  duplicateBloomEvents     expected number of events for the Bloom filter (0 = off)
+                           -- new events (most of them) skip the lookup on disk
+*/
+#include "Analysis/cheetah/interface/duplicateFilter.h"
+
+#include <unistd.h>
+
+
+duplicateFilter::duplicateFilter( configuration& cmaConfig ) :
+  m_config(&cmaConfig),
+  m_enabled(false),
+  m_initialCapacity(1024),
+  m_maxCapacity(0),
+  m_spillDirectory("."),
+  m_bloomBits(0),
+  m_bloomHashes(7),
+  m_nSpills(0){
+    m_priority.clear();
+    m_shards.clear();
+  }
+
+duplicateFilter::~duplicateFilter() {
+    /* Remove the spill files */
+    for (auto& s : m_shards){
+        if (!s->spillFile) continue;
+        std::fclose( s->spillFile );
+        std::remove( s->spillName.c_str() );
+    }
+}
+
+
+void duplicateFilter::initialize(){
+    /* Setup the shards, the Bloom filter, and the counters */
+    m_enabled = m_config->removeDuplicates();
+    if (!m_enabled) return;
+
+    m_priority.clear();
+    cma::split( m_config->duplicatePriority(), ',', m_priority );
+
+    unsigned int nShards = 1 << m_shardBits;
+    m_shards.clear();
+    for (unsigned int i=0; i<nShards; i++){
+        m_shards.emplace_back( new shard() );
+        m_shards.back()->size = 0;
+        m_shards.back()->spillFile = nullptr;
+        m_shards.back()->spillSize = 0;
+        m_shards.back()->slots.assign( m_initialCapacity, m_emptyKey );
+    }
+
+    // largest power of 2 that keeps every shard within the memory limit
+    m_maxCapacity = 0;
+    m_spillDirectory = m_config->duplicateSpillDirectory();
+    double maxMemory = m_config->duplicateMaxMemory()*1024.*1024.;
+    if (maxMemory>0){
+        m_maxCapacity = m_initialCapacity;
+        while ((2*m_maxCapacity)*sizeof(eventKey)*nShards <= maxMemory)
+            m_maxCapacity *= 2;
+    }
+
+    // ~10 bits per event & 7 hash functions: ~1% false positives
+    m_bloomBits = 0;
+    m_bloom.reset();
+    unsigned long long bloomEvents = m_config->duplicateBloomEvents();
+    if (bloomEvents>0){
+        unsigned long long nWords = (10*bloomEvents+63)/64;
+        m_bloomBits = nWords*64;
+        m_bloom.reset( new std::atomic<unsigned long long>[nWords] );
+        for (unsigned long long w=0; w<nWords; w++) m_bloom[w] = 0;
+    }
+
+    unsigned int nDatasets = m_priority.size()+1;
+    m_nEvents.reset( new std::atomic<unsigned long long>[nDatasets] );
+    m_nDuplicates.reset( new std::atomic<unsigned long long>[nDatasets] );
+    for (unsigned int d=0; d<nDatasets; d++){
+        m_nEvents[d] = 0;
+        m_nDuplicates[d] = 0;
+    }
+
+    cma::INFO("DUPLICATEFILTER : Removing duplicate events; dataset priority = "+m_config->duplicatePriority());
+
+    return;
+}
+
+
+void duplicateFilter::order( std::vector<std::string>& filenames ) const{
+    /* Files of the preferred datasets first (otherwise keep the order of the list) */
+    std::stable_sort( filenames.begin(), filenames.end(),
+                      [this](const std::string& a, const std::string& b){
+                          return datasetIndex("",a) < datasetIndex("",b);
+                      });
+    return;
+}
+
+
+unsigned int duplicateFilter::datasetIndex( const std::string& primaryDataset, const std::string& filename ) const{
+    /* Position of the dataset in the priority list (size of the list if it isn't listed) */
+    for (unsigned int d=0, size=m_priority.size(); d<size; d++){
+        const std::string& dataset = m_priority.at(d);
+        if (primaryDataset.size()>0 ? primaryDataset.find(dataset)!=std::string::npos : filename.find(dataset)!=std::string::npos)
+            return d;
+    }
+
+    return m_priority.size();
+}
+
+
+std::vector<std::string> duplicateFilter::missingDatasets( const std::vector<std::string>& filenames ) const{
+    /* Datasets in the priority list that none of the inputs belong to */
+    std::vector<bool> found( m_priority.size(), false );
+    for (const auto& filename : filenames){
+        unsigned int d = datasetIndex("",filename);
+        if (d<found.size()) found.at(d) = true;
+    }
+
+    std::vector<std::string> missing;
+    for (unsigned int d=0, size=m_priority.size(); d<size; d++){
+        if (!found.at(d)) missing.push_back( m_priority.at(d) );
+    }
+
+    return missing;
+}
+
+
+bool duplicateFilter::isDuplicate( const unsigned int run, const unsigned int lumiblock, const unsigned long long eventNumber, const unsigned int dataset ){
+    /* Check the event against all events seen before; record it if it is new */
+    eventKey key = { ((unsigned long long)run<<32) | lumiblock, eventNumber };
+    unsigned long long hash = mix(key);
+    unsigned int index = hash >> (64-m_shardBits);
+    shard& s = *m_shards.at(index);
+
+    bool duplicate(false);
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        if (inMemory(s,key,hash))
+            duplicate = true;
+        else if (s.spillFile && (m_bloomBits==0 || bloomContains(hash)) && inSpills(s,key))
+            duplicate = true;
+        else{
+            if (m_maxCapacity>0 && 10*(s.size+1) > 7*s.slots.size() && s.slots.size()>=m_maxCapacity)
+                spill(s,index);
+            insert(s,key,hash);
+            if (m_bloomBits>0) bloomAdd(hash);
+        }
+    }
+
+    unsigned int d = std::min( dataset, (unsigned int)m_priority.size() );
+    m_nEvents[d]++;
+    if (duplicate) m_nDuplicates[d]++;
+
+    return duplicate;
+}
+
+
+bool duplicateFilter::inMemory( const shard& s, const eventKey& key, const unsigned long long hash ) const{
+    /* Linear probing from the home slot until the key or an empty slot is found */
+    std::size_t mask = s.slots.size()-1;
+    for (std::size_t i=hash&mask; ; i=(i+1)&mask){
+        if (s.slots[i]==key) return true;
+        if (s.slots[i]==m_emptyKey) return false;
+    }
+}
+
+
+void duplicateFilter::insert( shard& s, const eventKey& key, const unsigned long long hash ){
+    /* Add a new key (the table grows to keep the load below 70%) */
+    if (10*(s.size+1) > 7*s.slots.size())
+        rehash( s, 2*s.slots.size() );
+
+    std::size_t mask = s.slots.size()-1;
+    std::size_t i = hash&mask;
+    while (!(s.slots[i]==m_emptyKey))
+        i = (i+1)&mask;
+
+    s.slots[i] = key;
+    s.size++;
+
+    return;
+}
+
+
+void duplicateFilter::rehash( shard& s, const std::size_t capacity ){
+    /* Move the keys to a table with a new capacity (power of 2) */
+    std::vector<eventKey> slots( capacity, m_emptyKey );
+    std::size_t mask = capacity-1;
+    for (const auto& key : s.slots){
+        if (key==m_emptyKey) continue;
+        std::size_t i = mix(key)&mask;
+        while (!(slots[i]==m_emptyKey))
+            i = (i+1)&mask;
+        slots[i] = key;
+    }
+    s.slots.swap(slots);
+
+    return;
+}
+
+
+void duplicateFilter::spill( shard& s, const unsigned int index ){
+    /* Merge the keys of a full shard with the keys already on disk (one sorted file per shard) and empty the table */
+    std::vector<eventKey> keys;
+    keys.reserve( s.size );
+    for (const auto& key : s.slots){
+        if (!(key==m_emptyKey)) keys.push_back(key);
+    }
+    std::sort( keys.begin(), keys.end() );
+
+    std::string name = m_spillDirectory+"/duplicates_"+std::to_string(getpid())+"_"+std::to_string(index)+"_"+std::to_string(m_nSpills)+".bin";
+    FILE* file = std::fopen( name.c_str(), "w+b" );
+    bool written = (file!=nullptr);
+
+    // stream the previous file & the new keys into the new file in order
+    long nKeys(0);
+    std::size_t k(0);
+    eventKey previous;
+    if (written && s.spillFile) std::rewind( s.spillFile );
+    for (long p=0; written && p<s.spillSize; p++){
+        if (std::fread( &previous, sizeof(eventKey), 1, s.spillFile )!=1){ written = false; break; }
+        while (k<keys.size() && keys[k]<previous){
+            written &= std::fwrite( &keys[k++], sizeof(eventKey), 1, file )==1;
+            nKeys++;
+        }
+        written &= std::fwrite( &previous, sizeof(eventKey), 1, file )==1;
+        nKeys++;
+    }
+    if (written && k<keys.size()){
+        written = std::fwrite( &keys[k], sizeof(eventKey), keys.size()-k, file )==keys.size()-k;
+        nKeys += keys.size()-k;
+    }
+    if (written) written = std::fflush(file)==0;
+
+    if (!written){
+        cma::WARNING("DUPLICATEFILTER : Cannot write "+name+"; keeping the keys in memory");
+        if (file){
+            std::fclose(file);
+            std::remove(name.c_str());
+        }
+        m_maxCapacity = 0;        // no more attempts
+        return;
+    }
+
+    if (s.spillFile){
+        std::fclose( s.spillFile );
+        std::remove( s.spillName.c_str() );
+    }
+    s.spillFile = file;
+    s.spillName = name;
+    s.spillSize = nKeys;
+    m_nSpills++;
+
+    s.size = 0;
+    std::vector<eventKey>( m_initialCapacity, m_emptyKey ).swap( s.slots );
+
+    return;
+}
+
+
+bool duplicateFilter::inSpills( const shard& s, const eventKey& key ) const{
+    /* Binary search of the sorted keys on disk (positioned reads: no stdio buffering) */
+    int fd = fileno( s.spillFile );
+    long low(0);
+    long high(s.spillSize-1);
+    while (low<=high){
+        long middle = low + (high-low)/2;
+        eventKey value;
+        if (pread( fd, &value, sizeof(eventKey), middle*sizeof(eventKey) )!=sizeof(eventKey)) break;
+
+        if (value==key) return true;
+        if (value<key) low = middle+1;
+        else high = middle-1;
+    }
+
+    return false;
+}
+
+
+bool duplicateFilter::bloomContains( const unsigned long long hash ) const{
+    /* All bits of the key are set (or a false positive) */
+    unsigned long long h1 = hash;
+    unsigned long long h2 = (hash>>32) | 1;
+    for (unsigned int k=0; k<m_bloomHashes; k++){
+        unsigned long long bit = (h1 + k*h2) % m_bloomBits;
+        if (!(m_bloom[bit/64].load(std::memory_order_relaxed) & (1ULL<<(bit%64))))
+            return false;
+    }
+    return true;
+}
+
+
+void duplicateFilter::bloomAdd( const unsigned long long hash ){
+    /* Set the bits of the key (atomic: shards share the words of the filter) */
+    unsigned long long h1 = hash;
+    unsigned long long h2 = (hash>>32) | 1;
+    for (unsigned int k=0; k<m_bloomHashes; k++){
+        unsigned long long bit = (h1 + k*h2) % m_bloomBits;
+        m_bloom[bit/64].fetch_or( 1ULL<<(bit%64), std::memory_order_relaxed );
+    }
+    return;
+}
+
+
+unsigned long long duplicateFilter::mix( const eventKey& key ){
+    /* 64-bit hash of the key (splitmix64 finalizer) */
+    unsigned long long h = key.runLumi*0x9E3779B97F4A7C15ULL ^ key.event;
+    h ^= h >> 30; h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27; h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return h;
+}
+
+
+void duplicateFilter::summary() const{
+    /* Print the number of events and duplicates in each dataset */
+    if (!m_enabled) return;
+
+    for (unsigned int d=0, size=m_priority.size(); d<=size; d++){
+        if (m_nEvents[d]<1) continue;
+        std::string dataset = (d<size) ? m_priority.at(d) : "other";
+        cma::INFO("DUPLICATEFILTER : "+dataset+" : "+std::to_string(m_nDuplicates[d])+" duplicates in "+std::to_string(m_nEvents[d])+" events");
+    }
+    if (m_nSpills>0)
+        cma::INFO("DUPLICATEFILTER : Moved "+std::to_string(m_nSpills)+" tables to "+m_spillDirectory);
+
+    return;
+}
+
+// THE END
@@ -32,7 +32,17 @@ eventSelection::eventSelection(configuration &cmaConfig, const std::string &leve
   m_selection("SetMe"),
   m_cutsfile("SetMe"),
   m_numberOfCuts(0),
-  m_dummySelection(false){
+  m_dummySelection(false),
+  m_leptonChannel(ljets),
+  m_ljets(nullptr),
+  m_jets(nullptr),
+  m_muons(nullptr),
+  m_electrons(nullptr),
+  m_leptons(nullptr),
+  m_neutrinos(nullptr),
+  m_triggers(nullptr),
+  m_filters(nullptr),
+  m_ttbar1L(nullptr){
     m_cuts.resize(0);
     m_cutflowNames.clear();
   }
@@ -86,17 +96,52 @@ void eventSelection::initialize(const std::string &cutsfile) {
 
 
 void eventSelection::identifySelection(){
-    /* Set the booleans for applying the selection below */
-    m_dummySelection  = m_selection.compare("none")==0;            // no selection
-    m_mcDNNSelection  = m_selection.compare("mcDNN")==0;           // setup for all-had DNN
-    m_isCWoLaAnalysis = m_selection.compare("cwola")==0	     ||
-                        m_selection.compare("cwolaejets")==0 ||
-                        m_selection.compare("cwolamujets")==0;     // setup for CWoLa (data selection)
+    /* Resolve the selection into the chain of stages applied to each event
+       -- add new selections here (applySelection() runs whatever is in the chain)
+    */
+    m_stages.clear();
+
+    m_dummySelection = m_selection.compare("none")==0;            // no selection
+    if (m_dummySelection) return;
+
+    addStage("filters", &eventSelection::filterSelection, 1);
+
+    if (m_selection.compare("mcDNN")==0)                          // setup for all-had DNN
+        addStage("mcDNN", &eventSelection::mcDNNSelection, 1);
+    else if (m_selection.compare("cwola")==0      ||
+             m_selection.compare("cwolaejets")==0 ||
+             m_selection.compare("cwolamujets")==0){                // setup for CWoLa (data selection)
+        m_leptonChannel = (m_selection.find("ejets")!=std::string::npos) ? ejets : mujets;
+        addStage("oneLepton", &eventSelection::oneLeptonSelection, 6);
+        if (m_leptonChannel==ejets)
+            addStage("ejets", &eventSelection::ejetsSelection, 3);
+        else
+            addStage("mujets", &eventSelection::mujetsSelection, 1);
+        addStage("cwola", &eventSelection::cwolaSelection, 2);
+    }
+    else{
+        cma::WARNING("EVENTSELECTION : Selection "+m_selection+" is not defined; no events will pass");
+        addStage("reject", &eventSelection::rejectSelection, 0);
+    }
+
+    // cutflow bin 0 is INITIAL (not a cut)
+    unsigned int nCuts = m_stages.back().firstBin + m_stages.back().nBins - 1;
+    if (nCuts!=m_numberOfCuts)
+        cma::WARNING("EVENTSELECTION : "+m_selection+" has "+std::to_string(nCuts)+" cuts but "+m_cutsfile+" lists "+std::to_string(m_numberOfCuts));
+
     return;
 }
 
 
-void eventSelection::setCutflowHistograms(TFile& outputFile){
+void eventSelection::addStage(const std::string& name, stageFunction apply, const unsigned int nBins){
+    /* Add a stage to the end of the chain (its cutflow bins follow the previous stage) */
+    unsigned int firstBin = (m_stages.size()>0) ? m_stages.back().firstBin+m_stages.back().nBins : 1;
+    m_stages.push_back( {name, apply, firstBin, nBins} );
+    return;
+}
+
+
+void eventSelection::setCutflowHistograms(TDirectory& outputDir){
     /* Set the cutflow histograms to use in the framework -- 
        can modify this function to generate histograms with different names
        e.g., based on the name of the TTree 
@@ -105,7 +150,7 @@ void eventSelection::setCutflowHistograms(TFile& outputFile){
          "cutflow"            event weights
          "cutflow_unweighted" no event weights -> raw event numbers
     */
-    outputFile.cd();
+    outputDir.cd();
 
     m_cutflow     = new TH1D( (m_selection+"_cutflow").c_str(),(m_selection+"_cutflow").c_str(),m_numberOfCuts+1,0,m_numberOfCuts+1);
     m_cutflow_unw = new TH1D( (m_selection+"_cutflow_unweighted").c_str(),(m_selection+"_cutflow_unweighted").c_str(),m_numberOfCuts+1,0,m_numberOfCuts+1);
@@ -135,35 +180,35 @@ void eventSelection::setObjects(const Event& event) {
     // FIRST CHECK IF VALID EVENT FROM TREE
     m_valid = event.isValidRecoEntry();
 
-    // set physics objects
-    m_jets  = event.jets();
-    m_ljets = event.ljets();
-    m_leptons = event.leptons();       // contains electrons and muons
-    //m_muons = event.muons();
-    //m_electrons = event.electrons();
-    m_neutrinos = event.neutrinos();
+    // set physics objects (point to the Event collections -- no copies)
+    m_jets  = &event.jets();
+    m_ljets = &event.ljets();
+    m_leptons = &event.leptons();      // contains electrons and muons
+    //m_muons = &event.muons();
+    //m_electrons = &event.electrons();
+    m_neutrinos = &event.neutrinos();
     m_met = event.met();
     m_ht  = event.HT();
     m_st  = event.ST();
 
-    m_triggers = event.triggers();
-    m_filters  = event.filters();
+    m_triggers = &event.triggers();
+    m_filters  = &event.filters();
     // add more objects as needed
 
-    m_Nbtags     = event.btag_jets().size();
-    m_NLjets     = m_ljets.size();
-    m_NJets      = m_jets.size();
-    m_NLeptons   = m_leptons.size();
+    m_Nbtags     = event.nbtags();
+    m_NLjets     = m_ljets->size();
+    m_NJets      = m_jets->size();
+    m_NLeptons   = m_leptons->size();
 
     m_NMuons     = 0;   //m_muons.size();
     m_NElectrons = 0;   //m_electrons.size();
-    for (const auto x : m_leptons){
+    for (const auto& x : *m_leptons){
         if (x.isMuon) m_NMuons++;
         else m_NElectrons++;
     }
 
     // ttbar system(s)
-    m_ttbar1L = event.ttbar1L();
+    m_ttbar1L = &event.ttbar1L();
 
     return;
 }
@@ -174,9 +219,9 @@ bool eventSelection::applySelection() {
        Example Cut::
           if (n_jets==3 && n_ljets<1)  FAIL
           else :                       PASS & fill cutflows
-    */
-    bool passSelection(false);
 
+       The stages were resolved from the selection name in identifySelection()
+    */
     float cf_bin(0.5);            // bin value in cutflow histogram ("INITIAL")
 
     // FIRST CHECK IF VALID EVENT FROM TREE
@@ -188,41 +233,39 @@ bool eventSelection::applySelection() {
     fillCutflows(cf_bin);      // fillCutflows() iterates 'cf_bin'
 
 
-    // no selection applied
-    if (m_dummySelection)
-        return true;              // event 'passed'  
+    // Perform selections
+    for (const auto& stage : m_stages){
+        cf_bin = stage.firstBin + 0.5;
+        if ( !(this->*stage.apply)(cf_bin) )
+            return false;
+    }
 
+    return true;
+}
 
-    // Perform selections
-    // -- use if/else if statements to maintain orthogonality
 
-    // -- Filter (only necessary for data)
-    bool passFilter(true);
+// ******************************************************* //
+// Put selections in functions (allow other selections to call them!)
+bool eventSelection::filterSelection(float& cutflow_bin){
+    /* MET filters (only necessary for data) */
     if (!m_config->isMC()){
-        for (const auto& x : m_filters){
-            if (!x.second){
-                passFilter = false;
-                break;
-            }
+        for (const auto& x : *m_filters){
+            if (!x.second)
+                return false;
         }
     }
-    if (!passFilter) return false;
-    fillCutflows(cf_bin);
+    fillCutflows(cutflow_bin);
 
-    // -- All-hadronic DNN
-    if (m_mcDNNSelection)
-        passSelection = mcDNNSelection(cf_bin);
+    return true;
+}
 
-    // -- preparing inputs for CWoLa
-    else if (m_isCWoLaAnalysis)
-        passSelection = cwolaSelection(cf_bin);
 
-    return passSelection;
+bool eventSelection::rejectSelection(float& cutflow_bin){
+    /* Unknown selection: no events pass */
+    return false;
 }
 
 
-// ******************************************************* //
-// Put selections in functions (allow other selections to call them!)
 bool eventSelection::mcDNNSelection(float& cutflow_bin){
     /* Check if event passes selection */
     bool pass(false);
@@ -244,21 +287,9 @@ bool eventSelection::mcDNNSelection(float& cutflow_bin){
 
 // ******************************************************* //
 bool eventSelection::cwolaSelection(float& cutflow_bin){
-    /* Check if event passes selection */
-    bool pass_basic(false);
-
-    // Standard 1-lepton selection
-    if (m_selection.find("ejets")!=std::string::npos)
-        pass_basic = ejetsSelection(cutflow_bin);
-    else
-        pass_basic = mujetsSelection(cutflow_bin);
-
-    if (!pass_basic) 
-        return false;
-    else
-        fillCutflows(cutflow_bin);
-
-
+    /* Check if event passes selection 
+       -- after the 1-lepton selection (oneLeptonSelection + ejetsSelection/mujetsSelection stages)
+    */
     // cut0 :: 1 b-tag
     if ( m_Nbtags<1 )
         return false;
@@ -267,7 +298,7 @@ bool eventSelection::cwolaSelection(float& cutflow_bin){
 
 
     // cut1 :: BEST(top)>0.1
-    Ljet hadtop_ak8 = m_ttbar1L.ljet;
+    const Ljet& hadtop_ak8 = m_ttbar1L->ljet;
     if ( hadtop_ak8.BEST_t<0.1 )
         return false;
     else
@@ -277,27 +308,17 @@ bool eventSelection::cwolaSelection(float& cutflow_bin){
 }
 
 
-bool eventSelection::ejetsSelection(float& cutflow_bin, std::string selection){
-    /* Check if event passes selection; called from 1-lepton selection
+bool eventSelection::ejetsSelection(float& cutflow_bin){
+    /* Check if event passes selection; after the 1-lepton selection stage
        -- Following CMS AN-2016/174
     */
-    if (selection.size()<1) selection = m_selection;
-
-    // Standard 1-lepton selection
-    bool pass = oneLeptonSelection(cutflow_bin,selection);
-    if (!pass)
-        return false;
-    else
-        fillCutflows(cutflow_bin);
-
-
     // cut5 :: MET > 50 GeV
     if ( m_met.p4.Pt() < 50 )
         return false;
     else
         fillCutflows(cutflow_bin);
 
-    Lepton lep = m_leptons.at(0);
+    const Lepton& lep = m_leptons->at(0);
     // cut6 :: DeltaPhi(e,MET)
     float met_triangle = 1.5*m_met.p4.Pt() / 110.;
     if ( std::abs(lep.p4.DeltaPhi(m_met.p4)-1.5) > met_triangle )
@@ -307,7 +328,7 @@ bool eventSelection::ejetsSelection(float& cutflow_bin, std::string selection){
 
 
     // cut7 :: DeltaPhi(leading AK4,MET)
-    if ( std::abs(m_jets.at(0).p4.DeltaPhi(m_met.p4)-1.5) > met_triangle )
+    if ( std::abs(m_jets->at(0).p4.DeltaPhi(m_met.p4)-1.5) > met_triangle )
         return false;
     else
         fillCutflows(cutflow_bin);
@@ -316,20 +337,10 @@ bool eventSelection::ejetsSelection(float& cutflow_bin, std::string selection){
 }
 
 
-bool eventSelection::mujetsSelection(float& cutflow_bin, std::string selection){
-    /* Check if event passes selection; called from 1-lepton selection
+bool eventSelection::mujetsSelection(float& cutflow_bin){
+    /* Check if event passes selection; after the 1-lepton selection stage
        -- Following CMS AN-2016/174
     */
-    if (selection.size()<1) selection = m_selection;
-
-    // Standard 1-lepton selection
-    bool pass = oneLeptonSelection(cutflow_bin,selection);
-    if (!pass)
-        return false;
-    else
-        fillCutflows(cutflow_bin);
-
-
     // cut5 :: MET > 35 GeV
     if ( m_met.p4.Pt() < 35 )
         return false;
@@ -340,24 +351,18 @@ bool eventSelection::mujetsSelection(float& cutflow_bin, std::string selection){
 }
 
 
-bool eventSelection::oneLeptonSelection(float& cutflow_bin, std::string selection){
+bool eventSelection::oneLeptonSelection(float& cutflow_bin){
     /* Single lepton selection following CMS AN-2016/174 (el+jets or mu+jets)
        -- add b-tagging, others?
        -- separate boosted (AK8) & resolved (4 AK4)?
        Only perform relevant selection
-       e.g., if user selected "ejets", don't do mu+jets selection!
+       e.g., if user selected "ejets", don't do mu+jets selection! (m_leptonChannel)
     */
-    if (selection.size()<1) selection = m_selection;
-
-    bool ejets  = selection.compare("ejets")==0;
-    bool mujets = selection.compare("mujets")==0;
-    bool ljets  = ((!ejets && !mujets) || selection.compare("ljets")==0);  // general "lepton+jets" selection
-
     // cut0 :: One lepton
     bool nLeptons(false);
-    if (ejets)       nLeptons = (m_NElectrons==1 && m_NMuons==0);
-    else if (mujets) nLeptons = (m_NMuons==1 && m_NElectrons==0);
-    else if (ljets)  nLeptons = (m_NLeptons==1);
+    if (m_leptonChannel==ejets)       nLeptons = (m_NElectrons==1 && m_NMuons==0);
+    else if (m_leptonChannel==mujets) nLeptons = (m_NMuons==1 && m_NElectrons==0);
+    else                              nLeptons = (m_NLeptons==1);
 
     if ( !nLeptons )
         return false;               // exit the function now; no need to test other cuts!
@@ -367,9 +372,9 @@ bool eventSelection::oneLeptonSelection(float& cutflow_bin, std::string selectio
 
     // cut1 :: triggers -- ejets is lepton==electron else mujets
     unsigned int passTrig(0);
-    std::vector<std::string> oneLeptonTriggers = (m_leptons.at(0).isElectron) ? m_ejetsTriggers : m_mujetsTriggers;
+    const std::vector<std::string>& oneLeptonTriggers = (m_leptons->at(0).isElectron) ? m_ejetsTriggers : m_mujetsTriggers;
     for (const auto& trig : oneLeptonTriggers){
-        if (m_triggers.at(trig)) passTrig++;
+        if (m_triggers->at(trig)) passTrig++;
     }
 
     if (passTrig<1)
@@ -394,7 +399,7 @@ bool eventSelection::oneLeptonSelection(float& cutflow_bin, std::string selectio
 
     // cut4 :: DeltaR(AK4,lepton)
     //         >=1 AK4 jet in the same hemisphere as the electron, 0.3 < R(l,jet) < pi/2
-    Jet leptop_ak4 = m_ttbar1L.jet;
+    const Jet& leptop_ak4 = m_ttbar1L->jet;
     if (!leptop_ak4.isGood)
         return false;
     else
@@ -404,7 +409,7 @@ bool eventSelection::oneLeptonSelection(float& cutflow_bin, std::string selectio
     // cut5 :: DeltaR(AK8,lepton)
     //         >=1 AK8 jet in the opposite hemisphere from the electron, R(l,jet) > pi/2
     //         mark any AK8 jets that don't meet this requirement as "isGood=false"
-    Ljet hadtop_ak8 = m_ttbar1L.ljet;
+    const Ljet& hadtop_ak8 = m_ttbar1L->ljet;
     if (!hadtop_ak8.isGood)
         return false;
     else
@@ -426,6 +431,26 @@ void eventSelection::fillCutflows(float& cutflow_bin){
     return;
 }
 
+bool eventSelection::restoreCutflows(const TH1& cutflow, const TH1& cutflow_unweighted){
+    /* Add cutflows from a previous run of this selection (same cuts) */
+    if (cutflow.GetNbinsX()!=m_cutflow->GetNbinsX() || cutflow_unweighted.GetNbinsX()!=m_cutflow_unw->GetNbinsX()){
+        cma::WARNING("EVENTSELECTION : Cannot restore cutflows of "+m_selection+"; number of cuts changed");
+        return false;
+    }
+
+    m_cutflow->Add(&cutflow);
+    m_cutflow_unw->Add(&cutflow_unweighted);
+
+    return true;
+}
+
+
+std::string eventSelection::codeVersion(){
+    /* Version of the selection code (see m_codeVersion in the header) */
+    return "eventSelection v"+std::to_string(m_codeVersion);
+}
+
+
 void eventSelection::getCutNames(){
     /* Get the cut names (for labeling bins in cutflow histograms) and store in vector */
     m_cutflowNames.clear();
@@ -0,0 +1,197 @@
+/*
+Created:        19 October 2026
+Last Updated:   19 October 2026
+
+agent
+agent@local
+-----
+
+Persistent index of input file metadata
+
+Stores, per input file, the information that otherwise
+requires opening and scanning the file:
+  number of entries, list of keys, and primary dataset
+The sample normalization is not stored: it is always taken from the
+metadata file, which can be edited without the input files changing.
+
+Entries are keyed by the file path and are only used
+if the size and modification time of the file are unchanged.
+
+Jobs that share an index share the file: write() holds a lock
+(<index>.lock) while it merges the files inspected in this job
+with the entries already in the file.
+
+Format (one line per file, space-separated):
+  filename size modtime treename entries primaryDataset key1,key2,...
+*/
+#include "Analysis/cheetah/interface/fileIndex.h"
+
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+
+fileIndex::fileIndex( configuration& cmaConfig ) :
+  m_config(&cmaConfig),
+  m_indexFile(""){
+    m_entries.clear();
+    m_current.clear();
+  }
+
+fileIndex::~fileIndex() {}
+
+
+void fileIndex::initialize( const std::string& indexFile ){
+    /* Load the existing index -- a missing index file is not an error */
+    m_indexFile = indexFile;
+    m_entries.clear();
+    m_current.clear();
+
+    if (!enabled()) return;
+
+    if (!read(m_entries)){
+        cma::INFO("FILEINDEX : No index found at "+m_indexFile+"; creating a new one");
+        return;
+    }
+
+    cma::INFO("FILEINDEX : Loaded "+std::to_string(m_entries.size())+" files from "+m_indexFile);
+
+    return;
+}
+
+
+bool fileIndex::read( std::map<std::string,fileIndexEntry>& entries ){
+    /* Add the entries of the index file (false if it does not exist) */
+    std::ifstream file(m_indexFile.c_str());
+    if (!file) return false;
+
+    std::string line;
+    while (std::getline(file, line)){
+        if (line.size()<1 || line.find("#")==0) continue;
+
+        std::istringstream lineStream(line);
+        fileIndexEntry entry;
+        std::string keys("");
+        std::string extra("");
+        lineStream >> entry.filename >> entry.size >> entry.modtime >> entry.treename >> entry.entries
+                   >> entry.primaryDataset >> keys;
+
+        // lines of the previous format (with the normalization) have extra columns: inspect these files again
+        if (lineStream.fail() || (lineStream >> extra)){
+            cma::WARNING("FILEINDEX : Skipping malformed line in "+m_indexFile);
+            continue;
+        }
+        // "-" is written for empty values
+        if (entry.treename.compare("-")==0) entry.treename = "";
+        if (entry.primaryDataset.compare("-")==0) entry.primaryDataset = "";
+
+        entry.keys.clear();
+        if (keys.compare("-")!=0) cma::split(keys, ',', entry.keys);
+
+        entries[entry.filename] = entry;
+    }
+
+    return true;
+}
+
+
+bool fileIndex::lookup( const std::string& filename, fileIndexEntry& entry ){
+    /* Return the entry if the file has not changed since it was indexed */
+    if (!enabled()) return false;
+
+    long long size(0);
+    long modtime(0);
+    if (!fingerprint(filename,size,modtime)) return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto match = m_entries.find(filename);
+    if (match==m_entries.end()) return false;
+
+    if (match->second.size!=size || match->second.modtime!=modtime)
+        return false;                       // file changed -- need to inspect it again
+
+    entry = match->second;
+
+    return true;
+}
+
+
+void fileIndex::update( const fileIndexEntry& entry ){
+    /* Add or replace an entry (fingerprint taken now) */
+    if (!enabled()) return;
+
+    fileIndexEntry newEntry(entry);
+    if (!fingerprint(newEntry.filename,newEntry.size,newEntry.modtime)) return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries[newEntry.filename] = newEntry;
+    m_current[newEntry.filename] = newEntry;
+
+    return;
+}
+
+
+void fileIndex::write(){
+    /* Save the index (write a temporary file and move it into place)
+       - entries written by other jobs are kept; files inspected in this job are replaced
+       - the lock serializes jobs that finish at the same time
+    */
+    if (!enabled()) return;
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (m_current.size()<1) return;
+
+    std::string lockFile = m_indexFile+".lock";
+    int lock = open(lockFile.c_str(), O_RDWR | O_CREAT, 0644);
+    if (lock<0 || flock(lock, LOCK_EX)!=0)
+        cma::WARNING("FILEINDEX : Cannot lock "+lockFile+"; entries of jobs writing at the same time may be lost");
+
+    std::map<std::string,fileIndexEntry> entries(m_entries);
+    read(entries);                                   // entries written by other jobs since initialize()
+    for (const auto& x : m_current)
+        entries[x.first] = x.second;
+
+    std::string tmpFile = m_indexFile+".tmp"+std::to_string(getpid());
+    std::ofstream file(tmpFile.c_str());
+    file << "# filename size modtime treename entries primaryDataset keys\n";
+
+    for (const auto& x : entries){
+        const fileIndexEntry& entry = x.second;
+        std::string tree = (entry.treename.size()>0) ? entry.treename : "-";
+        std::string pd   = (entry.primaryDataset.size()>0) ? entry.primaryDataset : "-";
+        std::string keys = (entry.keys.size()>0) ? cma::vectorToStr(entry.keys) : "-";
+
+        file << entry.filename << " " << entry.size << " " << entry.modtime << " " << tree << " " << entry.entries << " "
+             << pd << " " << keys << "\n";
+    }
+    file.close();
+
+    std::rename(tmpFile.c_str(), m_indexFile.c_str());
+
+    if (lock>=0){
+        flock(lock, LOCK_UN);
+        close(lock);
+    }
+
+    cma::INFO("FILEINDEX : Saved "+std::to_string(m_current.size())+" files of this job to "+m_indexFile+" ("+std::to_string(entries.size())+" in total)");
+    m_current.clear();
+
+    return;
+}
+
+
+bool fileIndex::fingerprint( const std::string& filename, long long& size, long& modtime ){
+    /* Size and modification time of the file (xrootd paths go through the ROOT plugin) */
+    FileStat_t stat;
+    if (gSystem->GetPathInfo(filename.c_str(), stat)!=0)
+        return false;
+
+    size    = stat.fSize;
+    modtime = stat.fMtime;
+
+    return true;
+}
+
+// THE END
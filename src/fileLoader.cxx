@@ -0,0 +1,102 @@
+/*
+Created:        19 October 2026
+Last Updated:   19 October 2026
+
+agent
+agent@local
+-----
+
+Prepare input files for the event loop
+
+While the event loop runs over file N, file N+1 is
+opened, inspected, and its list of keys is loaded
+on a helper thread.
+  - Requires ROOT::EnableThreadSafety() in the steering macro
+*/
+#include "Analysis/cheetah/interface/fileLoader.h"
+
+
+fileLoader::fileLoader() :
+  m_index(nullptr),
+  m_metadataTreeName(""),
+  m_nextFile(0){
+    m_filenames.clear();
+  }
+
+fileLoader::~fileLoader() {
+    /* Don't leave a helper thread running */
+    if (m_prepared.valid())
+        m_prepared.wait();
+}
+
+
+void fileLoader::initialize( const std::vector<std::string>& filenames, const std::string& metadataTreeName ){
+    /* Set the files to process and start preparing the first one */
+    m_filenames = filenames;
+    m_metadataTreeName = metadataTreeName;
+    m_nextFile = 0;
+
+    prepareNext();
+
+    return;
+}
+
+
+bool fileLoader::next( inputFile& input ){
+    /* Wait for the prepared file, then start on the next one */
+    if (!m_prepared.valid())
+        return false;          // no more files
+
+    input = m_prepared.get();
+    prepareNext();
+
+    return true;
+}
+
+
+void fileLoader::prepareNext(){
+    /* Launch the helper thread for the next file in the list */
+    if (m_nextFile>=m_filenames.size())
+        return;
+
+    cma::DEBUG("FILELOADER : Preparing "+m_filenames.at(m_nextFile));
+    m_prepared = std::async(std::launch::async, &fileLoader::prepare, m_filenames.at(m_nextFile), m_metadataTreeName, m_index);
+    m_nextFile++;
+
+    return;
+}
+
+
+inputFile fileLoader::prepare( const std::string filename, const std::string metadataTreeName, fileIndex* index ){
+    /* Open the file, read the metadata, and get the list of keys
+       - No messages printed here (this runs concurrently with the event loop)
+       - Metadata and keys come from the file index if the file is unchanged
+    */
+    inputFile input;
+    input.filename = filename;
+    input.primaryDataset = "";
+    input.isValid   = false;
+    input.isIndexed = false;
+
+    input.file.reset( TFile::Open(filename.c_str()) );
+    if (!input.file || input.file->IsZombie())
+        return input;
+
+    input.isValid = true;
+
+    // an entry without a primary dataset was indexed without the metadata tree: inspect the file again
+    if (index!=nullptr && index->lookup(filename, input.metadata) &&
+        (input.metadata.primaryDataset.size()>0 || metadataTreeName.size()<1)){
+        input.isIndexed = true;
+        input.primaryDataset = input.metadata.primaryDataset;
+        input.keys = input.metadata.keys;
+        return input;
+    }
+
+    input.primaryDataset = configuration::readPrimaryDataset( *input.file, metadataTreeName );
+    cma::getListOfKeys( input.file.get(), input.keys );    // keep track of ttrees in file
+
+    return input;
+}
+
+// THE END
@@ -22,9 +22,9 @@ histogrammer::~histogrammer() {}
 
 
 /**** INITIALIZE HISTOGRAMS ****/
-void histogrammer::initialize( TFile& outputFile ){
+void histogrammer::initialize( TDirectory& outputDir ){
     /* Setup some values and book histograms */
-    outputFile.cd();
+    outputDir.cd();
 
     bookHists();
 
@@ -68,40 +68,36 @@ void histogrammer::bookHists(){
         histogrammerBase::init_hist("ljet_subjet1_charge-"+target+"_"+m_name,100,  -5,   5);
     }
 
+    // look up the histograms once (fill() uses the indices)
+    m_histIndex.clear();
+    for (const auto& target : m_targets){
+        m_histIndex.push_back( std::vector<int>() );
+        for (const auto& feature : m_features)
+            m_histIndex.back().push_back( histogrammerBase::histogramIndex(feature+"-"+target+"_"+m_name) );
+    }
+
     return;
 }
 
 
 /**** FILL HISTOGRAMS ****/
-void histogrammer::fill( const std::map<std::string,double> features, double weight ){
+void histogrammer::fill( const std::map<std::string,double>& features, double weight, const int slot ){
     /* Fill histograms -- 
        Fill information from single top object (inputs to deep learning)
     */
-    std::string target = std::to_string( int(features.at("target")) );
-
-    cma::DEBUG("HISTOGRAMMER : Fill histograms: "+m_name+"; target = "+target);
-
-    histogrammerBase::fill("ljet_BEST_t-"+target+"_"+m_name, features.at("ljet_BEST_t"), weight);
-    histogrammerBase::fill("ljet_BEST_w-"+target+"_"+m_name, features.at("ljet_BEST_w"), weight);
-    histogrammerBase::fill("ljet_BEST_z-"+target+"_"+m_name, features.at("ljet_BEST_z"), weight);
-    histogrammerBase::fill("ljet_BEST_h-"+target+"_"+m_name, features.at("ljet_BEST_h"), weight);
-    histogrammerBase::fill("ljet_BEST_j-"+target+"_"+m_name, features.at("ljet_BEST_j"), weight);
-    histogrammerBase::fill("ljet_SDmass-"+target+"_"+m_name, features.at("ljet_SDmass"), weight);
-    histogrammerBase::fill("ljet_tau1-"+target+"_"+m_name,   features.at("ljet_tau1"),  weight);
-    histogrammerBase::fill("ljet_tau2-"+target+"_"+m_name,   features.at("ljet_tau2"),  weight);
-    histogrammerBase::fill("ljet_tau3-"+target+"_"+m_name,   features.at("ljet_tau3"),  weight);
-    histogrammerBase::fill("ljet_tau21-"+target+"_"+m_name,  features.at("ljet_tau21"), weight);
-    histogrammerBase::fill("ljet_tau32-"+target+"_"+m_name,  features.at("ljet_tau32"), weight);
-
-    histogrammerBase::fill("ljet_charge-"+target+"_"+m_name, features.at("ljet_charge"), weight);
-    histogrammerBase::fill("ljet_subjet0_bdisc-"+target+"_"+m_name,  features.at("ljet_subjet0_bdisc"),  weight);
-    histogrammerBase::fill("ljet_subjet0_mass-"+target+"_"+m_name,   features.at("ljet_subjet0_mass"),   weight);
-    histogrammerBase::fill("ljet_subjet0_ptrel-"+target+"_"+m_name,  features.at("ljet_subjet0_ptrel"),  weight);
-    histogrammerBase::fill("ljet_subjet0_charge-"+target+"_"+m_name, features.at("ljet_subjet0_charge"), weight);
-    histogrammerBase::fill("ljet_subjet1_bdisc-"+target+"_"+m_name,  features.at("ljet_subjet1_bdisc"),  weight);
-    histogrammerBase::fill("ljet_subjet1_mass-"+target+"_"+m_name,   features.at("ljet_subjet1_mass"),   weight);
-    histogrammerBase::fill("ljet_subjet1_ptrel-"+target+"_"+m_name,  features.at("ljet_subjet1_ptrel"),  weight);
-    histogrammerBase::fill("ljet_subjet1_charge-"+target+"_"+m_name, features.at("ljet_subjet1_charge"), weight);
+    int target = int(features.at("target"));
+    if (target<0 || target>=static_cast<int>(m_histIndex.size())){
+        cma::WARNING("HISTOGRAMMER : No histograms for target "+std::to_string(target));
+        return;
+    }
+
+    if (cma::debugEnabled()) cma::DEBUG("HISTOGRAMMER : Fill histograms: "+m_name+"; target = "+std::to_string(target));
+
+    const std::vector<int>& histIndex = m_histIndex[target];
+    for (unsigned int i=0, size=m_features.size(); i<size; i++){
+        if (histIndex[i]<0) continue;
+        histogrammerBase::fill(slot, static_cast<unsigned int>(histIndex[i]), features.at(m_features[i]), weight);
+    }
 
     cma::DEBUG("HISTOGRAMMER : End histograms");
 
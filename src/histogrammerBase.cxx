@@ -18,10 +18,14 @@ histogrammerBase::histogrammerBase( configuration& cmaConfig, std::string name )
   m_config(&cmaConfig),
   m_name(name),
   m_putOverflowInLastBin(true),
-  m_putUnderflowInFirstBin(true){
+  m_putUnderflowInFirstBin(true),
+  m_slotSize(0){
     m_map_histograms1D.clear();
     m_map_histograms2D.clear();
     m_map_histograms3D.clear();
+    m_slotIndex.clear();
+    m_slotHistograms.clear();
+    m_slots.clear();
 
     if (m_name.length()>0  && m_name.substr(m_name.length()-1,1).compare("_")!=0)
         m_name = m_name+"_"; // add '_' to end of string, if needed
@@ -37,6 +41,7 @@ void histogrammerBase::init_hist( const std::string& name, const unsigned int nB
     /* Initialize histogram -- equal bins */
     m_map_histograms1D["h_"+name] = new TH1D(("h_"+name).c_str(), ("h_"+name).c_str(),nBins,x_min,x_max);
     m_map_histograms1D["h_"+name]->Sumw2();
+    bookSlots( m_map_histograms1D["h_"+name] );
 
     return;
 }
@@ -44,6 +49,7 @@ void histogrammerBase::init_hist( const std::string& name, const unsigned int nB
     /* Initialize histogram -- variable bins */
     m_map_histograms1D["h_"+name] = new TH1D(("h_"+name).c_str(), ("h_"+name).c_str(),nBins,xbins);
     m_map_histograms1D["h_"+name]->Sumw2();
+    bookSlots( m_map_histograms1D["h_"+name] );
 
     return;
 }
@@ -54,6 +60,7 @@ void histogrammerBase::init_hist( const std::string& name, const unsigned int nB
     m_map_histograms2D["h_"+name] = new TH2D(("h_"+name).c_str(), ("h_"+name).c_str(),
                                             nBinsX,x_min,x_max,nBinsY,y_min,y_max);
     m_map_histograms2D["h_"+name]->Sumw2();
+    bookSlots( m_map_histograms2D["h_"+name] );
 
     return;
 }
@@ -63,6 +70,7 @@ void histogrammerBase::init_hist( const std::string& name, const unsigned int nB
     m_map_histograms2D["h_"+name] = new TH2D(("h_"+name).c_str(), ("h_"+name).c_str(),
                                            nBinsX,xbins,nBinsY,ybins);
     m_map_histograms2D["h_"+name]->Sumw2();
+    bookSlots( m_map_histograms2D["h_"+name] );
 
     return;
 }
@@ -74,6 +82,7 @@ void histogrammerBase::init_hist( const std::string& name, const unsigned int nB
     m_map_histograms3D["h_"+name] = new TH3D(("h_"+name).c_str(), ("h_"+name).c_str(),
                                             nBinsX,x_min,x_max,nBinsY,y_min,y_max,nBinsZ,z_min,z_max);
     m_map_histograms3D["h_"+name]->Sumw2();
+    bookSlots( m_map_histograms3D["h_"+name] );
 
     return;
 }
@@ -84,6 +93,7 @@ void histogrammerBase::init_hist( const std::string& name, const unsigned int nB
     m_map_histograms3D["h_"+name] = new TH3D(("h_"+name).c_str(), ("h_"+name).c_str(),
                                            nBinsX,xbins,nBinsY,ybins,nBinsZ,zbins);
     m_map_histograms3D["h_"+name]->Sumw2();
+    bookSlots( m_map_histograms3D["h_"+name] );
 
     return;
 }
@@ -131,10 +141,232 @@ void histogrammerBase::fill( const std::string& name,
 }
 
 
+/**** FILL HISTOGRAMS FROM SEVERAL THREADS ****/
+
+void histogrammerBase::setNumberOfSlots( const unsigned int nSlots ){
+    /* One slot per thread that fills histograms -- call before the event loop
+       (anything already in the slots is added to the histograms first)
+    */
+    reduce();
+
+    m_slots.clear();
+    m_slots.resize( nSlots, std::vector<double>(m_slotSize+2*m_cacheLine, 0.) );
+
+    return;
+}
+
+void histogrammerBase::bookSlots( TH1* hist ){
+    /* Reserve space for a new histogram in every slot */
+    slotHistogram histogram;
+    histogram.hist   = hist;
+    histogram.offset = m_slotSize;
+    histogram.nCells = hist->GetNcells();
+
+    m_slotIndex[hist->GetName()] = m_slotHistograms.size();
+    m_slotHistograms.push_back(histogram);
+
+    m_slotSize += 2*histogram.nCells+1+m_nStats;       // sumw, sumw2, entries, statistics
+    for (auto& slot : m_slots)
+        slot.resize( m_slotSize+2*m_cacheLine, 0. );
+
+    return;
+}
+
+int histogrammerBase::histogramIndex( const std::string& name ) const{
+    /* Index of a histogram for the slot fill functions (no string or map lookup per event) */
+    auto match = m_slotIndex.find("h_"+name);
+    if (match==m_slotIndex.end()){
+        cma::ERROR("HISTOGRAMMERBASE : Histogram with key '"+name+"': KEY DOES NOT EXIST");
+        cma::ERROR("HISTOGRAMMERBASE : Please check 'init_hist' and 'histogramIndex' functions");
+        return -1;
+    }
+
+    return match->second;
+}
+
+double* histogrammerBase::slotCells( const int slot, const unsigned int index ){
+    /* Bin contents of a histogram in one slot (nullptr if either doesn't exist) */
+    if (index>=m_slotHistograms.size() || slot>=static_cast<int>(m_slots.size())){
+        cma::ERROR("HISTOGRAMMERBASE : Filling histogram "+std::to_string(index)+" in slot "+std::to_string(slot)+": HISTOGRAM OR SLOT DOES NOT EXIST");
+        cma::ERROR("HISTOGRAMMERBASE : Please check 'init_hist', 'setNumberOfSlots', and 'fill' functions");
+        return nullptr;
+    }
+
+    return m_slots.at(slot).data() + m_cacheLine + m_slotHistograms.at(index).offset;   // skip the padding
+}
+
+void histogrammerBase::addEntry( double* cells, const slotHistogram& histogram, const int bin, const double& weight, const bool inRange ) const{
+    /* Bin content, error, entries, and the sums of weights for the statistics (in-range values only, as TH1::Fill) */
+    cells[bin] += weight;
+    cells[histogram.nCells+bin] += weight*weight;
+    cells[2*histogram.nCells]   += 1;
+
+    if (inRange){
+        double* stats = cells+2*histogram.nCells+1;
+        stats[0] += weight;
+        stats[1] += weight*weight;
+    }
+
+    return;
+}
+
+
+void histogrammerBase::fill( const int slot, const unsigned int index, const double& value, const double& weight ){
+    /* TH1D */
+    if (slot<0){
+        m_slotHistograms.at(index).hist->Fill(value,weight);
+        return;
+    }
+
+    double* cells = slotCells(slot,index);
+    if (cells==nullptr) return;
+
+    const slotHistogram& histogram = m_slotHistograms[index];
+    const TAxis* xaxis = histogram.hist->GetXaxis();
+    int bin = xaxis->FindFixBin(value);
+    bool inRange = (bin>0 && bin<=xaxis->GetNbins());
+    addEntry( cells, histogram, bin, weight, inRange );
+
+    if (inRange){
+        double* stats = cells+2*histogram.nCells+1;
+        stats[2] += weight*value;
+        stats[3] += weight*value*value;
+    }
+
+    return;
+}
+void histogrammerBase::fill( const int slot, const unsigned int index,
+                         const double& xvalue, const double& yvalue, const double& weight ){
+    /* TH2D */
+    if (slot<0){
+        static_cast<TH2*>(m_slotHistograms.at(index).hist)->Fill(xvalue,yvalue,weight);
+        return;
+    }
+
+    double* cells = slotCells(slot,index);
+    if (cells==nullptr) return;
+
+    const slotHistogram& histogram = m_slotHistograms[index];
+    const TH1* hist = histogram.hist;
+    int binx = hist->GetXaxis()->FindFixBin(xvalue);
+    int biny = hist->GetYaxis()->FindFixBin(yvalue);
+    bool inRange = (binx>0 && binx<=hist->GetXaxis()->GetNbins() && biny>0 && biny<=hist->GetYaxis()->GetNbins());
+    addEntry( cells, histogram, hist->GetBin(binx,biny), weight, inRange );
+
+    if (inRange){
+        double* stats = cells+2*histogram.nCells+1;
+        stats[2] += weight*xvalue;
+        stats[3] += weight*xvalue*xvalue;
+        stats[4] += weight*yvalue;
+        stats[5] += weight*yvalue*yvalue;
+        stats[6] += weight*xvalue*yvalue;
+    }
+
+    return;
+}
+void histogrammerBase::fill( const int slot, const unsigned int index,
+                         const double& xvalue, const double& yvalue, const double& zvalue, const double& weight ){
+    /* TH3D */
+    if (slot<0){
+        static_cast<TH3*>(m_slotHistograms.at(index).hist)->Fill(xvalue,yvalue,zvalue,weight);
+        return;
+    }
+
+    double* cells = slotCells(slot,index);
+    if (cells==nullptr) return;
+
+    const slotHistogram& histogram = m_slotHistograms[index];
+    const TH1* hist = histogram.hist;
+    int binx = hist->GetXaxis()->FindFixBin(xvalue);
+    int biny = hist->GetYaxis()->FindFixBin(yvalue);
+    int binz = hist->GetZaxis()->FindFixBin(zvalue);
+    bool inRange = (binx>0 && binx<=hist->GetXaxis()->GetNbins() && biny>0 && biny<=hist->GetYaxis()->GetNbins() &&
+                    binz>0 && binz<=hist->GetZaxis()->GetNbins());
+    addEntry( cells, histogram, hist->GetBin(binx,biny,binz), weight, inRange );
+
+    if (inRange){
+        double* stats = cells+2*histogram.nCells+1;
+        stats[2]  += weight*xvalue;
+        stats[3]  += weight*xvalue*xvalue;
+        stats[4]  += weight*yvalue;
+        stats[5]  += weight*yvalue*yvalue;
+        stats[6]  += weight*xvalue*yvalue;
+        stats[7]  += weight*zvalue;
+        stats[8]  += weight*zvalue*zvalue;
+        stats[9]  += weight*xvalue*zvalue;
+        stats[10] += weight*yvalue*zvalue;
+    }
+
+    return;
+}
+
+
+void histogrammerBase::fill( const int slot, const std::string& name, const double& value, const double& weight ){
+    /* TH1D -- by name (slower: prefer histogramIndex() once and the index in the event loop) */
+    int index = histogramIndex(name);
+    if (index>=0) fill(slot,static_cast<unsigned int>(index),value,weight);
+    return;
+}
+void histogrammerBase::fill( const int slot, const std::string& name,
+                         const double& xvalue, const double& yvalue, const double& weight ){
+    /* TH2D -- by name */
+    int index = histogramIndex(name);
+    if (index>=0) fill(slot,static_cast<unsigned int>(index),xvalue,yvalue,weight);
+    return;
+}
+void histogrammerBase::fill( const int slot, const std::string& name,
+                         const double& xvalue, const double& yvalue, const double& zvalue, const double& weight ){
+    /* TH3D -- by name */
+    int index = histogramIndex(name);
+    if (index>=0) fill(slot,static_cast<unsigned int>(index),xvalue,yvalue,zvalue,weight);
+    return;
+}
+
+
+void histogrammerBase::reduce(){
+    /* Add the content of all slots to the histograms and empty the slots
+       - Not thread-safe: call once the threads are done filling
+       - Each slot becomes a histogram with its own statistics, added with TH1::Add
+         (the mean & RMS of the filled values are kept, not recomputed from the bins)
+    */
+    for (const auto& histogram : m_slotHistograms){
+        TH1* hist = histogram.hist;
+        std::unique_ptr<TH1> partial;
+
+        for (auto& slot : m_slots){
+            double* cells = slot.data() + m_cacheLine + histogram.offset;
+            double entries = cells[2*histogram.nCells];
+            if (entries<=0) continue;
+
+            if (!partial){
+                partial.reset( static_cast<TH1*>(hist->Clone()) );
+                partial->SetDirectory(nullptr);
+            }
+            partial->Reset();
+
+            TArrayD* sumw2 = partial->GetSumw2();
+            for (unsigned int bin=0; bin<histogram.nCells; bin++){
+                partial->SetBinContent(bin, cells[bin]);
+                sumw2->fArray[bin] = cells[histogram.nCells+bin];
+            }
+            partial->PutStats( cells+2*histogram.nCells+1 );   // after SetBinContent, which resets them
+            partial->SetEntries( entries );
+
+            hist->Add( partial.get() );
+
+            std::fill( cells, cells+2*histogram.nCells+1+m_nStats, 0. );
+        }
+    }
+
+    return;
+}
+
+
 /**** OVER/UNDERFLOW ****/
 
 void histogrammerBase::overUnderFlow(){
-    /* Call overflow and underflow functions at once */
+    /* Call overflow and underflow functions at once (after collecting the per-thread slots) */
+    reduce();
     overFlow();
     underFlow();
     return;
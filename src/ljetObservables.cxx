@@ -0,0 +1,65 @@
+/*
+Created:        19 October 2026
+Last Updated:   19 October 2026
+
+agent
+agent@local
+-----
+
+Observables derived from large-R jet attributes
+
+Add new observables to the enum in the header and to the table below
+(same order). They are only computed if a cut, histogram, feature,
+or network asks for them.
+*/
+#include "Analysis/cheetah/interface/ljetObservables.h"
+
+
+namespace ljetObservables {
+
+namespace {
+    // TLorentzVector::M() & Pt() involve a sqrt -- cache them too
+    float computePt( const Ljet& ljet )   {return ljet.p4.Pt();}
+    float computeMass( const Ljet& ljet ) {return ljet.p4.M();}
+
+    float computeTau21( const Ljet& ljet ) {return ljet.tau2 / ljet.tau1;}
+    float computeTau32( const Ljet& ljet ) {return ljet.tau3 / ljet.tau2;}
+
+    float computeSubjet0Mrel( const Ljet& ljet )  {return ljet.subjet0_mass / get(ljet,mass);}
+    float computeSubjet0Ptrel( const Ljet& ljet ) {return ljet.subjet0_pt / get(ljet,pt);}
+    float computeSubjet0Tau21( const Ljet& ljet ) {return ljet.subjet0_tau2 / ljet.subjet0_tau1;}
+    float computeSubjet0Tau32( const Ljet& ljet ) {return ljet.subjet0_tau3 / ljet.subjet0_tau2;}
+
+    float computeSubjet1Mrel( const Ljet& ljet )  {return ljet.subjet1_mass / get(ljet,mass);}
+    float computeSubjet1Ptrel( const Ljet& ljet ) {return ljet.subjet1_pt / get(ljet,pt);}
+    float computeSubjet1Tau21( const Ljet& ljet ) {return ljet.subjet1_tau2 / ljet.subjet1_tau1;}
+    float computeSubjet1Tau32( const Ljet& ljet ) {return ljet.subjet1_tau3 / ljet.subjet1_tau2;}
+}
+
+const definition definitions[nObservables] = {
+    {"ljet_pt",   computePt},
+    {"ljet_mass", computeMass},
+    {"ljet_tau21", computeTau21},
+    {"ljet_tau32", computeTau32},
+    {"ljet_subjet0_mrel",  computeSubjet0Mrel},
+    {"ljet_subjet0_ptrel", computeSubjet0Ptrel},
+    {"ljet_subjet0_tau21", computeSubjet0Tau21},
+    {"ljet_subjet0_tau32", computeSubjet0Tau32},
+    {"ljet_subjet1_mrel",  computeSubjet1Mrel},
+    {"ljet_subjet1_ptrel", computeSubjet1Ptrel},
+    {"ljet_subjet1_tau21", computeSubjet1Tau21},
+    {"ljet_subjet1_tau32", computeSubjet1Tau32}
+};
+
+
+int find( const std::string& name ){
+    /* Observable from its name */
+    for (unsigned int i=0; i<nObservables; i++){
+        if (name.compare(definitions[i].name)==0) return i;
+    }
+    return -1;
+}
+
+} // end namespace
+
+// THE END
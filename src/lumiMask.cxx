@@ -0,0 +1,193 @@
+/*
+Created:        19 October 2026
+Last Updated:   19 October 2026
+
+agent
+agent@local
+-----
+
+Certified luminosity sections for data
+
+Reads the certification JSON, e.g.,
+  {"273150": [[61, 64], [66, 75]], "273158": [[1, 1279]]}
+into a sorted list of runs and, for each run, a sorted list of
+merged ranges of luminosity sections.
+A lookup is two binary searches (run, then range).
+
+Events in sections outside the mask fail the "lumiMask" filter (Event).
+The processed, certified sections are written in the same format
+so the integrated luminosity of the processed data can be calculated.
+Each job writes the sections of its own inputs (processedLumis_<first input>.json);
+the reports of all jobs are combined for the luminosity.
+*/
+#include "Analysis/cheetah/interface/lumiMask.h"
+
+
+lumiMask::lumiMask( configuration& cmaConfig ) :
+  m_config(&cmaConfig),
+  m_jsonFile(""){
+    m_runs.clear();
+    m_offsets.clear();
+    m_ranges.clear();
+    m_processed.clear();
+    m_rejected.clear();
+  }
+
+lumiMask::~lumiMask() {}
+
+
+void lumiMask::initialize( const std::string& jsonFile ){
+    /* Parse the JSON file into the run & range index */
+    m_jsonFile = jsonFile;
+    m_runs.clear();
+    m_offsets.clear();
+    m_ranges.clear();
+
+    if (!enabled()) return;
+
+    std::ifstream file = cma::open_file( m_jsonFile );
+    std::stringstream contents;
+    contents << file.rdbuf();
+    std::string text = contents.str();
+
+    // {"run": [[first,last], ...], ...}
+    std::map<unsigned int,std::vector<std::pair<unsigned int,unsigned int> > > runs;   // sorted by run
+    std::size_t pos(0);
+    while ((pos = text.find('"',pos))!=std::string::npos){
+        std::size_t end = text.find('"',pos+1);
+        std::size_t open = text.find('[',end);
+        if (end==std::string::npos || open==std::string::npos) break;
+
+        unsigned int run = std::stoul( text.substr(pos+1,end-pos-1) );
+
+        std::vector<unsigned int> numbers;
+        int depth(0);
+        for (pos=open; pos<text.size(); pos++){
+            char c = text[pos];
+            if (c=='[') depth++;
+            else if (c==']'){
+                if (--depth==0) break;
+            }
+            else if (std::isdigit(c)){
+                std::size_t length(0);
+                numbers.push_back( std::stoul(text.substr(pos,20),&length) );
+                pos += length-1;
+            }
+        }
+
+        if (depth!=0 || numbers.size()%2!=0){
+            cma::ERROR("LUMIMASK : Cannot read the ranges of run "+std::to_string(run)+" in "+m_jsonFile);
+            exit(EXIT_FAILURE);
+        }
+
+        std::vector<std::pair<unsigned int,unsigned int> >& ranges = runs[run];   // a repeated run is merged
+        for (unsigned int i=0, size=numbers.size(); i<size; i+=2)
+            ranges.push_back( std::make_pair(numbers.at(i),numbers.at(i+1)) );
+    }
+
+    // sorted & merged ranges (the lookups assume no overlaps)
+    for (auto& run : runs){
+        std::sort( run.second.begin(), run.second.end() );
+        m_runs.push_back( run.first );
+        m_offsets.push_back( m_ranges.size() );
+        for (const auto& range : run.second){
+            if (m_ranges.size()>m_offsets.back() && range.first<=m_ranges.back().second+1)
+                m_ranges.back().second = std::max( m_ranges.back().second, range.second );
+            else
+                m_ranges.push_back( range );
+        }
+    }
+    m_offsets.push_back( m_ranges.size() );
+
+    cma::INFO("LUMIMASK : "+std::to_string(m_runs.size())+" runs and "+std::to_string(m_ranges.size())+" ranges of luminosity sections from "+m_jsonFile);
+
+    return;
+}
+
+
+bool lumiMask::certified( const unsigned int run, const unsigned int lumiblock ) const{
+    /* Binary search of the run, then of the last range that starts at or before the luminosity section */
+    auto found = std::lower_bound( m_runs.begin(), m_runs.end(), run );
+    if (found==m_runs.end() || *found!=run)
+        return false;
+
+    unsigned int index = found - m_runs.begin();
+    auto first = m_ranges.begin()+m_offsets.at(index);
+    auto last  = m_ranges.begin()+m_offsets.at(index+1);
+
+    auto range = std::upper_bound( first, last, lumiblock,
+                                   [](const unsigned int lumi, const std::pair<unsigned int,unsigned int>& r){return lumi<r.first;} );
+    if (range==first)
+        return false;
+
+    --range;
+    return lumiblock<=range->second;
+}
+
+
+void lumiMask::addProcessed( const unsigned int run, const unsigned int lumiblock, const bool certified ){
+    /* Keep the certified sections (for the luminosity) and the rejected ones (for the summary) */
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (certified)
+        m_processed.insert( std::make_pair(run,lumiblock) );
+    else
+        m_rejected.insert( std::make_pair(run,lumiblock) );
+
+    return;
+}
+
+
+void lumiMask::report( const std::string& filename ) const{
+    /* Write the processed & certified sections as JSON (consecutive sections merged into ranges) */
+    if (!enabled()) return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::ofstream output( filename.c_str() );
+    output << "{";
+
+    unsigned int currentRun(0);
+    unsigned int first(0);
+    unsigned int last(0);
+    bool firstRun(true);
+    for (auto section=m_processed.begin(); section!=m_processed.end(); ++section){
+        bool newRun = (section==m_processed.begin() || section->first!=currentRun);
+
+        if (!newRun && section->second==last+1){
+            last = section->second;         // extend the current range
+            continue;
+        }
+
+        if (section!=m_processed.begin())
+            output << "[" << first << ", " << last << "]" << (newRun ? "]" : ", ");
+        if (newRun){
+            output << (firstRun ? "" : ", ") << "\"" << section->first << "\": [";
+            firstRun = false;
+            currentRun = section->first;
+        }
+        first = section->second;
+        last  = section->second;
+    }
+    if (m_processed.size()>0)
+        output << "[" << first << ", " << last << "]]";
+    output << "}" << std::endl;
+
+    cma::INFO("LUMIMASK : Processed luminosity sections written to "+filename);
+
+    return;
+}
+
+
+void lumiMask::summary() const{
+    /* Number of processed sections inside & outside the mask */
+    if (!enabled()) return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    cma::INFO("LUMIMASK : Processed "+std::to_string(m_processed.size())+" certified luminosity sections");
+    if (m_rejected.size()>0)
+        cma::INFO("LUMIMASK : Rejected events from "+std::to_string(m_rejected.size())+" luminosity sections outside the mask");
+
+    return;
+}
+
+// THE END
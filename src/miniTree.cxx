@@ -20,13 +20,13 @@ miniTree::miniTree(configuration &cmaConfig) :
 miniTree::~miniTree() {}
 
 
-void miniTree::initialize(TFile& outputFile) {
+void miniTree::initialize(TDirectory& outputDir) {
     /*
        Setup the new tree 
        Contains features for the NN
        --  No vector<T> stored in tree: completely flat!
     */
-    outputFile.cd();                                     // move to output file
+    outputDir.cd();                                      // move to output file (or directory)
     m_ttree        = new TTree("features", "features");  // Tree contains features for the NN
     m_metadataTree = new TTree("metadata","metadata");   // Tree contains metadata
 
@@ -77,6 +77,15 @@ void miniTree::initialize(TFile& outputFile) {
     m_ttree->Branch( "ljet_isHadTop",&m_ljet_isHadTop, "ljet_isHadTop/i" );
     m_ttree->Branch( "ljet_contain", &m_ljet_contain,  "ljet_contain/I" );
 
+    // float branches are copied from the features with the same name (keys are only built here)
+    m_floatFeatures.clear();
+    TIter next( m_ttree->GetListOfBranches() );
+    while (TBranch* branch = static_cast<TBranch*>(next())){
+        TLeaf* leaf = branch->GetLeaf( branch->GetName() );
+        if (leaf && std::string(leaf->GetTypeName()).compare("Float_t")==0)
+            m_floatFeatures.push_back( std::make_pair( std::string(branch->GetName()), reinterpret_cast<float*>(branch->GetAddress()) ) );
+    }
+
     /**** Metadata ****/
     // which sample has which target value
     // many ROOT files will be merged together to do the training
@@ -89,57 +98,19 @@ void miniTree::initialize(TFile& outputFile) {
 
 
 
-void miniTree::saveEvent(const std::map<std::string,double> features) {
+void miniTree::saveEvent(const std::map<std::string,double>& features) {
     /* Save the ML features to the ttree! */
     cma::DEBUG("MINITREE : Save event ");
 
-    m_weight   = features.at("weight");
-    m_kfactor  = features.at("kfactor");
-    m_xsection = features.at("xsection");
-    m_sumOfWeights   = features.at("sumOfWeights");
-    m_nominal_weight = features.at("nominal_weight");
+    for (const auto& feature : m_floatFeatures)
+        *feature.second = features.at(feature.first);
 
     m_target = features.at("target");
-
-    m_ljet_charge = features.at("ljet_charge");
-    m_ljet_subjet0_bdisc  = features.at("ljet_subjet0_bdisc");
-    m_ljet_subjet0_charge = features.at("ljet_subjet0_charge");
-    m_ljet_subjet0_mass   = features.at("ljet_subjet0_mass");
-    m_ljet_subjet0_mrel   = features.at("ljet_subjet0_mrel");
-    m_ljet_subjet0_ptrel  = features.at("ljet_subjet0_ptrel");
-    m_ljet_subjet0_tau1   = features.at("ljet_subjet0_tau1");
-    m_ljet_subjet0_tau2   = features.at("ljet_subjet0_tau2");
-    m_ljet_subjet0_tau3   = features.at("ljet_subjet0_tau3");
-    m_ljet_subjet0_tau21  = features.at("ljet_subjet0_tau21");
-    m_ljet_subjet0_tau32  = features.at("ljet_subjet0_tau32");
-
-    m_ljet_subjet1_bdisc  = features.at("ljet_subjet1_bdisc");
-    m_ljet_subjet1_charge = features.at("ljet_subjet1_charge");
-    m_ljet_subjet1_mass   = features.at("ljet_subjet1_mass");
-    m_ljet_subjet1_mrel   = features.at("ljet_subjet1_mrel");
-    m_ljet_subjet1_ptrel  = features.at("ljet_subjet1_ptrel");
-    m_ljet_subjet1_tau1   = features.at("ljet_subjet1_tau1");
-    m_ljet_subjet1_tau2   = features.at("ljet_subjet1_tau2");
-    m_ljet_subjet1_tau3   = features.at("ljet_subjet1_tau3");
-    m_ljet_subjet1_tau21  = features.at("ljet_subjet1_tau21");
-    m_ljet_subjet1_tau32  = features.at("ljet_subjet1_tau32");
-
-    m_ljet_BEST_t = features.at("ljet_BEST_t");
-    m_ljet_BEST_w = features.at("ljet_BEST_w");
-    m_ljet_BEST_z = features.at("ljet_BEST_z");
-    m_ljet_BEST_h = features.at("ljet_BEST_h");
-    m_ljet_BEST_j = features.at("ljet_BEST_j");
-    m_ljet_SDmass = features.at("ljet_SDmass");
-    m_ljet_tau1   = features.at("ljet_tau1");
-    m_ljet_tau2   = features.at("ljet_tau2");
-    m_ljet_tau3   = features.at("ljet_tau3");
-    m_ljet_tau21  = features.at("ljet_tau21");
-    m_ljet_tau32  = features.at("ljet_tau32");
     m_ljet_isHadTop = static_cast<unsigned int>(features.at("ljet_isHadTop"));
     m_ljet_contain  = static_cast<int>(features.at("ljet_contain"));
 
     /**** Fill the tree ****/
-    cma::DEBUG("MINITREE : had top "+std::to_string(features.at("ljet_isHadTop")));
+    if (cma::debugEnabled()) cma::DEBUG("MINITREE : had top "+std::to_string(features.at("ljet_isHadTop")));
     cma::DEBUG("MINITREE : Fill the tree");
     m_ttree->Fill();
 
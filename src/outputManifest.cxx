@@ -0,0 +1,179 @@
+/*
+Created:        19 October 2026
+Last Updated:   19 October 2026
+
+agent
+agent@local
+-----
+
+Manifest of output files for incremental processing
+
+Each output file is recorded with a fingerprint of its input
+(path, size, modification time, number of entries), the entries
+[begin,end) of the input it contains, and a hash of the configuration
+and code that made it.
+Entries are keyed by the output: with nJobs>1 each job writes its own
+output (<name>_job<i>.root) from the same input.
+In incremental mode, inputs with an up-to-date output are skipped.
+
+The output file is the first column, so the manifest can be
+passed directly to 'merge' as the list of files to merge.
+
+Jobs that share an output directory share the manifest: write() holds
+a lock (<manifest>.lock) while it merges this job's outputs with the
+entries already in the file, so entries of other jobs and of previous
+runs are kept.
+
+Format (one line per output file, space-separated):
+  output input size modtime entries begin end configHash
+*/
+#include "Analysis/cheetah/interface/outputManifest.h"
+#include "Analysis/cheetah/interface/fileIndex.h"
+
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+
+outputManifest::outputManifest( configuration& cmaConfig ) :
+  m_config(&cmaConfig),
+  m_manifestFile(""),
+  m_configHash(""){
+    m_previous.clear();
+    m_current.clear();
+  }
+
+outputManifest::~outputManifest() {}
+
+
+void outputManifest::initialize( const std::string& manifestFile, const std::string& configHash ){
+    /* Load the manifest of the previous run -- a missing manifest is not an error */
+    m_manifestFile = manifestFile;
+    m_configHash   = configHash;
+    m_previous.clear();
+    m_current.clear();
+
+    if (!read(m_previous)){
+        cma::INFO("MANIFEST : No manifest found at "+m_manifestFile+"; processing all inputs");
+        return;
+    }
+
+    cma::INFO("MANIFEST : Loaded "+std::to_string(m_previous.size())+" outputs from "+m_manifestFile);
+
+    return;
+}
+
+
+bool outputManifest::read( std::map<std::string,manifestEntry>& entries ){
+    /* Add the entries of the manifest file (false if it does not exist) */
+    std::ifstream file(m_manifestFile.c_str());
+    if (!file) return false;
+
+    std::string line;
+    while (std::getline(file, line)){
+        if (line.size()<1 || line.find("#")==0) continue;
+
+        std::istringstream lineStream(line);
+        manifestEntry entry;
+        lineStream >> entry.output >> entry.input >> entry.size >> entry.modtime >> entry.entries
+                   >> entry.begin >> entry.end >> entry.configHash;
+
+        if (lineStream.fail()){   // includes lines of the previous format (no segment): the output is made again
+            cma::WARNING("MANIFEST : Skipping malformed line in "+m_manifestFile);
+            continue;
+        }
+
+        entries[entry.output] = entry;
+    }
+
+    return true;
+}
+
+
+bool outputManifest::upToDate( const std::string& input, const std::string& output, const long long entries,
+                               const long long begin, const long long end ){
+    /* Compare the input, its entries in the output & the configuration with the previous run */
+    auto match = m_previous.find(output);
+    if (match==m_previous.end()) return false;            // new output
+
+    const manifestEntry& previous = match->second;
+
+    long long size(0);
+    long modtime(0);
+    if (!fileIndex::fingerprint(input,size,modtime)) return false;
+
+    if (previous.input.compare(input)!=0 ||
+        previous.size!=size || previous.modtime!=modtime || previous.entries!=entries ||
+        previous.begin!=begin || previous.end!=end ||
+        previous.configHash.compare(m_configHash)!=0)
+        return false;                                      // changed input or configuration
+
+    if (gSystem->AccessPathName(output.c_str())) return false;   // output was removed
+
+    m_current[output] = previous;
+
+    return true;
+}
+
+
+void outputManifest::update( const std::string& input, const std::string& output, const long long entries,
+                             const long long begin, const long long end ){
+    /* Add the output made in this job (fingerprint taken now) */
+    manifestEntry entry;
+    entry.output  = output;
+    entry.input   = input;
+    entry.entries = entries;
+    entry.begin   = begin;
+    entry.end     = end;
+    entry.configHash = m_configHash;
+
+    if (!fileIndex::fingerprint(input,entry.size,entry.modtime)) return;
+
+    m_current[output] = entry;
+
+    return;
+}
+
+
+void outputManifest::write(){
+    /* Save the manifest (write a temporary file and move it into place)
+       - entries of the previous run and of other jobs are kept; outputs made in this job are replaced
+       - the lock serializes jobs that finish at the same time
+    */
+    if (m_manifestFile.size()<1) return;
+
+    std::string lockFile = m_manifestFile+".lock";
+    int lock = open(lockFile.c_str(), O_RDWR | O_CREAT, 0644);
+    if (lock<0 || flock(lock, LOCK_EX)!=0)
+        cma::WARNING("MANIFEST : Cannot lock "+lockFile+"; entries of jobs writing at the same time may be lost");
+
+    std::map<std::string,manifestEntry> entries(m_previous);
+    read(entries);                                   // entries written by other jobs since initialize()
+    for (const auto& x : m_current)
+        entries[x.first] = x.second;
+
+    std::string tmpFile = m_manifestFile+".tmp"+std::to_string(getpid());
+    std::ofstream file(tmpFile.c_str());
+    file << "# output input size modtime entries begin end configHash\n";
+
+    for (const auto& x : entries){
+        const manifestEntry& entry = x.second;
+        file << entry.output << " " << entry.input << " " << entry.size << " " << entry.modtime << " "
+             << entry.entries << " " << entry.begin << " " << entry.end << " " << entry.configHash << "\n";
+    }
+    file.close();
+
+    std::rename(tmpFile.c_str(), m_manifestFile.c_str());
+
+    if (lock>=0){
+        flock(lock, LOCK_UN);
+        close(lock);
+    }
+
+    cma::INFO("MANIFEST : Saved "+std::to_string(m_current.size())+" outputs of this job to "+m_manifestFile+" ("+std::to_string(entries.size())+" in total)");
+
+    return;
+}
+
+// THE END
@@ -0,0 +1,441 @@
+/*
+Created:        19 October 2026
+Last Updated:   19 October 2026
+
+agent
+agent@local
+-----
+
+Merge the outputs of many cheetah jobs into one file
+
+  Histograms  Each thread sums the histograms of its share of the files;
+              the partial sums are then combined in pairs (log2(nThreads) steps)
+  Trees       Baskets are copied without decompression ('fast' cloning);
+              each file is opened once, by its histogram thread, and handed
+              over to the tree copy (in the order of the inputs)
+  Metadata    Rebuilt with one entry per sample name (nEvents summed)
+  Cutflows    Binning and bin labels must agree between files and the
+              unweighted cutflow must not increase from one cut to the next
+
+Requires ROOT::EnableThreadSafety() in the steering macro
+*/
+#include "Analysis/cheetah/interface/outputMerger.h"
+
+
+outputMerger::outputMerger() :
+  m_nThreads(1),
+  m_nextTreeFile(0),
+  m_maxOpenFiles(1){
+    m_filenames.clear();
+    m_trees.clear();
+    m_metadata.clear();
+    m_treeErrors.clear();
+    m_warnings.clear();
+    m_openedFiles.clear();
+  }
+
+outputMerger::~outputMerger() {}
+
+
+void outputMerger::initialize( const std::vector<std::string>& filenames, const unsigned int nThreads ){
+    /* Set the files to merge and the number of threads used for the histograms
+       - nThreads=0 : use all available cores
+    */
+    m_filenames = filenames;
+
+    m_nThreads = (nThreads>0) ? nThreads : std::thread::hardware_concurrency();
+    if (m_nThreads<1) m_nThreads = 1;
+    if (m_nThreads>m_filenames.size()) m_nThreads = m_filenames.size();
+
+    m_openedFiles.clear();
+    m_openedFiles.resize( m_filenames.size() );
+    for (auto& opened : m_openedFiles) opened.ready = false;
+    m_nextTreeFile = 0;
+    m_maxOpenFiles = 2*m_nThreads;
+
+    cma::INFO("OUTPUTMERGER : Merging "+std::to_string(m_filenames.size())+" files with "+std::to_string(m_nThreads)+" threads");
+
+    return;
+}
+
+
+bool outputMerger::execute( const std::string& outputFilename ){
+    /* Merge all of the files */
+    if (m_filenames.size()<1){
+        cma::ERROR("OUTPUTMERGER : No input files to merge");
+        return false;
+    }
+
+    std::unique_ptr<TFile> outputFile( TFile::Open(outputFilename.c_str(),"RECREATE") );
+    if (!outputFile || outputFile->IsZombie()){
+        cma::ERROR("OUTPUTMERGER : Cannot create output file "+outputFilename);
+        return false;
+    }
+
+    // -- Histograms: partial sums on worker threads -- //
+    std::vector<histogramMap> histograms(m_nThreads);
+    std::vector<std::vector<std::string> > errors(m_nThreads);
+    std::vector<std::thread> workers;
+
+    for (unsigned int t=0; t<m_nThreads; t++)
+        workers.emplace_back( &outputMerger::reduceHistograms, this, t, std::ref(histograms.at(t)), std::ref(errors.at(t)) );
+
+    // -- Trees: copied on this thread from the files the workers have read -- //
+    mergeTrees( *outputFile );
+
+    for (auto& worker : workers) worker.join();
+
+    for (const auto& warning : m_warnings)
+        cma::WARNING("OUTPUTMERGER : "+warning);
+
+    // -- Combine the partial sums in pairs -- //
+    for (unsigned int step=1; step<m_nThreads; step*=2){
+        workers.clear();
+        for (unsigned int t=0; t+step<m_nThreads; t+=2*step){
+            workers.emplace_back( [this,&histograms,&errors,t,step](){
+                combine( histograms.at(t), histograms.at(t+step), errors.at(t) );
+                for (const auto& err : errors.at(t+step)) errors.at(t).push_back(err);
+            });
+        }
+        for (auto& worker : workers) worker.join();
+    }
+
+    // -- Consistency checks -- //
+    std::vector<std::string>& allErrors = errors.at(0);
+    allErrors.insert( allErrors.end(), m_treeErrors.begin(), m_treeErrors.end() );
+    if (allErrors.size()>0){
+        for (const auto& err : allErrors)
+            cma::ERROR("OUTPUTMERGER : "+err);
+        cma::ERROR("OUTPUTMERGER : Inputs are not consistent -- not writing "+outputFilename);
+
+        outputFile->Close();
+        gSystem->Unlink( outputFilename.c_str() );
+        return false;
+    }
+
+    // -- Write the output -- //
+    for (const auto& hist : histograms.at(0)){
+        cma::getDirectory( *outputFile, directoryName(hist.first) )->cd();
+        hist.second->Write( objectName(hist.first).c_str(), TObject::kOverwrite );
+    }
+    writeMetadata( *outputFile );
+
+    outputFile->Close();
+    cma::INFO("OUTPUTMERGER : Wrote "+outputFilename);
+
+    return true;
+}
+
+
+/**** HISTOGRAMS ****/
+
+void outputMerger::reduceHistograms( const unsigned int thread, histogramMap& histograms, std::vector<std::string>& errors ){
+    /* Sum the histograms in every m_nThreads-th file, starting from file 'thread' */
+    for (unsigned int f=thread; f<m_filenames.size(); f+=m_nThreads){
+        const std::string& filename = m_filenames.at(f);
+
+        waitForTurn(f);                       // don't read too far ahead of the tree copy
+
+        std::unique_ptr<TFile> file( TFile::Open(filename.c_str()) );
+        if (!file || file->IsZombie()){
+            errors.push_back("Cannot open "+filename);
+            handOver( f, nullptr, {} );
+            continue;
+        }
+
+        std::vector<std::string> histNames;
+        std::vector<std::string> treeNames;
+        getListOfObjects( file.get(), "", histNames, treeNames );
+
+        for (const auto& path : histNames){
+            std::unique_ptr<TH1> hist( dynamic_cast<TH1*>(file->Get(path.c_str())) );
+            if (!hist){
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_warnings.push_back("Cannot read "+path+" in "+filename+" -- skipping it");
+                continue;
+            }
+            hist->SetDirectory(nullptr);      // owned here, not by the file
+
+            if (isCutflow(path) && !checkCutflow(*hist, path, filename, errors))
+                continue;
+
+            addHistogram( histograms, path, *hist, filename, errors );
+        }
+
+        handOver( f, std::move(file), treeNames );
+    }
+
+    return;
+}
+
+
+void outputMerger::combine( histogramMap& target, histogramMap& source, std::vector<std::string>& errors ){
+    /* Add the partial sums in 'source' to 'target' */
+    for (auto& hist : source){
+        if (target.find(hist.first)==target.end())
+            target[hist.first] = std::move(hist.second);
+        else
+            addHistogram( target, hist.first, *hist.second, "partial sum", errors );
+    }
+    source.clear();
+
+    return;
+}
+
+
+void outputMerger::addHistogram( histogramMap& histograms, const std::string& path, const TH1& hist,
+                                 const std::string& filename, std::vector<std::string>& errors ){
+    /* Add 'hist' to the sum -- only if the binning (and labels, for cutflows) agree */
+    auto match = histograms.find(path);
+    if (match==histograms.end()){
+        TH1* copy = static_cast<TH1*>(hist.Clone());
+        copy->SetDirectory(nullptr);
+        histograms[path].reset(copy);
+        return;
+    }
+
+    TH1* sum = match->second.get();
+    if (sum->GetNbinsX()!=hist.GetNbinsX() || sum->GetNbinsY()!=hist.GetNbinsY() || sum->GetNbinsZ()!=hist.GetNbinsZ()){
+        errors.push_back("Different binning for "+path+" in "+filename);
+        return;
+    }
+
+    if (isCutflow(path)){
+        for (int b=1, nBins=sum->GetNbinsX(); b<=nBins; b++){
+            std::string sumLabel  = sum->GetXaxis()->GetBinLabel(b);
+            std::string histLabel = hist.GetXaxis()->GetBinLabel(b);
+            if (sumLabel.compare(histLabel)!=0){
+                errors.push_back("Different cuts in "+path+" of "+filename+" (bin "+std::to_string(b)+": '"+histLabel+"' vs '"+sumLabel+"')");
+                return;
+            }
+        }
+    }
+
+    sum->Add(&hist);
+
+    return;
+}
+
+
+bool outputMerger::checkCutflow( const TH1& hist, const std::string& path, const std::string& filename, std::vector<std::string>& errors ){
+    /* The unweighted cutflow counts events -- it cannot increase after a cut */
+    std::string name = objectName(path);
+    std::string unweighted("_cutflow_unweighted");
+    if (name.size()<unweighted.size() || name.compare(name.size()-unweighted.size(),unweighted.size(),unweighted)!=0)
+        return true;
+
+    for (int b=2, nBins=hist.GetNbinsX(); b<=nBins; b++){
+        if (hist.GetBinContent(b) > hist.GetBinContent(b-1)){
+            errors.push_back("Unweighted cutflow increases at bin "+std::to_string(b)+" in "+path+" of "+filename);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/**** TREES ****/
+
+void outputMerger::mergeTrees( TFile& outputFile ){
+    /* Copy the trees of every file to the output file (in order) */
+    for (unsigned int f=0, nFiles=m_filenames.size(); f<nFiles; f++){
+        const std::string& filename = m_filenames.at(f);
+
+        openedFile opened = takeOver(f);    // waits for the histogram thread
+        std::unique_ptr<TFile>& file = opened.file;
+        if (!file)
+            continue;                        // reported by the histogram threads
+
+        for (const auto& path : opened.trees){
+            TTree* tree = dynamic_cast<TTree*>(file->Get(path.c_str()));   // owned by the file
+            if (!tree){
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_warnings.push_back("Cannot read "+path+" in "+filename+" -- skipping it");
+                continue;
+            }
+
+            if (objectName(path).compare("metadata")==0){
+                readMetadata( *tree, path );
+                continue;
+            }
+
+            if (m_trees.find(path)==m_trees.end()){
+                TDirectory* dir = cma::getDirectory( outputFile, directoryName(path) );
+                dir->cd();
+                m_trees[path] = tree->CloneTree(0);    // same branches, no entries
+                m_trees.at(path)->SetDirectory(dir);
+            }
+
+            Long64_t nEntries = m_trees.at(path)->CopyEntries( tree, -1, "fast" );
+            if (nEntries!=tree->GetEntries())
+                m_treeErrors.push_back("Copied "+std::to_string(nEntries)+" of "+std::to_string(tree->GetEntries())+" entries of "+path+" in "+filename);
+        }
+    }
+
+    for (const auto& tree : m_trees){
+        cma::getDirectory( outputFile, directoryName(tree.first) )->cd();
+        tree.second->Write( "", TObject::kOverwrite );
+    }
+
+    return;
+}
+
+
+void outputMerger::readMetadata( TTree& tree, const std::string& path ){
+    /* Add the entries of one metadata tree:  one entry per sample name, nEvents summed */
+    if (!tree.GetBranch("name") || !tree.GetBranch("target") || !tree.GetBranch("nEvents")){
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_warnings.push_back("Metadata tree "+path+" does not have the name, target, and nEvents branches -- skipping it");
+        return;
+    }
+
+    std::string* name(nullptr);
+    int target(0);
+    int nEvents(0);
+
+    tree.SetBranchAddress( "name",    &name );
+    tree.SetBranchAddress( "target",  &target );
+    tree.SetBranchAddress( "nEvents", &nEvents );
+
+    std::map<std::string,sampleMetadata>& samples = m_metadata[path];
+    for (Long64_t entry=0, size=tree.GetEntries(); entry<size; entry++){
+        tree.GetEntry(entry);
+
+        auto match = samples.find(*name);
+        if (match==samples.end()){
+            samples[*name] = {target, nEvents};
+            continue;
+        }
+
+        if (match->second.target!=target)
+            m_treeErrors.push_back("Sample "+*name+" has targets "+std::to_string(match->second.target)+" and "+std::to_string(target)+" in "+path);
+        match->second.nEvents += nEvents;
+    }
+
+    tree.ResetBranchAddresses();
+    delete name;
+
+    return;
+}
+
+
+void outputMerger::writeMetadata( TFile& outputFile ){
+    /* Write the merged metadata trees (same branches as miniTree) */
+    for (const auto& metadata : m_metadata){
+        cma::getDirectory( outputFile, directoryName(metadata.first) )->cd();
+
+        std::string name("");
+        int target(0);
+        int nEvents(0);
+
+        TTree* tree = new TTree("metadata","metadata");
+        tree->Branch( "name",    &name );
+        tree->Branch( "target",  &target,  "target/I" );
+        tree->Branch( "nEvents", &nEvents, "nEvents/I" );
+
+        for (const auto& sample : metadata.second){
+            name    = sample.first;
+            target  = sample.second.target;
+            nEvents = sample.second.nEvents;
+            tree->Fill();
+        }
+
+        tree->Write( "", TObject::kOverwrite );
+        delete tree;
+    }
+
+    return;
+}
+
+
+/**** FILE HAND-OVER ****/
+
+void outputMerger::waitForTurn( const unsigned int f ){
+    /* Limit the number of files that are open at the same time */
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait( lock, [this,f](){return f < m_nextTreeFile+m_maxOpenFiles;} );
+    return;
+}
+
+
+void outputMerger::handOver( const unsigned int f, std::unique_ptr<TFile> file, const std::vector<std::string>& trees ){
+    /* Histograms of file 'f' are done: its trees can be copied */
+    std::lock_guard<std::mutex> lock(m_mutex);
+    openedFile& opened = m_openedFiles.at(f);
+    opened.file  = std::move(file);
+    opened.trees = trees;
+    opened.ready = true;
+    m_condition.notify_all();
+
+    return;
+}
+
+
+openedFile outputMerger::takeOver( const unsigned int f ){
+    /* Wait for the histogram thread to finish file 'f' and take the file */
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait( lock, [this,f](){return m_openedFiles.at(f).ready;} );
+
+    openedFile opened;
+    opened.file  = std::move(m_openedFiles.at(f).file);
+    opened.trees = m_openedFiles.at(f).trees;
+    opened.ready = true;
+
+    m_nextTreeFile = f+1;
+    m_condition.notify_all();
+
+    return opened;
+}
+
+
+/**** FILE STRUCTURE ****/
+
+void outputMerger::getListOfObjects( TDirectory* dir, const std::string& path,
+                                     std::vector<std::string>& histograms, std::vector<std::string>& trees ){
+    /* Paths of all histograms and trees in a directory (and its subdirectories) */
+    std::vector<std::string> seen;        // keys are ordered by cycle: only use the latest one
+
+    TIter next( dir->GetListOfKeys() );
+    TKey* key(nullptr);
+    while ( (key = static_cast<TKey*>(next())) ){
+        std::string name = key->GetName();
+        if (std::find(seen.begin(), seen.end(), name)!=seen.end()) continue;
+        seen.push_back(name);
+
+        TClass* objClass = TClass::GetClass( key->GetClassName() );
+        if (!objClass) continue;
+
+        std::string fullPath = (path.size()>0) ? path+"/"+name : name;
+        if (objClass->InheritsFrom(TDirectory::Class()))
+            getListOfObjects( dir->GetDirectory(name.c_str()), fullPath, histograms, trees );
+        else if (objClass->InheritsFrom(TTree::Class()))
+            trees.push_back(fullPath);
+        else if (objClass->InheritsFrom(TH1::Class()))
+            histograms.push_back(fullPath);
+    }
+
+    return;
+}
+
+
+std::string outputMerger::directoryName( const std::string& path ){
+    /* 'dir/subdir/name' -> 'dir/subdir' */
+    std::size_t pos = path.find_last_of("/");
+    return (pos==std::string::npos) ? "" : path.substr(0,pos);
+}
+
+
+std::string outputMerger::objectName( const std::string& path ){
+    /* 'dir/subdir/name' -> 'name' */
+    std::size_t pos = path.find_last_of("/");
+    return (pos==std::string::npos) ? path : path.substr(pos+1);
+}
+
+
+bool outputMerger::isCutflow( const std::string& path ){
+    /* Cutflow histograms from eventSelection */
+    return (objectName(path).find("_cutflow")!=std::string::npos);
+}
+
+// THE END
@@ -0,0 +1,207 @@
+/*
+Created:        19 October 2026
+Last Updated:   19 October 2026
+
+agent
+agent@local
+-----
+
+Cache of selection results
+
+For every input file, store the entries that pass each channel
+(selection + systematic variation) and the cutflows.
+The cache key is a hash of
+  - the channel names (in the order they are evaluated)
+  - the contents of the cutsfiles
+  - the configuration (configuration::hash(): every option that changes the output)
+  - the version of the selection code (eventSelection::codeVersion())
+and the input file is identified by its path, size, and modification time.
+
+A later run with the same key only builds the passing entries,
+so changes downstream of the selection (features, histograms) are fast.
+
+Layout:  <cacheDirectory>/<key>/<file>_<hash of path>.root
+  fingerprint             TNamed, title = "key size modtime entries"
+  entries_<c>             TEntryList of passing entries in channel c
+  cutflow_<c>             cutflow histograms of channel c
+  cutflow_unweighted_<c>
+*/
+#include "Analysis/cheetah/interface/selectionCache.h"
+#include "Analysis/cheetah/interface/fileIndex.h"
+#include "Analysis/cheetah/interface/eventSelection.h"
+
+
+selectionCache::selectionCache( configuration& cmaConfig ) :
+  m_config(&cmaConfig),
+  m_cacheDirectory(""),
+  m_channelKeys(""),
+  m_nChannels(0),
+  m_hash(0),
+  m_filename(""),
+  m_nEntries(0){
+    m_pass.clear();
+    m_entries.clear();
+  }
+
+selectionCache::~selectionCache() {}
+
+
+void selectionCache::addChannel( const std::string& variation, const std::string& selection,
+                                 const std::string& cutsfile ){
+    /* Add the definition of one channel to the cache key */
+    std::ifstream file = cma::open_file(cutsfile);
+    std::stringstream cuts;
+    cuts << file.rdbuf();
+
+    m_channelKeys += variation+"|"+selection+"|"+cuts.str()+"\n";
+    m_nChannels++;
+
+    return;
+}
+
+
+void selectionCache::initialize( const std::string& cacheDirectory ){
+    /* Set the key for this configuration & make the cache directory */
+    m_cacheDirectory = cacheDirectory;
+    if (!enabled()) return;
+
+    m_hash = cma::hash( m_channelKeys, m_config->hash() );
+    m_hash = cma::hash( eventSelection::codeVersion(), m_hash );
+
+    gSystem->mkdir( (m_cacheDirectory+"/"+key()).c_str(), true );
+    cma::INFO("SELECTIONCACHE : Using "+m_cacheDirectory+"/"+key()+" for "+std::to_string(m_nChannels)+" channels");
+
+    return;
+}
+
+
+bool selectionCache::load( const std::string& filename, const Long64_t nEntries ){
+    /* Load the cache for this file (if it is still valid) */
+    m_filename = filename;
+    m_nEntries = nEntries;
+    m_entries.clear();
+    m_cutflows.clear();
+    m_cutflows_unw.clear();
+
+    if (!enabled()) return false;
+
+    m_pass.assign( m_nChannels, std::vector<bool>(m_nEntries,false) );
+
+    long long size(0);
+    long modtime(0);
+    if (!fileIndex::fingerprint(m_filename,size,modtime)) return false;
+
+    std::string cacheFile = cacheFilename(m_filename);
+    if (gSystem->AccessPathName(cacheFile.c_str())) return false;   // no cache yet
+
+    TDirectory::TContext context;      // keep the current directory (output file)
+    std::unique_ptr<TFile> file( TFile::Open(cacheFile.c_str()) );
+    if (!file || file->IsZombie()) return false;
+
+    std::string expected = key()+" "+std::to_string(size)+" "+std::to_string(modtime)+" "+std::to_string(m_nEntries);
+    TNamed* fingerprint = (TNamed*)file->Get("fingerprint");
+    if (!fingerprint || expected.compare(fingerprint->GetTitle())!=0){
+        cma::INFO("SELECTIONCACHE : Input changed since "+cacheFile+" was made; ignoring it");
+        return false;
+    }
+
+    for (unsigned int c=0; c<m_nChannels; c++){
+        std::string ch = std::to_string(c);
+        TEntryList* list = (TEntryList*)file->Get( ("entries_"+ch).c_str() );
+        TH1* cutflow     = (TH1*)file->Get( ("cutflow_"+ch).c_str() );
+        TH1* cutflow_unw = (TH1*)file->Get( ("cutflow_unweighted_"+ch).c_str() );
+        if (!list || !cutflow || !cutflow_unw){
+            cma::WARNING("SELECTIONCACHE : Channel "+ch+" missing from "+cacheFile+"; ignoring it");
+            m_pass.assign( m_nChannels, std::vector<bool>(m_nEntries,false) );
+            m_cutflows.clear();
+            m_cutflows_unw.clear();
+            return false;
+        }
+
+        for (Long64_t i=0, nPass=list->GetN(); i<nPass; i++){
+            Long64_t entry = list->GetEntry(i);
+            if (entry>=0 && entry<m_nEntries) m_pass.at(c).at(entry) = true;
+        }
+
+        m_cutflows.emplace_back( (TH1*)cutflow->Clone() );
+        m_cutflows.back()->SetDirectory(0);
+        m_cutflows_unw.emplace_back( (TH1*)cutflow_unw->Clone() );
+        m_cutflows_unw.back()->SetDirectory(0);
+    }
+
+    // entries to process: passing any channel
+    for (Long64_t entry=0; entry<m_nEntries; entry++){
+        for (unsigned int c=0; c<m_nChannels; c++){
+            if (m_pass[c][entry]){
+                m_entries.push_back(entry);
+                break;
+            }
+        }
+    }
+
+    cma::INFO("SELECTIONCACHE : Loaded "+cacheFile+" ("+std::to_string(m_entries.size())+"/"+std::to_string(m_nEntries)+" entries selected)");
+
+    return true;
+}
+
+
+void selectionCache::record( const unsigned int channel, const Long64_t entry ){
+    /* This entry passed the selection of this channel */
+    if (enabled() && entry<m_nEntries) m_pass[channel][entry] = true;
+    return;
+}
+
+
+void selectionCache::save( const std::vector<const TH1*>& cutflows, const std::vector<const TH1*>& cutflows_unweighted ){
+    /* Save the entry lists & cutflows (written to a temporary file and moved into place) */
+    if (!enabled()) return;
+
+    long long size(0);
+    long modtime(0);
+    if (!fileIndex::fingerprint(m_filename,size,modtime)) return;
+
+    std::string cacheFile = cacheFilename(m_filename);
+    std::string tmpFile   = cacheFile+".tmp";
+
+    TDirectory::TContext context;      // keep the current directory (output file)
+    std::unique_ptr<TFile> file( TFile::Open(tmpFile.c_str(),"RECREATE") );
+    if (!file || file->IsZombie()){
+        cma::WARNING("SELECTIONCACHE : Cannot write "+cacheFile);
+        return;
+    }
+
+    std::string fingerprint = key()+" "+std::to_string(size)+" "+std::to_string(modtime)+" "+std::to_string(m_nEntries);
+    TNamed("fingerprint",fingerprint.c_str()).Write();
+
+    for (unsigned int c=0; c<m_nChannels; c++){
+        std::string ch = std::to_string(c);
+
+        TEntryList list( ("entries_"+ch).c_str(), m_filename.c_str() );
+        for (Long64_t entry=0; entry<m_nEntries; entry++){
+            if (m_pass[c][entry]) list.Enter(entry);
+        }
+        list.Write();
+
+        cutflows.at(c)->Write( ("cutflow_"+ch).c_str() );
+        cutflows_unweighted.at(c)->Write( ("cutflow_unweighted_"+ch).c_str() );
+    }
+
+    file->Close();
+    std::rename(tmpFile.c_str(), cacheFile.c_str());
+
+    cma::INFO("SELECTIONCACHE : Saved "+cacheFile);
+
+    return;
+}
+
+
+std::string selectionCache::cacheFilename( const std::string& filename ) const{
+    /* One cache file per input file (hash of the path avoids clashes between directories) */
+    std::size_t pos   = filename.find_last_of(".");
+    std::size_t found = filename.find_last_of("/");
+    std::string name  = filename.substr(found+1,pos-1-found);
+
+    return m_cacheDirectory+"/"+key()+"/"+name+"_"+cma::hashToStr(cma::hash(filename))+".root";
+}
+
+// THE END
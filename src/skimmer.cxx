@@ -0,0 +1,106 @@
+/*
+Created:        19 October 2026
+Last Updated:   19 October 2026
+
+agent
+agent@local
+-----
+
+Skim of the input ntuple
+
+Entries of the input TTree that pass a selection are collected
+in a TEntryList and copied to a new file after the event loop.
+ - Optional list of branches to keep (wildcards allowed, e.g., 'AK8*')
+ - If every entry passed, the compressed baskets are copied directly
+*/
+#include "Analysis/cheetah/interface/skimmer.h"
+
+
+skimmer::skimmer( configuration& cmaConfig ) :
+  m_config(&cmaConfig),
+  m_tree(nullptr),
+  m_treename(""),
+  m_outputFilename(""){
+    m_branches = m_config->skimBranches();
+  }
+
+skimmer::~skimmer() {}
+
+
+void skimmer::initialize( TFile& inputFile, const std::string& treename, const std::string& outputFilename ){
+    /* Setup the list of selected entries for a new input file */
+    m_treename = treename;
+    m_outputFilename = outputFilename;
+
+    m_tree = (TTree*)inputFile.Get( m_treename.c_str() );
+    if (!m_tree){
+        cma::WARNING("SKIMMER : TTree "+m_treename+" not found in "+std::string(inputFile.GetName())+"; no skim will be made");
+        m_entryList.reset(nullptr);
+        return;
+    }
+
+    m_entryList.reset( new TEntryList("skim","Selected entries",m_tree) );
+
+    return;
+}
+
+
+void skimmer::fill( const Long64_t entry ){
+    /* Keep this entry */
+    if (m_entryList) m_entryList->Enter(entry);
+    return;
+}
+
+
+void skimmer::finalize(){
+    /* Copy the selected entries to the output file */
+    if (!m_tree || !m_entryList) return;
+
+    Long64_t nSelected = m_entryList->GetN();
+    Long64_t nEntries  = m_tree->GetEntries();
+
+    std::unique_ptr<TFile> outputFile( TFile::Open(m_outputFilename.c_str(), "RECREATE") );
+    if (!outputFile || outputFile->IsZombie()){
+        cma::ERROR("SKIMMER : Cannot create "+m_outputFilename);
+        return;
+    }
+
+    // same directory structure as the input, e.g., 'tree/eventVars'
+    std::size_t pos = m_treename.find_last_of("/");
+    std::string directory = (pos!=std::string::npos) ? m_treename.substr(0,pos) : "";
+    cma::getDirectory( *outputFile, directory )->cd();
+
+    // only copy the requested branches
+    if (m_branches.size()>0){
+        m_tree->SetBranchStatus("*",0);
+        for (const auto& branch : m_branches){
+            UInt_t found(0);
+            m_tree->SetBranchStatus(branch.c_str(),1,&found);
+            if (found<1) cma::WARNING("SKIMMER : No branches match '"+branch+"'");
+        }
+    }
+
+    TTree* skim(nullptr);
+    if (nSelected==nEntries)
+        skim = m_tree->CloneTree(-1,"fast");     // every entry passed: copy baskets without decompressing
+    else{
+        m_tree->SetEntryList( m_entryList.get() );
+        skim = m_tree->CopyTree("");
+        m_tree->SetEntryList(nullptr);
+    }
+
+    if (m_branches.size()>0)
+        m_tree->SetBranchStatus("*",1);         // restore the input TTree
+
+    if (skim) skim->Write("",TObject::kOverwrite);
+    outputFile->Close();
+
+    cma::INFO("SKIMMER : Saved "+std::to_string(nSelected)+"/"+std::to_string(nEntries)+" entries to "+m_outputFilename);
+
+    m_tree = nullptr;
+    m_entryList.reset(nullptr);
+
+    return;
+}
+
+// THE END
@@ -0,0 +1,183 @@
+/*
+Created:        19 October 2026
+Last Updated:   19 October 2026
+
+agent
+agent@local
+-----
+
+Telemetry of the event loop
+
+Every 'interval' seconds (and at the end of each file) one line of JSON
+is written with the progress and resource usage of the job:
+
+  {"status":"running","time":12.0,"file":"...","fileNumber":1,"thread":0,
+   "events":120000,"eventsToRun":500000,"selected":3100,
+   "eventsPerSec":10000.0,"selectedPerSec":258.3,"mbReadPerSec":21.4,
+   "bytesRead":268435456,"bytesDecompressed":805306368,
+   "rssMB":812.5,"peakRssMB":840.1,"etaSec":38.0}
+
+Rates are measured since the previous report.
+'bytesDecompressed' is estimated from the bytes read and the compression
+factor of the input TTree (ROOT does not count decompressed bytes per file).
+The event loop runs on one thread, so 'thread' is always 0.
+*/
+#include "Analysis/cheetah/interface/telemetry.h"
+
+#include <sstream>
+#include <iomanip>
+#include <sys/resource.h>
+
+
+telemetry::telemetry( configuration& cmaConfig ) :
+  m_config(&cmaConfig),
+  m_enabled(false),
+  m_output(nullptr),
+  m_interval(10.),
+  m_checkEvents(100),
+  m_inputFile(nullptr),
+  m_filename(""),
+  m_fileNumber(0),
+  m_eventsToRun(0),
+  m_events(0),
+  m_selected(0),
+  m_lastEvents(0),
+  m_lastSelected(0),
+  m_bytesRead(0),
+  m_lastBytesRead(0),
+  m_compressionFactor(1.){
+    m_jobStart = clock::now();
+  }
+
+telemetry::~telemetry() {}
+
+
+void telemetry::initialize( const std::string& destination, const double interval ){
+    /* Setup the output stream */
+    m_interval = interval;
+    m_enabled  = destination.size()>0;
+    m_jobStart = clock::now();
+
+    if (!m_enabled) return;
+
+    if (destination.compare("stderr")==0)
+        m_output = &std::cerr;
+    else{
+        m_file.open(destination.c_str(), std::ios::out | std::ios::app);
+        if (!m_file){
+            cma::WARNING("TELEMETRY : Cannot open "+destination+"; no telemetry will be written");
+            m_enabled = false;
+            return;
+        }
+        m_output = &m_file;
+    }
+
+    cma::INFO("TELEMETRY : Writing to "+destination+" every "+std::to_string(m_interval)+" s");
+
+    return;
+}
+
+
+void telemetry::startFile( TFile& file, TTree* tree, const std::string& filename, const Long64_t eventsToRun ){
+    /* Reset the counters for a new file */
+    m_inputFile   = &file;
+    m_filename    = filename;
+    m_eventsToRun = eventsToRun;
+    m_fileNumber++;
+
+    m_events   = 0;
+    m_selected = 0;
+    m_lastEvents   = 0;
+    m_lastSelected = 0;
+    m_bytesRead     = file.GetBytesRead();
+    m_lastBytesRead = m_bytesRead;
+
+    m_compressionFactor = 1.;
+    if (tree && tree->GetZipBytes()>0)
+        m_compressionFactor = double(tree->GetTotBytes()) / tree->GetZipBytes();
+
+    m_fileStart  = clock::now();
+    m_lastReport = m_fileStart;
+
+    if (m_enabled) report("start");
+
+    return;
+}
+
+
+void telemetry::endFile(){
+    /* Final report for this file */
+    if (m_enabled && m_inputFile) report("done");
+    m_inputFile = nullptr;
+    return;
+}
+
+
+void telemetry::check(){
+    /* Report if enough time has passed since the last report */
+    std::chrono::duration<double> elapsed = clock::now() - m_lastReport;
+    if (elapsed.count()>=m_interval) report("running");
+    return;
+}
+
+
+void telemetry::report( const std::string& status ){
+    /* Write one line of JSON */
+    clock::time_point now = clock::now();
+    double sinceLast  = std::chrono::duration<double>(now - m_lastReport).count();
+    double sinceStart = std::chrono::duration<double>(now - m_fileStart).count();
+    double jobTime    = std::chrono::duration<double>(now - m_jobStart).count();
+
+    Long64_t bytesRead = (m_inputFile) ? m_inputFile->GetBytesRead() - m_bytesRead : 0;
+
+    double eventsPerSec(0.), selectedPerSec(0.), mbReadPerSec(0.);
+    if (sinceLast>0){
+        eventsPerSec   = (m_events - m_lastEvents) / sinceLast;
+        selectedPerSec = (m_selected - m_lastSelected) / sinceLast;
+        mbReadPerSec   = (bytesRead - (m_lastBytesRead - m_bytesRead)) / sinceLast / 1048576.;
+    }
+
+    double eta(-1.);                  // from the average rate in this file
+    if (m_events>0 && sinceStart>0)
+        eta = (m_eventsToRun - m_events) / (m_events / sinceStart);
+
+    ProcInfo_t procInfo;
+    gSystem->GetProcInfo(&procInfo);  // memory in kB
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);   // peak memory in kB (Linux)
+
+    // no fixed-size buffer: long (xrootd) file names must not truncate the line
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(1)
+         << "{\"status\":\"" << status << "\",\"time\":" << jobTime
+         << ",\"file\":\"" << escape(m_filename) << "\",\"fileNumber\":" << m_fileNumber << ",\"thread\":0"
+         << ",\"events\":" << (long long)m_events << ",\"eventsToRun\":" << (long long)m_eventsToRun
+         << ",\"selected\":" << (long long)m_selected
+         << ",\"eventsPerSec\":" << eventsPerSec << ",\"selectedPerSec\":" << selectedPerSec
+         << ",\"mbReadPerSec\":" << std::setprecision(2) << mbReadPerSec << std::setprecision(1)
+         << ",\"bytesRead\":" << (long long)bytesRead << ",\"bytesDecompressed\":" << (long long)(bytesRead*m_compressionFactor)
+         << ",\"rssMB\":" << procInfo.fMemResident/1024. << ",\"peakRssMB\":" << usage.ru_maxrss/1024.
+         << ",\"etaSec\":" << eta << "}";
+
+    *m_output << line.str() << std::endl;
+
+    m_lastReport    = now;
+    m_lastEvents    = m_events;
+    m_lastSelected  = m_selected;
+    m_lastBytesRead = m_bytesRead + bytesRead;
+
+    return;
+}
+
+
+std::string telemetry::escape( const std::string& value ) const{
+    /* Escape quotes & backslashes for JSON */
+    std::string escaped("");
+    for (const auto& c : value){
+        if (c=='"' || c=='\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+// THE END
@@ -12,6 +12,12 @@ Common tools needed
 */
 #include "Analysis/CyMiniAna/interface/tools.h"
 
+#ifdef CHEETAH_DEBUG_ALLOCATIONS
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#endif
+
 namespace cma{
 
 
@@ -138,6 +144,20 @@ void getListOfKeys( TFile* file, std::vector<std::string>& fileKeys ){
 }
 
 
+TDirectory* getDirectory( TFile& file, const std::string& path ){
+    /* Get a directory in the file (make it if it doesn't exist yet) */
+    if (path.size()<1) return &file;
+
+    TDirectory* dir = file.GetDirectory(path.c_str());
+    if (!dir){
+        file.mkdir(path.c_str());           // makes intermediate directories, too
+        dir = file.GetDirectory(path.c_str());
+    }
+
+    return dir;
+}
+
+
 bool str2bool( const std::string value ){
     /* Turn string into boolean */
     bool valueBoolean(false);
@@ -162,6 +182,24 @@ std::string vectorToStr( const std::vector<std::string> &vec ){
 }
 
 
+unsigned long long hash( const std::string& value, unsigned long long seed ){
+    /* FNV-1a: same value on every platform and run (unlike std::hash) */
+    unsigned long long h(seed);
+    for (const auto& c : value){
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+std::string hashToStr( const unsigned long long hashValue ){
+    /* Hash as a fixed-width hex string (for file names) */
+    char str[17];
+    snprintf(str, sizeof(str), "%016llx", hashValue);
+    return std::string(str);
+}
+
+
 bool deltaRMatch( const TLorentzVector &particle1, const TLorentzVector &particle2, const double deltaR ){
     /* Do the deltaR calculation (in one place) */
     return (particle1.DeltaR(particle2)<deltaR);
@@ -182,14 +220,29 @@ float ptrel( const TLorentzVector& a, const TLorentzVector& b){
 
 
 std::string m_debugLevel = "SetMe";
+unsigned int m_debugLevelValue(0);    // integer value of m_debugLevel (see verboseMap())
 void setVerboseLevel( const std::string& verboseLevel ) {
     m_debugLevel = verboseLevel;
+
+    std::map<std::string,unsigned int> debugMap = verboseMap();
+    m_debugLevelValue = (debugMap.find(m_debugLevel)!=debugMap.end()) ? debugMap.at(m_debugLevel) : 0;
+
     return;
 }
 
+bool debugEnabled(){
+    /* DEBUG messages are printed */
+    return (m_debugLevelValue==0);
+}
+
+void DEBUG(const char* message){
+    /* Debug level (verbosity of output) */
+    if (debugEnabled()) verbose("DEBUG",message);
+    return;
+}
 void DEBUG(const std::string& message){
     /* Debug level (verbosity of output) */
-    verbose("DEBUG",message);
+    if (debugEnabled()) verbose("DEBUG",message);
     return;
 }
 void INFO(const std::string& message){
@@ -216,13 +269,12 @@ void verbose(const std::string level, const std::string& message){
          if the level is "WARNING", then only WARNING/ERROR messages should be printed
          if the level is "ERROR", then only ERROR messages should be printed
     */
-    std::map<std::string,unsigned int> debugMap = {
-            {"DEBUG",   0},
-            {"INFO",    1},
-            {"WARNING", 2},
-            {"ERROR",   3} };
+    unsigned int value(3);                // called for every message: no map lookup
+    if (level.compare("DEBUG")==0)        value = 0;
+    else if (level.compare("INFO")==0)    value = 1;
+    else if (level.compare("WARNING")==0) value = 2;
 
-    if ( debugMap.at( level ) >= debugMap.at( m_debugLevel ))
+    if ( value >= m_debugLevelValue )
         std::cout << " " << level << " :: " << message << std::endl;
 
     return;
@@ -255,6 +307,31 @@ void HELP(const std::string& runExecutable){
     return;
 }
 
+
+#ifdef CHEETAH_DEBUG_ALLOCATIONS
+static std::atomic<unsigned long long> m_allocationCount(0);
+
+unsigned long long allocationCount(){
+    /* Number of calls to operator new so far (all threads) */
+    return m_allocationCount.load(std::memory_order_relaxed);
+}
+#endif
+
 } // end namespace
 
+
+#ifdef CHEETAH_DEBUG_ALLOCATIONS
+// Count every heap allocation (array and sized versions call these)
+void* operator new(std::size_t size){
+    cma::m_allocationCount.fetch_add(1,std::memory_order_relaxed);
+    void* ptr = std::malloc(size>0 ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept{
+    std::free(ptr);
+}
+#endif
+
 // THE END
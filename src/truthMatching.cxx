@@ -27,14 +27,14 @@ void truthMatching::initialize(){
 }
 
 
-void truthMatching::setTruthPartons(const std::vector<Parton> truth_partons){
+void truthMatching::setTruthPartons(const std::vector<Parton>& truth_partons){
     /* Set truth partons */
     m_truth_partons = truth_partons;
     return;
 }
 
 
-void truthMatching::setTruthTops(const std::vector<TruthTop> truth_tops){
+void truthMatching::setTruthTops(const std::vector<TruthTop>& truth_tops){
     /* Set truth tops */
     m_truth_tops = truth_tops;
     return;
@@ -50,18 +50,18 @@ void truthMatching::matchJetToTruthTop(Jet& jet){
     jet.containment = 0;         // initialize containment
     jet.truth_partons.clear();
 
-    cma::DEBUG("TRUTHMATCHING : Truth matching tops to jet: n truth tops = "+std::to_string(m_truth_tops.size()));
+    if (cma::debugEnabled()) cma::DEBUG("TRUTHMATCHING : Truth matching tops to jet: n truth tops = "+std::to_string(m_truth_tops.size()));
     for (unsigned int t_idx=0, size=m_truth_tops.size(); t_idx<size; t_idx++){
-        cma::DEBUG("TRUTHMATCHING : Truth matching top "+std::to_string(t_idx)+" to jet");
-        auto truthtop = m_truth_tops.at(t_idx);
+        if (cma::debugEnabled()) cma::DEBUG("TRUTHMATCHING : Truth matching top "+std::to_string(t_idx)+" to jet");
+        const auto& truthtop = m_truth_tops.at(t_idx);
         if (!truthtop.isHadronic) continue;         // only want hadronically-decaying tops
 
 //        Parton top = m_truth_partons.at( truthtop.Top );
 //        parton_match(top,jet,0.6);
 
-        Parton bottomQ = m_truth_partons.at( truthtop.bottom );
-        Parton wdecay1 = m_truth_partons.at( truthtop.Wdecays.at(0) );
-        Parton wdecay2 = m_truth_partons.at( truthtop.Wdecays.at(1) );
+        const Parton& bottomQ = m_truth_partons.at( truthtop.bottom );
+        const Parton& wdecay1 = m_truth_partons.at( truthtop.Wdecays.at(0) );
+        const Parton& wdecay2 = m_truth_partons.at( truthtop.Wdecays.at(1) );
 
         parton_match(bottomQ,jet,0.8);
         parton_match(wdecay1,jet,0.8);
@@ -90,12 +90,12 @@ void truthMatching::parton_match(const Parton& p, Jet& r, double dR){
     // if matched update parameters of the object
     // check matches -- use map in header to avoid errors misremembering the integer values
     if (match){
-        cma::DEBUG("TRUTHMATCH : parton_match() "+std::to_string(p.index)+" with containment "+std::to_string(p.containment));
+        if (cma::debugEnabled()) cma::DEBUG("TRUTHMATCH : parton_match() "+std::to_string(p.index)+" with containment "+std::to_string(p.containment));
         r.truth_partons.push_back(p.index);
         r.containment += p.containment;
     }
     else 
-        cma::DEBUG("TRUTHMATCH : parton_match() failed "+std::to_string(p.index));
+        if (cma::debugEnabled()) cma::DEBUG("TRUTHMATCH : parton_match() failed "+std::to_string(p.index));
 
     return;
 }
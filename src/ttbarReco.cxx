@@ -33,11 +33,13 @@ void ttbarReco::execute(std::vector<Lepton>& leptons, std::vector<Neutrino>& nu,
          > Ref: https://github.com/UHH2/UHH2/blob/master/common/src/Utils.cxx#L34
        - AK8 away from lepton
          > Most 'top-like' = highest BEST_t score
+       The struct is re-used for every event (the jets keep the storage of their maps/vectors)
     */
-    m_ttbar1L = {};
+    m_ttbar1L.p4.SetPxPyPzE(0,0,0,0);
+    m_ttbar1L.isGood = 0;
 
     // Setup lepton (only 1 in the single lepton analysis)
-    cma::DEBUG("TTBARRECO : building ttbar with "+std::to_string(leptons.size())+" leptons");
+    if (cma::debugEnabled()) cma::DEBUG("TTBARRECO : building ttbar with "+std::to_string(leptons.size())+" leptons");
     Lepton lep;
     if (leptons.size()>0)
         lep = leptons.at(0);
@@ -52,7 +54,7 @@ void ttbarReco::execute(std::vector<Lepton>& leptons, std::vector<Neutrino>& nu,
 
     if (leptons.size()>0){
         // -- Setup AK4 jet : 2D Cut
-        cma::DEBUG("TTBARRECO : building ttbar with "+std::to_string(jets.size())+" ak4 candidates");
+        if (cma::debugEnabled()) cma::DEBUG("TTBARRECO : building ttbar with "+std::to_string(jets.size())+" ak4 candidates");
         float ak4_pt(0);
 
         for (auto& jet : jets){
@@ -79,7 +81,7 @@ void ttbarReco::execute(std::vector<Lepton>& leptons, std::vector<Neutrino>& nu,
 
 
         // -- Setup AK8 jet (highest BEST_t jet farther away than pi/2 from lepton)
-        cma::DEBUG("TTBARRECO : building ttbar with "+std::to_string(ljets.size())+" ak8 candidates");
+        if (cma::debugEnabled()) cma::DEBUG("TTBARRECO : building ttbar with "+std::to_string(ljets.size())+" ak8 candidates");
         float BEST_t(-999.);            // between 0 and 1 for real jets
 
         for (const auto& ljet : ljets){
@@ -96,17 +98,23 @@ void ttbarReco::execute(std::vector<Lepton>& leptons, std::vector<Neutrino>& nu,
     m_ttbar1L.neutrino = nu.at(0);
     m_ttbar1L.lepton   = lep;
 
-    Jet dummy_jet;
-    dummy_jet.isGood = false;
-    m_ttbar1L.jet = (ak4candidate>=0) ? jets.at(ak4candidate) : dummy_jet;
+    if (ak4candidate>=0)
+        m_ttbar1L.jet = jets.at(ak4candidate);
+    else{
+        m_ttbar1L.jet.reset();                     // dummy jet (nothing left from a previous event)
+        m_ttbar1L.jet.isGood = false;
+    }
 
     TLorentzVector leptop;
     leptop = nu.at(0).p4 + lep.p4 + m_ttbar1L.jet.p4;
     m_ttbar1L.leptop = leptop;
 
-    Ljet dummy_ljet;
-    dummy_ljet.isGood = false;
-    m_ttbar1L.ljet = (ak8candidate>=0) ? ljets.at(ak8candidate) : dummy_ljet;
+    if (ak8candidate>=0)
+        m_ttbar1L.ljet = ljets.at(ak8candidate);
+    else{
+        m_ttbar1L.ljet.reset();                    // dummy jet (nothing left from a previous event)
+        m_ttbar1L.ljet.isGood = false;
+    }
 
     m_ttbar1L.dy = lep.charge * ( std::abs(leptop.Rapidity()) - std::abs(m_ttbar1L.ljet.p4.Rapidity()) );
 
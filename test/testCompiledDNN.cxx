@@ -0,0 +1,128 @@
+/*
+Created:        19 October 2026
+Last Updated:   19 October 2026
+
+agent
+agent@local
+-----
+
+Unit test of the compiled network (python/lwtnn2header.py)
+ - The generated network is compared to lwtnn, built from the same JSON file,
+   for random inputs around the normalization of each input
+ - double precision: deviation < 1e-6; float32: deviation < 1e-4
+   (int8 is only reported: its accuracy depends on the calibration)
+Deviation = |compiled - lwtnn| / max(|lwtnn|,1)
+
+Passes (nothing to test) if the network has not been generated.
+
+To run:
+   scram b runtests
+   testCompiledDNN [lwtnn.json] [nSamples]
+*/
+#include <iostream>
+#include <string>
+#include <map>
+#include <random>
+#include <fstream>
+#include <cmath>
+#include <algorithm>
+
+#include "lwtnn/lwtnn/interface/LightweightNeuralNetwork.hh"
+#include "lwtnn/lwtnn/interface/parse_json.hh"
+
+#include "Analysis/cheetah/interface/compiledDNN.h"
+
+
+int main(int argc, char** argv) {
+    /* Compare the compiled network to lwtnn */
+#ifndef CHEETAH_COMPILED_DNN
+    std::cout << " TESTCOMPILEDDNN : The compiled network has not been generated (python/lwtnn2header.py); nothing to test" << std::endl;
+    return 0;
+#else
+    std::string jsonFile = (argc>1) ? argv[1] : compiledDNN::sourceFile;
+    unsigned int nSamples = (argc>2) ? std::stoul(argv[2]) : 10000;
+
+    std::ifstream input_cfg(jsonFile);
+    if (!input_cfg.good()){
+        std::cout << " TESTCOMPILEDDNN : Cannot open " << jsonFile << std::endl;
+        return 1;
+    }
+    lwt::JSONConfig cfg = lwt::parse_json( input_cfg );
+    lwt::LightweightNeuralNetwork lwnn(cfg.inputs, cfg.layers, cfg.outputs);
+
+    // Same inputs & outputs
+    bool pass(true);
+    if (cfg.inputs.size()!=compiledDNN::nInputs || cfg.outputs.size()!=compiledDNN::nOutputs){
+        std::cout << " TESTCOMPILEDDNN : " << jsonFile << " has " << cfg.inputs.size() << " inputs & " << cfg.outputs.size()
+                  << " outputs; the compiled network has " << compiledDNN::nInputs << " & " << compiledDNN::nOutputs << std::endl;
+        return 1;
+    }
+    for (unsigned int i=0; i<compiledDNN::nInputs; i++){
+        if (cfg.inputs.at(i).name.compare(compiledDNN::inputNames[i])!=0){
+            std::cout << " TESTCOMPILEDDNN : Input " << i << " is " << cfg.inputs.at(i).name
+                      << " in lwtnn and " << compiledDNN::inputNames[i] << " in the compiled network" << std::endl;
+            pass = false;
+        }
+    }
+    if (!pass) return 1;
+
+    // Random inputs: normalized inputs ~ N(0,1) => x = u/scale - offset
+    std::mt19937 generator(2018);
+    std::normal_distribution<double> normal(0.,1.);
+
+    double maxDeviation(0.), maxDeviationFloat(0.);
+#ifdef CHEETAH_COMPILED_DNN_INT8
+    double maxDeviationInt8(0.);
+#endif
+    double inputs[compiledDNN::nInputs];
+    double outputs[compiledDNN::nOutputs];
+    std::map<std::string,double> lwnnInputs;
+
+    for (unsigned int n=0; n<nSamples; n++){
+        for (unsigned int i=0; i<compiledDNN::nInputs; i++){
+            double u = normal(generator);
+            double scale = cfg.inputs.at(i).scale;
+            inputs[i] = ((scale!=0) ? u/scale : u) - cfg.inputs.at(i).offset;
+            lwnnInputs[cfg.inputs.at(i).name] = inputs[i];
+        }
+        std::map<std::string,double> reference = lwnn.compute(lwnnInputs);
+
+        compiledDNN::compute(inputs,outputs);
+        for (unsigned int o=0; o<compiledDNN::nOutputs; o++){
+            double ref = reference.at(compiledDNN::outputNames[o]);
+            maxDeviation = std::max( maxDeviation, std::abs(outputs[o]-ref)/std::max(std::abs(ref),1.) );
+        }
+
+        compiledDNN::computeFloat(inputs,outputs);
+        for (unsigned int o=0; o<compiledDNN::nOutputs; o++){
+            double ref = reference.at(compiledDNN::outputNames[o]);
+            maxDeviationFloat = std::max( maxDeviationFloat, std::abs(outputs[o]-ref)/std::max(std::abs(ref),1.) );
+        }
+
+#ifdef CHEETAH_COMPILED_DNN_INT8
+        compiledDNN::computeInt8(inputs,outputs);
+        for (unsigned int o=0; o<compiledDNN::nOutputs; o++){
+            double ref = reference.at(compiledDNN::outputNames[o]);
+            maxDeviationInt8 = std::max( maxDeviationInt8, std::abs(outputs[o]-ref)/std::max(std::abs(ref),1.) );
+        }
+#endif
+    }
+
+    std::cout << " TESTCOMPILEDDNN : " << jsonFile << " (" << nSamples << " samples)" << std::endl;
+    std::cout << " TESTCOMPILEDDNN :   double  max. deviation = " << maxDeviation << " (tolerance 1e-6)" << std::endl;
+    std::cout << " TESTCOMPILEDDNN :   float32 max. deviation = " << maxDeviationFloat << " (tolerance 1e-4)" << std::endl;
+#ifdef CHEETAH_COMPILED_DNN_INT8
+    std::cout << " TESTCOMPILEDDNN :   int8    max. deviation = " << maxDeviationInt8 << std::endl;
+#endif
+
+    if (!(maxDeviation<1e-6) || !(maxDeviationFloat<1e-4)){
+        std::cout << " TESTCOMPILEDDNN : FAILED" << std::endl;
+        return 1;
+    }
+
+    std::cout << " TESTCOMPILEDDNN : PASSED" << std::endl;
+    return 0;
+#endif
+}
+
+// THE END